@@ -39,4 +39,8 @@ int calc_crushing_pressure(SLifeData* lifeData,  SVpm* vpm,
 													 float starting_ambient_pressure,
 													 float rate );
 
+float vpm_expf(float x);
+float vpm_logf(float x);
+float vpm_cbrtf(float x);
+
 #endif // CALC_CRUSH_H
@@ -96,5 +96,8 @@
 /* Enable RTE sleep mode debugging */
 /* #define ENABLE_SLEEP_DEBUG */
 
+/* Enable to log dive samples in the compact delta / varint encoding (decoded for display and download) */
+/* #define ENABLE_COMPACT_PROFILE */
+
 
 #endif
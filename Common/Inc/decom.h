@@ -31,6 +31,16 @@
 
 #	define	WATER_VAPOUR_PRESSURE	(0.0493f) // Schreiner 1971
 
+/* Tissue state prepared for the Buehlmann tolerance checks: sum of the inert gases and the
+ * a / b coefficients mixed by the N2/He ratio of each compartment. Loaded once per tissue
+ * state, then used for any number of ceiling / tolerance tests (different GF or depth). */
+typedef struct
+{
+	float inertgas_saturation[16];
+	float inertgas_a[16];
+	float inertgas_b[16];
+} STissueTolerance;
+
 void decom_get_inert_gases(const float ambient_pressure_bar,const SGas* pGas, float* fraction_nitrogen, float* fraction_helium );
 void decom_tissues_exposure(int period_in_seconds, SLifeData* pLifeData);
 void decom_tissues_exposure2(int period_in_seconds, SGas* pActualGas, float pressure_ambient_bar, float *tissue_N2_selected_stage, float *tissue_He_selected_stage);
@@ -42,6 +52,9 @@ void decom_tissues_exposure_stage_schreiner(int period_in_seconds, SGas* pGas, f
 																		 float* pTissue_nitrogen_bar, float* pTissue_helium_bar);
 void decom_CreateGasChangeList(SDiveSettings* pInput, const SLifeData* lifeData);
 uint8_t decom_tissue_test_tolerance(float* Tissue_nitrogen_bar, float* Tissue_helium_bar, float GF_value, float depth_in_bar_absolute);
+void decom_tissue_tolerance_load(STissueTolerance* pTolerance, const float* Tissue_nitrogen_bar, const float* Tissue_helium_bar);
+float decom_tissue_tolerance_ceiling(const STissueTolerance* pTolerance, float GF_value);
+float decom_tissue_tolerance_margin(const STissueTolerance* pTolerance, float GF_value, float depth_in_bar_absolute);
 void decom_tissues_desaturation_time(const SLifeData* pLifeData, SLifeData2* pOutput);
 void test_decom_CreateGasChangeList(void);
 
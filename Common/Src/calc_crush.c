@@ -28,6 +28,7 @@
 
 #include "decom.h"
 #include "math.h"
+#include <float.h>
 #include "vpm.h"
 
 /* Common Block Declarations */
@@ -89,6 +90,131 @@ int radius_root_finder (float *a, float *b, float *c, float *low_bound, float *h
 //void  get_inert_gases_(SBuehlmann* input, ,short gas_id, float ambient_pressure_bar, float* fraction_nitrogen,float* fraction_helium );
 int vpm_repetitive_algorithm(SVpm* pVpm, float *surface_interval_time, float* initial_critical_radius_he, float* initial_critical_radius_n2);
 
+/* =============================================================================== */
+/*     FAST MATH FOR THE VPM BUBBLE MODEL */
+/*     expf, logf and powf(x, 1/3) are software library calls on the F4 FPU. The */
+/*     VPM code only needs them for positive, finite arguments (ratios of */
+/*     pressures, decay factors), so these single precision replacements skip the */
+/*     special case handling and errno. They only use float add / mul / div and */
+/*     integer bit operations. GCC contracts a * b + c into a fused multiply-add */
+/*     by default (-ffp-contract=fast) on the Cortex-M4F, so firmware results may */
+/*     differ in the last bit from a host build without FMA. */
+/*     Error bounds against double precision, checked by HostSim/vpm_math_check: */
+/*     vpm_expf   x in [-87, 88]:        relative error < 1.2e-7 */
+/*     vpm_logf   x in [0.5, 2]:         absolute error < 6e-8 */
+/*                other normal x > 0:    relative error < 1.2e-7 */
+/*     vpm_cbrtf  normal x > 0:          relative error < 1.2e-7 */
+/*     vpm_expf clamps other arguments: 0 below -87, exp(88) above 88. vpm_logf */
+/*     and vpm_cbrtf pass zero, negative, subnormal and non finite arguments on */
+/*     to the C library. Define VPM_LIBM_MATH to use the C library throughout */
+/*     (reference build). */
+/* =============================================================================== */
+
+typedef union
+{
+	float f;
+	int32_t i;
+} SFloatBits;
+
+float vpm_expf(float x)
+{
+#ifdef VPM_LIBM_MATH
+	return expf(x);
+#else
+	SFloatBits scale;
+	float n, r, rr, p;
+
+	if(x < -87.0f)
+		return 0.0f;
+	if(x > 88.0f)
+		x = 88.0f;
+
+	/* x = n * ln2 + r, |r| <= ln2 / 2, ln2 split in two parts (Cody-Waite) */
+	n = (float)(int32_t)(x * 1.44269504089f + ((x < 0.0f) ? -0.5f : 0.5f));
+	r = x - n * 0.693359375f;
+	r = r + n * 2.12194440e-4f;
+
+	/* minimax polynomial for exp(r) (Cephes) */
+	rr = r * r;
+	p = 1.9875691500e-4f;
+	p = p * r + 1.3981999507e-3f;
+	p = p * r + 8.3334519073e-3f;
+	p = p * r + 4.1665795894e-2f;
+	p = p * r + 1.6666665459e-1f;
+	p = p * r + 5.0000001201e-1f;
+	p = p * rr + r + 1.0f;
+
+	scale.i = ((int32_t)n + 127) << 23;
+	return p * scale.f;
+#endif
+}
+
+float vpm_logf(float x)
+{
+#ifdef VPM_LIBM_MATH
+	return logf(x);
+#else
+	SFloatBits bits;
+	float e, m, z, y;
+
+	if(!((x >= FLT_MIN) && (x <= FLT_MAX)))	/* zero, negative, subnormal, inf, nan */
+		return logf(x);
+
+	/* x = 2^e * m, m in [sqrt(1/2), sqrt(2)) */
+	bits.f = x;
+	e = (float)((bits.i >> 23) - 126);
+	bits.i = (bits.i & 0x007FFFFF) | 0x3F000000;
+	m = bits.f;
+	if(m < 0.707106781f)
+	{
+		e -= 1.0f;
+		m = m + m - 1.0f;
+	}
+	else
+	{
+		m = m - 1.0f;
+	}
+
+	/* minimax polynomial for log(1 + m) (Cephes) */
+	z = m * m;
+	y = 7.0376836292e-2f;
+	y = y * m - 1.1514610310e-1f;
+	y = y * m + 1.1676998740e-1f;
+	y = y * m - 1.2420140846e-1f;
+	y = y * m + 1.4249322787e-1f;
+	y = y * m - 1.6668057665e-1f;
+	y = y * m + 2.0000714765e-1f;
+	y = y * m - 2.4999993993e-1f;
+	y = y * m + 3.3333331174e-1f;
+	y = y * m * z;
+	y += -2.12194440e-4f * e;
+	y += -0.5f * z;
+	return m + y + 0.693359375f * e;
+#endif
+}
+
+float vpm_cbrtf(float x)
+{
+#ifdef VPM_LIBM_MATH
+	return powf(x, 1.0f / 3.0f);
+#else
+	SFloatBits bits;
+	float y;
+
+	if(!((x >= FLT_MIN) && (x <= FLT_MAX)))	/* zero, negative, subnormal, inf, nan */
+		return powf(x, 1.0f / 3.0f);
+
+	/* exponent / 3 gives a start value within 4%, three Newton steps reach float precision */
+	bits.f = x;
+	bits.i = bits.i / 3 + 0x2A5137A0;
+	y = bits.f;
+	y += (x / (y * y) - y) * (1.0f / 3.0f);
+	y += (x / (y * y) - y) * (1.0f / 3.0f);
+	y += (x / (y * y) - y) * (1.0f / 3.0f);
+	return y;
+#endif
+}
+
 
 
 /* =============================================================================== */
@@ -137,11 +263,11 @@ float *initial_gas_pressure)
 	(*initial_inspired_gas_pressure -
 	*initial_gas_pressure -
 	*rate_change_insp_gas_pressure / *gas_time_constant) *
-	expf(-(*gas_time_constant) * time);
+	vpm_expf(-(*gas_time_constant) * time);
 
 	if(time_rest > 0.0f)
 	{
-		ret_val = ret_val * expf(-(*gas_time_constant) * time_rest);
+		ret_val = ret_val * vpm_expf(-(*gas_time_constant) * time_rest);
 	}
 
 
@@ -570,7 +696,7 @@ short i)
 		if (function_at_mid_range <= 0.0f) {
 			time = mid_range_time;
 		}
-		if (fabs(differential_change) < .001f ||
+		if (fabsf(differential_change) < .001f ||
 		function_at_mid_range == 0.0f) {
 			goto L100;
 		}
@@ -662,7 +788,7 @@ float *ending_radius)
 		radius_at_low_bound = *high_bound;
 	}
 	*ending_radius = (*low_bound + *high_bound) * .5f;
-	last_diff_change = (r1 = *high_bound - *low_bound, fabs(r1));
+	last_diff_change = (r1 = *high_bound - *low_bound, fabsf(r1));
 	differential_change = last_diff_change;
 
 	/* =============================================================================== */
@@ -683,8 +809,8 @@ float *ending_radius)
 	for (i = 1; i <= 100; ++i) {
 		if (((*ending_radius - radius_at_high_bound) * derivative_of_function - function) *
 		((*ending_radius - radius_at_low_bound) * derivative_of_function - function) >= 0.0f
-		|| (r1 = function * 2.0f, fabs(r1)) >
-		(r2 = last_diff_change * derivative_of_function, fabs(r2))) {
+		|| (r1 = function * 2.0f, fabsf(r1)) >
+		(r2 = last_diff_change * derivative_of_function, fabsf(r2))) {
 			last_diff_change = differential_change;
 			differential_change =
 			(radius_at_high_bound - radius_at_low_bound) * .5f;
@@ -701,7 +827,7 @@ float *ending_radius)
 				return 0;
 			}
 		}
-		if (fabs(differential_change) < 1e-12) {
+		if (fabsf(differential_change) < 1e-12f) {
 			return 0;
 		}
 		function =
@@ -855,7 +981,7 @@ int vpm_repetitive_algorithm(SVpm* pVpm, float *surface_interval_time, float* in
 			pVpm->adjusted_critical_radius_n2[i] =
 				initial_critical_radius_n2[i]
 				+ (initial_critical_radius_n2[i] - new_critical_radius_n2)
-				*  exp(-(*surface_interval_time) / REGENERATION_TIME_CONSTANT);
+				*  vpm_expf(-(*surface_interval_time) / REGENERATION_TIME_CONSTANT);
 
 		} else {
 			pVpm->adjusted_critical_radius_n2[i] =
@@ -872,7 +998,7 @@ int vpm_repetitive_algorithm(SVpm* pVpm, float *surface_interval_time, float* in
 			pVpm->adjusted_critical_radius_he[i] =
 				initial_critical_radius_he[i]
 				+ ( initial_critical_radius_he[i] -	new_critical_radius_he)
-				* exp(-(*surface_interval_time) / REGENERATION_TIME_CONSTANT);
+				* vpm_expf(-(*surface_interval_time) / REGENERATION_TIME_CONSTANT);
 		} else {
 			pVpm->adjusted_critical_radius_he[i] =
 			initial_critical_radius_he[i];
@@ -188,28 +188,16 @@ const float buehlmann_He_t_halflife[] = {
 								188.24f,
 								240.03f};
 
-const float float_buehlmann_N2_factor_expositon_one_second[] =	{ 2.30782347297664E-003f, 1.44301447809736E-003f, 9.23769302935806E-004f, 6.24261986779007E-004f, 4.27777107246730E-004f, 3.01585140931371E-004f, 2.12729727268379E-004f, 1.50020603047807E-004f, 1.05980191127841E-004f, 7.91232600646508E-005f, 6.17759153688224E-005f, 4.83354552742732E-005f, 3.78761777920511E-005f, 2.96212356654113E-005f, 2.31974277413727E-005f, 1.81926738960225E-005f};
-const float float_buehlmann_N2_factor_expositon_003_second[] =	{ 6.90750456296407E-003f, 4.32279956671600E-003f, 2.76874864793053E-003f, 1.87161709452954E-003f, 1.28278242026003E-003f, 9.04482589432765E-004f, 6.38053429621421E-004f, 4.49994293975742E-004f, 3.17906879170993E-004f, 2.37350999218289E-004f, 1.85316297551252E-004f, 1.44999356986975E-004f, 1.13624229615916E-004f, 8.88610747694640E-005f, 6.95906688746861E-005f, 5.45770287740943E-005f};
-const float float_buehlmann_N2_factor_expositon_008_second[] =	{ 1.83141447532454E-002f, 1.14859796471039E-002f, 7.36630472495203E-003f, 4.98319782231915E-003f, 3.41709742823104E-003f, 2.41013596224415E-003f, 1.70057124687550E-003f, 1.19953484034729E-003f, 8.47527105247492E-004f, 6.32810814525819E-004f, 4.94100480767923E-004f, 3.86618231662861E-004f, 3.02969256443353E-004f, 2.36945319086024E-004f, 1.85564355251966E-004f, 1.45532124251058E-004f};
 const float float_buehlmann_N2_factor_expositon_10_seconds[] =	{ 2.28400315657541E-002f, 1.43368013598124E-002f, 9.19938673477072E-003f, 6.22511239287027E-003f, 4.69545762670800E-003f, 3.01176178733265E-003f, 2.12526200031782E-003f, 1.49919365737827E-003f, 1.05929662305226E-03f, 7.909509380171760E-004f, 6.17587450108648E-004f, 4.83249432061905E-004f, 3.78697227222391E-004f, 2.61728759809380E-004f, 2.31950063482533E-004f, 1.81911845881011E-004f};
-const float float_buehlmann_N2_factor_expositon_18_seconds[] =	{ 4.07358806747357E-002f, 2.56581087982929E-002f, 1.64979259737517E-002f, 1.11772892486697E-002f, 7.67205373705648E-003f, 5.41463899418337E-003f, 3.82221908774349E-003f, 2.69693016270112E-003f, 1.90592594569927E-003f, 1.42326123023573E-003f, 1.11138278062062E-003f, 8.69680830683950E-004f, 6.81551750048359E-004f, 5.33048018290350E-004f, 4.17471377070378E-004f, 3.27417496114757E-004f};
 const float float_buehlmann_N2_factor_expositon_20_seconds[] =	{ 4.51583960895835E-002f, 2.84680588463941E-002f, 1.83141447532454E-002f, 1.24114727614367E-002f, 8.52086250432193E-003f, 6.01445286560154E-003f, 4.24600726206570E-003f, 2.99613973313428E-003f, 2.11747113676897E-003f, 1.58127627264804E-003f, 1.23479348595879E-003f, 9.66265334110261E-004f, 7.57251042854845E-004f, 5.92258033589421E-004f, 4.63846326133055E-004f, 3.63790599842373E-004f};
 const float float_buehlmann_N2_factor_expositon_one_minute[] =	{ 1.29449436703876E-001f, 8.29959567953288E-002f, 5.39423532744041E-002f, 3.67741962370398E-002f, 2.53453908775689E-002f, 1.79350552316596E-002f, 1.26840126026602E-002f, 8.96151553540825E-003f, 6.33897185233323E-003f, 4.73633146787078E-003f, 3.69980819572546E-003f, 2.89599589841472E-003f, 2.27003327536857E-003f, 1.77572199977927E-003f, 1.39089361795441E-003f, 1.09097481687104E-003f};
-const float float_buehlmann_N2_factor_expositon_100_second[] =	{ 2.06299474015900E-001f, 1.34463438993857E-001f, 8.82775114417832E-002f, 6.05359181023788E-002f, 4.18844218114071E-002f, 2.97126970072147E-002f, 2.10505144045823E-002f, 1.48911986890571E-002f, 1.05426136839346E-002f, 7.88141652426455E-003f, 6.15873909572406E-003f, 4.82199900095137E-003f, 3.78052526350936E-003f, 2.95778454900952E-003f, 2.31708109427220E-003f, 1.81763004457269E-003f};
 const float float_buehlmann_N2_factor_expositon_five_minutes[]=	{ 5.00000000000000E-001f, 3.51580222674495E-001f, 2.42141716744801E-001f, 1.70835801932547E-001f, 1.20463829104624E-001f, 8.65157896183918E-002f, 6.18314987350977E-002f, 4.40116547625051E-002f, 3.12955727186929E-002f, 2.34583889613009E-002f, 1.83626606868127E-002f, 1.43963540993090E-002f, 1.12987527093947E-002f, 8.84713405486026E-003f, 6.93514912851934E-003f, 5.44298480182925E-003f};
-const float float_buehlmann_N2_factor_expositon_800_second[] =	{ 8.42509868763141E-001f, 6.85019737526282E-001f, 5.22579198044792E-001f, 3.93205767018569E-001f, 2.89861248917861E-001f, 2.14397627137602E-001f, 1.56505490290652E-001f, 1.13102166881646E-001f, 8.12935637814599E-002f, 6.13392112527207E-002f, 4.82208523469105E-002f, 3.79311861210304E-002f, 2.98470272862601E-002f, 2.34187624071612E-002f, 1.83870151711824E-002f, 1.44488700649190E-002f};
 const float float_buehlmann_N2_factor_expositon_one_hour[]=			{ 9.99755859375000E-001f, 9.94475728271980E-001f, 9.64103176406343E-001f, 8.94394508891055E-001f, 7.85689004286732E-001f, 6.62392147498621E-001f, 5.35088626789486E-001f, 4.17318576947576E-001f, 3.17197008420226E-001f, 2.47876700002107E-001f, 1.99405069752929E-001f, 1.59713055172538E-001f, 1.27468761759271E-001f, 1.01149026804458E-001f, 8.01196838116008E-002f, 6.33955413542552E-002f};
 
-const float float_buehlmann_He_factor_expositon_one_second[] =	{ 6.12608039419837E-003f, 3.81800836683133E-003f, 2.44456078654209E-003f, 1.65134647076792E-003f, 1.13084424730725E-003f, 7.97503165599123E-004f, 5.62552521860549E-004f, 3.96776399429366E-004f, 2.80360036664540E-004f, 2.09299583354805E-004f, 1.63410794820518E-004f, 1.27869320250551E-004f, 1.00198406028040E-004f, 7.83611475491108E-005f, 6.13689891868496E-005f, 4.81280465299827E-005f};
-const float float_buehlmann_He_factor_expositon_003_second[] =	{ 1.82658845044263E-002f, 1.14103491926518E-002f, 7.31576933570466E-003f, 4.94586307993539E-003f, 3.38869776192019E-003f, 2.39060197012086E-003f, 1.68670834759044E-003f, 1.18985696621965E-003f, 8.40844326779777E-004f, 6.27767340286467E-004f, 4.90152279561396E-004f, 3.83558911153159E-004f, 3.00565099928485E-004f, 2.35065021719993E-004f, 1.84095669333084E-004f, 1.44377190774980E-004f}; // 3 He
-const float float_buehlmann_He_factor_expositon_008_second[] =	{ 4.79706116082057E-002f, 3.01390075707096E-002f, 1.93899772993034E-002f, 1.31346689569831E-002f, 9.01102820363486E-003f, 6.36224538449637E-003f, 4.49156910795023E-003f, 3.16980660943422E-003f, 2.24068067793926E-003f, 1.67317060331207E-003f, 1.30653891641375E-003f, 1.02249686330114E-003f, 8.01306192375617E-004f, 6.26717274191169E-004f, 4.90846474157092E-004f, 3.84959521834594E-004f}; // 8 He
 const float float_buehlmann_He_factor_expositon_10_seconds[] =	{ 5.95993001714799E-002f, 3.75307444923134E-002f, 2.41784389107607E-002f, 1.63912909924208E-002f, 1.25106927410620E-002f, 7.94647192918641E-003f, 5.61130562069978E-003f, 3.96068706690245E-003f, 2.80006593100546E-003f, 2.09102564918129E-003f, 1.63290683272987E-003f, 1.27795767799976E-003f, 1.00153239354972E-003f, 7.33352120986130E-004f, 6.13520442722559E-004f, 4.81176244777948E-004f};
-const float float_buehlmann_He_factor_expositon_18_seconds[] =	{ 1.04710896899039E-001f, 6.65386126706349E-002f, 4.30995968284519E-002f, 2.93106657684409E-002f, 2.01607137751910E-002f, 1.42581599093282E-002f, 1.00776711616688E-002f, 7.11793906429403E-003f, 5.03447255531631E-003f, 3.76069760984632E-003f, 2.93731229281968E-003f, 2.29914783358365E-003f, 1.80203605181650E-003f, 1.40956155658090E-003f, 1.10406577253352E-003f, 8.65950533235460E-004f};
 const float float_buehlmann_He_factor_expositon_20_seconds[] =	{ 1.15646523762030E-001f, 7.36529322024796E-002f, 4.77722809133601E-002f, 3.25139075644434E-002f, 2.23755519884017E-002f, 1.58297974422514E-002f, 1.11911244906306E-002f, 7.90568709176287E-003f, 5.59229149279306E-003f, 4.17767891009702E-003f, 3.26314728073529E-003f, 2.55428218017273E-003f, 2.00206171996409E-003f, 1.56605681014277E-003f, 1.22666447811148E-003f, 9.62120958977297E-004f};
 const float float_buehlmann_He_factor_expositon_one_minute[] =	{ 3.08363886219441E-001f, 2.05084082411030E-001f, 1.36579295730211E-001f, 9.44046323514587E-002f, 6.56358626478964E-002f, 4.67416115355790E-002f, 3.31990512604121E-002f, 2.35300557146709E-002f, 1.66832281977395E-002f, 1.24807506400979E-002f, 9.75753219809561E-003f, 7.64329013320042E-003f, 5.99416843126677E-003f, 4.69081666943783E-003f, 3.67548116287808E-003f, 2.88358673732592E-003f};
-const float float_buehlmann_He_factor_expositon_100_second[] =	{ 4.59084487437744E-001f, 3.17867635141657E-001f, 2.17103957783539E-001f, 1.52336166567559E-001f, 1.06981885584572E-001f, 7.66825160768219E-002f, 5.47171474343117E-002f, 3.89083581201959E-002f, 2.76504642556165E-002f, 2.07145921483078E-002f, 1.62096019995457E-002f, 1.27063337640768E-002f, 9.97030625587825E-003f, 7.80579708939710E-003f, 6.11829377951190E-003f, 4.80135692933603E-003f}; // 100 He
 const float float_buehlmann_He_factor_expositon_five_minutes[]=	{ 8.41733751018722E-001f, 6.82600697933713E-001f, 5.20142493735619E-001f, 3.90924736715930E-001f, 2.87834706153524E-001f, 2.12857832580192E-001f, 1.55333364924147E-001f, 1.12242395185686E-001f, 8.06788883581406E-002f, 6.08653819753062E-002f, 4.78448115000141E-002f, 3.76366999883051E-002f, 2.96136888654287E-002f, 2.32350754744602E-002f, 1.82428098114835E-002f, 1.43350223887367E-002f}; // thre
-const float float_buehlmann_He_factor_expositon_800_second[] =	{ 9.92671155759686E-001f, 9.53124140216102E-001f, 8.58865632718416E-001f, 7.33443528431762E-001f, 5.95533881446524E-001f, 4.71787742036413E-001f, 3.62479376011699E-001f, 2.72021750877104E-001f, 2.00940186773410E-001f, 1.54187175639359E-001f, 1.22553521140786E-001f, 9.72431193565182E-002f, 7.70338702477497E-002f, 6.07666995543268E-002f, 4.79109397391700E-002f, 3.77715319879068E-002f}; // 800 He
 const float float_buehlmann_He_factor_expositon_one_hour[]=			{ 9.99999999753021E-001f, 9.99998954626205E-001f, 9.99850944669188E-001f, 9.97393537149572E-001f, 9.82979603888650E-001f, 9.43423231328217E-001f, 8.68106292901111E-001f, 7.60374619482322E-001f, 6.35576141220644E-001f, 5.29310840978539E-001f, 4.44744511849213E-001f, 3.68942936079581E-001f, 3.02834419265355E-001f, 2.45810174422126E-001f, 1.98231319020275E-001f, 1.59085372294989E-001f};
 
 void decom_get_inert_gases(const float ambient_pressure_bar,const SGas* pGas, float* fraction_nitrogen, float* fraction_helium )
@@ -255,6 +243,70 @@ void decom_tissues_exposure(int period_in_seconds, SLifeData * pLifeData)
 }
 
 
+/* Saturation factors 1 - e^(-k * t) for the periods used most recently.
+ * deco_loop() and the RTE use only a handful of different periods (1s update, 10s stop step,
+ * future TTS projection), so in most cases the factors are taken from the cache and the exposure
+ * is a single pass over the compartments, independent of the length of the period. The NDL search
+ * of buehlmann.c varies the period and therefore calculates its tissues without the cache.
+ * Compared to the former ladder of fixed period tables (3600/800/300/100/60/20/18/10/8/3/1 seconds)
+ * the tissue pressures differ by less than 3E-6 bar (float rounding).
+ * Exception: the 10 second table deviates from the closed form in compartment 5 and 14. The stop
+ * calculation of buehlmann.c is based on 10 second steps, so this table is kept for exactly this
+ * period to not change the resulting deco plans. Other periods, which used to include a 10 second
+ * step of the ladder (e.g. 11 - 17 seconds), now follow the closed form for these compartments, too.
+ */
+#define DECOM_EXPOSURE_CACHE_SIZE	(4)
+
+typedef struct
+{
+	int period_in_seconds;
+	float factor_N2[16];
+	float factor_He[16];
+} SExposureFactors;
+
+static SExposureFactors exposureCache[DECOM_EXPOSURE_CACHE_SIZE];
+static uint8_t exposureCacheNext = 0;
+
+static void decom_get_exposure_factors(int period_in_seconds, const float** ppFactorN2, const float** ppFactorHe)
+{
+	SExposureFactors *pFactors;
+	float period_in_minutes;
+	int ci;
+
+	if(period_in_seconds == 10)
+	{
+		*ppFactorN2 = float_buehlmann_N2_factor_expositon_10_seconds;
+		*ppFactorHe = float_buehlmann_He_factor_expositon_10_seconds;
+		return;
+	}
+
+	for(int i = 0; i < DECOM_EXPOSURE_CACHE_SIZE; i++)
+	{
+		if(exposureCache[i].period_in_seconds == period_in_seconds)
+		{
+			*ppFactorN2 = exposureCache[i].factor_N2;
+			*ppFactorHe = exposureCache[i].factor_He;
+			return;
+		}
+	}
+
+	pFactors = &exposureCache[exposureCacheNext];
+	exposureCacheNext = (exposureCacheNext + 1) % DECOM_EXPOSURE_CACHE_SIZE;
+
+	/* invalidate the entry while it is updated */
+	pFactors->period_in_seconds = 0;
+	period_in_minutes = ((float)period_in_seconds) / 60.0f;
+	for (ci=0;ci<16;ci++)
+	{
+		pFactors->factor_N2[ci] = -expm1f(-nitrogen_time_constant[ci] * period_in_minutes);
+		pFactors->factor_He[ci] = -expm1f(-helium_time_constant[ci] * period_in_minutes);
+	}
+	pFactors->period_in_seconds = period_in_seconds;
+
+	*ppFactorN2 = pFactors->factor_N2;
+	*ppFactorHe = pFactors->factor_He;
+}
+
 void decom_tissues_exposure2(int period_in_seconds, SGas* pActualGas,  float ambiant_pressure_bar, float *tissue_N2_selected_stage, float *tissue_He_selected_stage)
 {
 	int ci;
@@ -262,139 +314,22 @@ void decom_tissues_exposure2(int period_in_seconds, SGas* pActualGas,  float amb
 	float percent_He;
 	float partial_pressure_N2;
 	float partial_pressure_He;
-
-
-
-	int period_in_seconds_left;
+	const float *pFactorN2;
+	const float *pFactorHe;
 
 	if(period_in_seconds > 0)
 	{
-
 		decom_get_inert_gases(ambiant_pressure_bar, pActualGas, &percent_N2, &percent_He);
 
 		partial_pressure_N2 =  (ambiant_pressure_bar - WATER_VAPOUR_PRESSURE) * percent_N2;
 		partial_pressure_He = (ambiant_pressure_bar - WATER_VAPOUR_PRESSURE) * percent_He;
-		period_in_seconds_left = period_in_seconds;
-
-		while(period_in_seconds_left)
-		{
-			if(period_in_seconds_left >= 3600)
-				period_in_seconds = 3600;
-			else
-			if(period_in_seconds_left >= 800)
-				period_in_seconds = 800;
-			else
-			if(period_in_seconds_left >= 300)
-				period_in_seconds = 300;
-			else
-			if(period_in_seconds_left >= 100)
-				period_in_seconds = 100;
-			else
-			if(period_in_seconds_left >= 60)
-				period_in_seconds = 60;
-			else
-			if(period_in_seconds_left == 36)
-				period_in_seconds = 18;
-			else
-			if(period_in_seconds_left >= 20)
-				period_in_seconds = 20;
-			else
-			if(period_in_seconds_left >= 18)
-				period_in_seconds = 18;
-			else
-			if(period_in_seconds_left >= 10)
-				period_in_seconds = 10;
-			else
-			if(period_in_seconds_left >= 8)
-				period_in_seconds = 8;
-			else
-			if(period_in_seconds_left >= 3)
-				period_in_seconds = 3;
-			else
-				period_in_seconds = 1;
 
-			period_in_seconds_left -= period_in_seconds;
+		decom_get_exposure_factors(period_in_seconds, &pFactorN2, &pFactorHe);
 
-			switch (period_in_seconds)
-			{
-				case 1:
-				for (ci=0;ci<16;ci++)
-				{
-					tissue_N2_selected_stage[ci] += (partial_pressure_N2 - tissue_N2_selected_stage[ci]) * float_buehlmann_N2_factor_expositon_one_second[ci];
-					tissue_He_selected_stage[ci] += (partial_pressure_He - tissue_He_selected_stage[ci]) * float_buehlmann_He_factor_expositon_one_second[ci];
-				}
-				break;
-				case 3:
-				for (ci=0;ci<16;ci++)
-				{
-					tissue_N2_selected_stage[ci] += (partial_pressure_N2 - tissue_N2_selected_stage[ci]) * float_buehlmann_N2_factor_expositon_003_second[ci];
-					tissue_He_selected_stage[ci] += (partial_pressure_He - tissue_He_selected_stage[ci]) * float_buehlmann_He_factor_expositon_003_second[ci];
-				}
-				break;
-				case 8:
-				for (ci=0;ci<16;ci++)
-				{
-					tissue_N2_selected_stage[ci] += (partial_pressure_N2 - tissue_N2_selected_stage[ci]) * float_buehlmann_N2_factor_expositon_008_second[ci];
-					tissue_He_selected_stage[ci] += (partial_pressure_He - tissue_He_selected_stage[ci]) * float_buehlmann_He_factor_expositon_008_second[ci];
-				}
-				break;
-				case 10:
-				for (ci=0;ci<16;ci++)
-				{
-					tissue_N2_selected_stage[ci] += (partial_pressure_N2 - tissue_N2_selected_stage[ci]) * float_buehlmann_N2_factor_expositon_10_seconds[ci];
-					tissue_He_selected_stage[ci] += (partial_pressure_He - tissue_He_selected_stage[ci]) * float_buehlmann_He_factor_expositon_10_seconds[ci];
-				}
-				break;
-				case 18:
-				for (ci=0;ci<16;ci++)
-				{
-					tissue_N2_selected_stage[ci] += (partial_pressure_N2 - tissue_N2_selected_stage[ci]) * float_buehlmann_N2_factor_expositon_18_seconds[ci];
-					tissue_He_selected_stage[ci] += (partial_pressure_He - tissue_He_selected_stage[ci]) * float_buehlmann_He_factor_expositon_18_seconds[ci];
-				}
-				break;
-				case 20:
-				for (ci=0;ci<16;ci++)
-				{
-					tissue_N2_selected_stage[ci] += (partial_pressure_N2 - tissue_N2_selected_stage[ci]) * float_buehlmann_N2_factor_expositon_20_seconds[ci];
-					tissue_He_selected_stage[ci] += (partial_pressure_He - tissue_He_selected_stage[ci]) * float_buehlmann_He_factor_expositon_20_seconds[ci];
-				}
-				break;
-				case 60:
-				for (ci=0;ci<16;ci++)
-				{
-					tissue_N2_selected_stage[ci] += (partial_pressure_N2 - tissue_N2_selected_stage[ci]) * float_buehlmann_N2_factor_expositon_one_minute[ci];
-					tissue_He_selected_stage[ci] += (partial_pressure_He - tissue_He_selected_stage[ci]) * float_buehlmann_He_factor_expositon_one_minute[ci];
-				}
-				break;
-				case 100:
-				for (ci=0;ci<16;ci++)
-				{
-					tissue_N2_selected_stage[ci] += (partial_pressure_N2 - tissue_N2_selected_stage[ci]) * float_buehlmann_N2_factor_expositon_100_second[ci];
-					tissue_He_selected_stage[ci] += (partial_pressure_He - tissue_He_selected_stage[ci]) * float_buehlmann_He_factor_expositon_100_second[ci];
-				}
-				break;
-				case 300:
-				for (ci=0;ci<16;ci++)
-				{
-					tissue_N2_selected_stage[ci] += (partial_pressure_N2 - tissue_N2_selected_stage[ci]) * float_buehlmann_N2_factor_expositon_five_minutes[ci];
-					tissue_He_selected_stage[ci] += (partial_pressure_He - tissue_He_selected_stage[ci]) * float_buehlmann_He_factor_expositon_five_minutes[ci];
-				}
-				break;
-				case 800:
-				for (ci=0;ci<16;ci++)
-				{
-					tissue_N2_selected_stage[ci] += (partial_pressure_N2 - tissue_N2_selected_stage[ci]) * float_buehlmann_N2_factor_expositon_800_second[ci];
-					tissue_He_selected_stage[ci] += (partial_pressure_He - tissue_He_selected_stage[ci]) * float_buehlmann_He_factor_expositon_800_second[ci];
-				}
-				break;
-				case 3600:
-				for (ci=0;ci<16;ci++)
-				{
-					tissue_N2_selected_stage[ci] += (partial_pressure_N2 - tissue_N2_selected_stage[ci]) * float_buehlmann_N2_factor_expositon_one_hour[ci];
-					tissue_He_selected_stage[ci] += (partial_pressure_He - tissue_He_selected_stage[ci]) * float_buehlmann_He_factor_expositon_one_hour[ci];
-				}
-				break;
-			}
+		for (ci=0;ci<16;ci++)
+		{
+			tissue_N2_selected_stage[ci] += (partial_pressure_N2 - tissue_N2_selected_stage[ci]) * pFactorN2[ci];
+			tissue_He_selected_stage[ci] += (partial_pressure_He - tissue_He_selected_stage[ci]) * pFactorHe[ci];
 		}
 	}
 }
@@ -710,39 +645,78 @@ void test_decom_CreateGasChangeList(void)
 	decom_CreateGasChangeList(&diveSetting, &lifeData);
 }
 
-uint8_t decom_tissue_test_tolerance(float* Tissue_nitrogen_bar, float* Tissue_helium_bar, float GF_value, float depth_in_bar_absolute)
+void decom_tissue_tolerance_load(STissueTolerance* pTolerance, const float* Tissue_nitrogen_bar, const float* Tissue_helium_bar)
 {
 	float tissue_inertgas_saturation;
-	float inertgas_a;
-	float inertgas_b;
-	float inertgas_tolerance;
-	float gf_minus_1;
-
-	gf_minus_1 = GF_value - 1.0f;
 
 	for (int ci = 0; ci < 16; ci++)
 	{
 		if(Tissue_helium_bar[ci] == 0)
 		{
-			tissue_inertgas_saturation = Tissue_nitrogen_bar[ci];
-			//
-			inertgas_a = buehlmann_N2_a[ci];
-			inertgas_b = buehlmann_N2_b[ci];
+			pTolerance->inertgas_saturation[ci] = Tissue_nitrogen_bar[ci];
+			pTolerance->inertgas_a[ci] = buehlmann_N2_a[ci];
+			pTolerance->inertgas_b[ci] = buehlmann_N2_b[ci];
 		}
 		else
 		{
 			tissue_inertgas_saturation =  Tissue_nitrogen_bar[ci] + Tissue_helium_bar[ci];
-			//
-			inertgas_a = ( ( buehlmann_N2_a[ci] *  Tissue_nitrogen_bar[ci]) + ( buehlmann_He_a[ci] * Tissue_helium_bar[ci]) ) / tissue_inertgas_saturation;
-			inertgas_b = ( ( buehlmann_N2_b[ci] *  Tissue_nitrogen_bar[ci]) + ( buehlmann_He_b[ci] * Tissue_helium_bar[ci]) ) / tissue_inertgas_saturation;
+			pTolerance->inertgas_saturation[ci] = tissue_inertgas_saturation;
+			pTolerance->inertgas_a[ci] = ( ( buehlmann_N2_a[ci] *  Tissue_nitrogen_bar[ci]) + ( buehlmann_He_a[ci] * Tissue_helium_bar[ci]) ) / tissue_inertgas_saturation;
+			pTolerance->inertgas_b[ci] = ( ( buehlmann_N2_b[ci] *  Tissue_nitrogen_bar[ci]) + ( buehlmann_He_b[ci] * Tissue_helium_bar[ci]) ) / tissue_inertgas_saturation;
 		}
-		//
-		inertgas_tolerance = ( (GF_value / inertgas_b - gf_minus_1) * depth_in_bar_absolute ) + ( GF_value * inertgas_a );
-		//
-		if(inertgas_tolerance < tissue_inertgas_saturation)
-			return 0;
 	}
-	return 1;
+}
+
+/* tolerated ambient pressure (bar absolute) of the leading compartment, -1 if none is loaded */
+float decom_tissue_tolerance_ceiling(const STissueTolerance* pTolerance, float GF_value)
+{
+	float ceiling[16];
+	float global_ceiling = -1;
+	int ci;
+
+	/* no branch inside the lane loop => compiler is free to vectorize it */
+	for (ci = 0; ci < 16; ci++)
+	{
+		ceiling[ci] = (pTolerance->inertgas_b[ci] * ( pTolerance->inertgas_saturation[ci] - GF_value * pTolerance->inertgas_a[ci] ) )
+					/ (GF_value - (pTolerance->inertgas_b[ci] * GF_value) + pTolerance->inertgas_b[ci]);
+	}
+	for (ci = 0; ci < 16; ci++)
+	{
+		if(ceiling[ci] > global_ceiling)
+			global_ceiling = ceiling[ci];
+	}
+	return global_ceiling;
+}
+
+/* saturation minus tolerated pressure of the first compartment violating the tolerance (positive),
+ * or of the last compartment (zero or negative) if none is violated */
+float decom_tissue_tolerance_margin(const STissueTolerance* pTolerance, float GF_value, float depth_in_bar_absolute)
+{
+	float margin[16];
+	float gf_minus_1;
+	int ci;
+
+	gf_minus_1 = GF_value - 1.0f;
+
+	for (ci = 0; ci < 16; ci++)
+	{
+		margin[ci] = pTolerance->inertgas_saturation[ci]
+					- (( (GF_value / pTolerance->inertgas_b[ci] - gf_minus_1) * depth_in_bar_absolute ) + ( GF_value * pTolerance->inertgas_a[ci] ));
+	}
+	for (ci = 0; ci < 15; ci++)
+	{
+		if(margin[ci] > 0)
+			break;
+	}
+	return margin[ci];
+}
+
+uint8_t decom_tissue_test_tolerance(float* Tissue_nitrogen_bar, float* Tissue_helium_bar, float GF_value, float depth_in_bar_absolute)
+{
+	STissueTolerance tolerance;
+
+	decom_tissue_tolerance_load(&tolerance, Tissue_nitrogen_bar, Tissue_helium_bar);
+	return decom_tissue_tolerance_margin(&tolerance, GF_value, depth_in_bar_absolute) <= 0;
 }
 
 
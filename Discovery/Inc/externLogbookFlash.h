@@ -51,7 +51,8 @@
 /* 64 KB
  * 001x used for settings
  * 001x used for VPM
- * 005x unused
+ * 001x used for the logbook pointer journal
+ * 004x unused
  * 008x for header		(0.5 MB)
  * 192x for samples		(12 MB)
  * 016x for firmware	( 1 MB)
@@ -61,7 +62,9 @@
 #define SETTINGSSTOP 	0x0001FFFF
 #define VPMSTART		0x00020000
 #define VPMSTOP			0x0002FFFF
-#define unused3START	0x00030000
+#define JOURNALSTART	0x00030000
+#define JOURNALSTOP		0x0003FFFF
+#define unused3START	0x00040000
 #define unused3STOP		0x0007FFFF
 #define HEADERSTART		0x00080000
 #define HEADERSTOP		0x000FFFFF
@@ -125,12 +128,18 @@ void ext_flash_create_new_dive_log(uint8_t *pHeaderPreDive);
 void ext_flash_close_new_dive_log(uint8_t *pHeaderPostDive);
 
 void ext_flash_write_sample(uint8_t *pSample, uint16_t length);
+void ext_flash_commit_sample_cache(void);
+void ext_flash_flush_sample_cache(void);
+void ext_flash_recover_sample_cache(void);
+void ext_flash_preerase_samples(void);
 
 uint8_t ext_flash_count_dive_headers(void);
+uint8_t ext_flash_count_dives_since(uint16_t diveNumber);
+uint8_t ext_flash_header_index_spot_check(void);
 void ext_flash_read_dive_header(uint8_t *pHeaderToFill, uint8_t StepBackwards);
 void ext_flash_read_dive_header2(uint8_t *pHeaderToFill, uint8_t id, _Bool bOffset);
 void ext_flash_open_read_sample(uint8_t StepBackwards, uint32_t *totalNumberOfBytes);
-void ext_flash_read_next_sample_part(uint8_t *pSample, uint8_t length);
+void ext_flash_read_next_sample_part(uint8_t *pSample, uint16_t length);
 void ext_flash_close_read_sample(void);
 void ext_flash_set_entry_point(void);
 void ext_flash_reopen_read_sample_at_entry_point(void);
@@ -32,6 +32,10 @@
 #include "stm32f4xx_hal.h"
 #include "gfx.h"
 
+/* Exported constants --------------------------------------------------------*/
+
+#define GFX_HEADER_INDEX_SIZE	(0x10000)	/* 256 logbook headers of 256 bytes, see GFX_getHeaderIndexMemory() */
+
 /* Exported types ------------------------------------------------------------*/
 
 /**
@@ -79,6 +83,21 @@ typedef struct
         int bottom;
 } SWindowGimpStyle;
 
+typedef struct
+{
+    uint8_t total;                       /*!< frames of the pool, clean + released + blocked */
+    uint8_t clean;                       /*!< frames ready to be handed out by getFrame() */
+    uint8_t released;                    /*!< frames waiting for their clear, including one DMA2D is working on */
+    uint8_t blocked;                     /*!< frames owned by a caller */
+    uint8_t blockedMax;                  /*!< high-water mark of blocked */
+    uint16_t waitCount;                  /*!< getFrame() calls which found no clean frame */
+    uint16_t acquireFailed;              /*!< getFrame() calls which returned 0 */
+    uint8_t failedCaller;                /*!< caller of the last failed getFrame() */
+    uint16_t releaseForeign;             /*!< releaseFrame() calls for a frame of another caller */
+    uint32_t waitTicks;                  /*!< time spent by getFrame() waiting for a clean frame in HAL ticks */
+    uint32_t waitTicksMax;               /*!< longest single wait */
+} SFramePoolStatistics;
+
 /* Exported variables --------------------------------------------------------*/
 
 /**
@@ -177,6 +196,15 @@ void releaseAllFramesExcept(uint8_t callerId, uint32_t frameStartAddress);
 uint8_t housekeepingFrame(void);
 uint16_t blockedFramesCount(void);
 uint8_t getFrameCount(uint8_t frameId);
+void GFX_getFramePoolStatistics(SFramePoolStatistics *pStatistics);
+void GFX_resetFramePoolStatistics(void);
+uint8_t GFX_getFramesOfCaller(uint8_t callerId);
+uint32_t GFX_getHeaderIndexMemory(void);
+
+void GFX_retained_begin(GFX_DrawCfgScreen *hscreen, uint8_t callerId, GFX_DrawCfgWindow * const *pWindows, uint8_t windowCount);
+void GFX_retained_clear(GFX_DrawCfgWindow* hgfx);
+void GFX_retained_invalidate(void);
+void GFX_retained_end(void);
 
 void write_content_simple(GFX_DrawCfgScreen *tMscreen, uint16_t XleftGimpStyle, uint16_t XrightGimpStyle, uint16_t YtopGimpStyle, const tFont *Font, const char *text, uint8_t color);
 void gfx_write_topline_simple(GFX_DrawCfgScreen *tMscreen, const char *text, uint8_t color);
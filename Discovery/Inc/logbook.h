@@ -44,6 +44,9 @@ typedef struct
     gasbit8_Type note;
 } SGasListLog;
 
+#define PROFILE_ENCODING_STANDARD	(0)	/* samples as sent by the OSTC3 download */
+#define PROFILE_ENCODING_COMPACT	(1)	/* delta / varint coded samples, see logbook_writeSample() */
+
 //Logbook
 typedef struct
 {
@@ -91,7 +94,9 @@ typedef struct
     uint8_t  diveMode;
     uint8_t  hwHudLastStatus; /* from here on identical to OSTC3 again */
     uint16_t hwHudBattery_mV;
-    uint8_t batteryGaugeRegisters[5];	/* former batteryGaugeRegisters (6 Bytes) which were not used => use as reserve to keep memory layout */
+    uint8_t batteryGaugeRegisters[1];	/* former batteryGaugeRegisters (6 Bytes) which were not used => use as reserve to keep memory layout */
+    uint8_t standardProfileLength[3];	/* reuse: length of the profile in standard samples (compact encoding only) */
+    uint8_t profileEncoding;			/* reuse: PROFILE_ENCODING_xxx, zero in older logs */
     uint8_t batteryCharge;				/* first reuse byte */
     uint16_t diveHeaderEnd;
 } SLogbookHeader;
@@ -220,5 +225,8 @@ void logbook_recover_brokenlog(uint8_t headerId);
 uint16_t logbook_lastDive_diveNumber(void);
 uint16_t logbook_fillDummySampleBuffer(SLogbookHeader* pHeader);
 void logbook_readDummySamples(uint8_t* pTarget, uint16_t length);
+uint32_t logbook_getStandardProfileLength(const SLogbookHeader* pHead);
+uint32_t logbook_openStandardProfile(uint8_t StepBackwards, const SLogbookHeader* pHead);
+void logbook_readStandardProfile(uint8_t* pTarget, uint16_t length);
 
 #endif /* LOGBOOK_H */
@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////
+/// -*- coding: UTF-8 -*-
+///
+/// \file   Discovery/Inc/logbook_compact.h
+/// \brief  compact (delta / varint) encoding of the logbook samples
+/// \author heinrichs weikamp gmbh
+/// \date   17-Oct-2026
+///
+/// \details
+///	Used by logbook.c on the device and by HostSim/logbook_image to decode
+///	dumps, so both read the same format.
+///
+/// $Id$
+///////////////////////////////////////////////////////////////////////////////
+///     This program is free software: you can redistribute it and/or modify
+///     it under the terms of the GNU General Public License as published by
+///     the Free Software Foundation, either version 3 of the License, or
+///     (at your option) any later version.
+///
+///     This program is distributed in the hope that it will be useful,
+///     but WITHOUT ANY WARRANTY; without even the implied warranty of
+///     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///     GNU General Public License for more details.
+///
+///     You should have received a copy of the GNU General Public License
+///     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef LOGBOOK_COMPACT_H
+#define LOGBOOK_COMPACT_H
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+#include "logbook.h"
+
+/* Exported constants --------------------------------------------------------*/
+
+/* PROFILE_ENCODING_COMPACT sample: control byte, depth delta, [event length, event bytes], followed by the
+ * fields due at this sample in standard order: temperature delta, [deco/NDL], 3 x (ppO2 delta, voltage delta),
+ * [deco plan], CNS delta, tank delta. Deltas are zig-zag varints, deco/NDL and deco plan are only stored
+ * if they differ from their previous value, otherwise the previous bytes are repeated.
+ */
+#define COMPACT_EVENT			(0x01)	/* event length and event bytes follow */
+#define COMPACT_DECO_NDL		(0x02)	/* deco / NDL bytes follow */
+#define COMPACT_DECOPLAN		(0x04)	/* deco plan follows */
+#define COMPACT_CONTROL_MASK	(0x07)
+#define COMPACT_END_MARKER		(0xFD)	/* first byte of the 0xFD 0xFD end of profile */
+#define COMPACT_MAX_FIELDS		(64)	/* more than the fields following the events in a standard sample */
+#define COMPACT_SAMPLE_SIZE		(256)	/* buffer for one standard sample */
+
+/* fields of a standard sample, as returned by compact_nextSampleFields() */
+#define SAMPLE_TEMPERATURE		(0x01)
+#define SAMPLE_DECO_NDL			(0x02)
+#define SAMPLE_PPO2				(0x04)
+#define SAMPLE_DECOPLAN			(0x08)
+#define SAMPLE_CNS				(0x10)
+#define SAMPLE_TANK				(0x20)
+
+/* Exported types ------------------------------------------------------------*/
+
+typedef struct /* don't forget to adjust compact_setDivisor() */
+{
+	uint8_t temperature;
+	uint8_t deco_ndl;
+	uint8_t gradientFactor;
+	uint8_t ppo2;
+	uint8_t decoplan;
+	uint8_t cns;
+	uint8_t tank;
+} SDivisor;
+
+typedef struct	/* offset of the fields within a standard sample, 0 = not part of the sample */
+{
+	uint8_t eventEnd;
+	uint8_t temperature;
+	uint8_t decoNdl;
+	uint8_t ppo2;
+	uint8_t decoplan;
+	uint8_t cns;
+	uint8_t tank;
+} SSampleLayout;
+
+typedef struct	/* previous values of the compact encoding */
+{
+	int32_t depth;
+	int32_t temperature;
+	int32_t ppo2[3];
+	int32_t voltage[3];
+	int32_t cns;
+	int32_t tank;
+	uint8_t decoNdl[2];
+	uint8_t decoplan[15];
+} SCompactState;
+
+/* reads the next length bytes of the profile */
+typedef void (*CompactReadFunc)(void *pContext, uint8_t *pTarget, uint16_t length);
+
+/* Exported functions --------------------------------------------------------*/
+
+void compact_setDivisor(SDivisor *pDivisor, const SSmallHeader *pSmallHeader);
+uint8_t compact_nextSampleFields(SDivisor *pDivisor, const SSmallHeader *pSmallHeader);
+uint16_t compact_encodeSample(const uint8_t *pSample, const SSampleLayout *pLayout, SCompactState *pLast, uint8_t *pCompact);
+uint16_t compact_decodeSample(uint8_t control, uint8_t fields, const SSmallHeader *pSmallHeader, SCompactState *pLast,
+							  CompactReadFunc pRead, void *pContext, uint8_t *pSample);
+
+#endif /* LOGBOOK_COMPACT_H */
@@ -42,6 +42,26 @@ typedef struct
     float	ppO2AtBottom;
 } SSimDataSummary;
 
+/* one cell of a planner sweep, see simulation_decoplaner_sweep() */
+typedef struct
+{
+    /* input */
+    uint16_t depthMeter;
+    uint16_t intervallTimeMinutes;
+    uint16_t diveTimeMinutes;
+    uint16_t gasMask;              /* bit n enables diveSettings.gas[n], 0: gases as configured */
+    uint8_t decoModel;             /* GF_MODE or VPM_MODE */
+    uint8_t gfLow;
+    uint8_t gfHigh;
+    uint8_t vpmConservatism;
+    /* output */
+    uint8_t valid;
+    float cns;
+    SDecoinfo decoInfo;
+    SSimDataSummary summary;
+    uint16_t gasConsumption[6];
+} SSimPlanCell;
+
 void simulation_start(int aim_depth, uint16_t aim_time_minutes);
 void simulation_exit(void);
 
@@ -54,6 +74,7 @@ uint16_t simulation_get_aim_depth(void);
 _Bool simulation_get_heed_decostops(void);
 SDecoinfo* simulation_decoplaner(uint16_t depth_meter, uint16_t intervall_time_minutes, uint16_t dive_time_minutes, uint8_t *gasChangeListDepthGas20x2);
 SDecoinfo* simulation_decoplaner_Bachelorarbeit_VPM(uint16_t depth_meter, uint16_t intervall_time_minutes, uint16_t dive_time_minutes, uint8_t *gasChangeListDepthGas20x2);
+uint16_t simulation_decoplaner_sweep(SSimPlanCell *pCell, uint16_t cellCount, uint8_t gasConsumTravelInput, uint8_t gasConsumDecoInput);
 void simulation_gas_consumption(uint16_t *outputConsumptionList, uint16_t depth_meter, uint16_t dive_time_minutes, SDecoinfo *decoInfoInput, uint8_t gasConsumTravelInput, uint8_t gasConsumDecoInput, const uint8_t *gasChangeListDepthGas20x2);
 void simulation_helper_change_points(SSimDataSummary *outputSummary, uint16_t depth_meter, uint16_t dive_time_minutes, SDecoinfo *decoInfoInput, const uint8_t *gasChangeListDepthGas20x2);
 
@@ -54,6 +54,7 @@ float vpm_get_CNS(void);
 void vpm_table_init(void);
 uint8_t vpm_get_decozone(void);
 SvpmTableState vpm_get_TableState(void);
+int vpm_get_critical_volume_iterations(void);
 
 
 #endif /* VPM_H */
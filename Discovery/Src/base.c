@@ -455,6 +455,8 @@ int main(void)
     GFX_logoAutoOff();
     EXTILine_Buttons_Config();
 
+    ext_flash_recover_sample_cache();	/* samples of a dive interrupted by a reset */
+
 #ifdef TRUST_LOG_CONSISTENCY
     if(!ext_dive_log_consistent())	/* only repair log if an invalid entry was detected */
     {
@@ -531,6 +533,11 @@ int main(void)
         {
            	DoHousekeeping = housekeepingFrame();
         }
+        ext_flash_commit_sample_cache();		/* program logbook samples collected in RAM */
+        if(stateUsed->mode == MODE_SURFACE)
+        {
+        	ext_flash_preerase_samples();		/* erase flash for the next dive in the background */
+        }
         if(DoDisplayRefresh)							/* set every 100ms by timer interrupt */
         {
 	        DoDisplayRefresh = 0;
@@ -18,6 +18,12 @@ extern const float buehlmann_N2_a[];
 extern const float buehlmann_N2_b[];
 extern const float buehlmann_He_a[];
 extern const float buehlmann_He_b[];
+extern const float nitrogen_time_constant[];
+extern const float helium_time_constant[];
+extern const float float_buehlmann_N2_factor_expositon_one_minute[];
+extern const float float_buehlmann_He_factor_expositon_one_minute[];
+extern const float float_buehlmann_N2_factor_expositon_five_minutes[];
+extern const float float_buehlmann_He_factor_expositon_five_minutes[];
 
 typedef struct
 {
@@ -34,6 +40,25 @@ typedef struct
 # define PRESSURE_150_CM 0.15f
 # define PRESSURE_HALF_METER 0.05f
 
+#define DECO_STOP_STEP_SECONDS		(10)
+#define DECO_STOP_MAX_STEPS			(999 * 60 / DECO_STOP_STEP_SECONDS)
+
+#define BUEHLMANN_WARM_START_SLOTS	(2)		/* actual and future deco plan of deco_loop() */
+
+/* result of the previous calculation for one output structure, used as starting point of the stop search */
+typedef struct
+{
+	SDecoinfo *pDecoInfo;
+	uint8_t gf_low;
+	uint8_t gf_high;
+	uint8_t ascentRate_meterperminute;
+	float last_stop_depth_bar;
+	float input_second_to_last_stop_depth_bar;
+	float input_next_stop_increment_depth_bar;
+	SGas decogaslist[BUEHLMANN_STRUCT_MAX_GASES];
+	unsigned short stop_length_seconds[DECOINFO_STRUCT_MAX_STOPS];
+} SWarmStart;
+
 static void buehlmann_backup_and_restore(_Bool backup_restore_otherwise);
 static float tissue_tolerance(void);
 static void ambient_bar_to_deco_stop_depth_bar(SDiveSettings *pDiveSettings, float ceiling);
@@ -42,20 +67,28 @@ static float next_stop_depth_input_is_actual_stop_id(SDiveSettings *pDiveSetting
 static float get_gf_at_pressure(SDiveSettings *pDiveSettings, float pressure);
 static int buehlmann_calc_ndl(SDiveSettings *pDiveSettings);
 static _Bool dive1_check_deco(SDiveSettings *pDiveSettings);
+static void buehlmann_calc_deco_plan(SLifeData* pLifeData, SDiveSettings * pDiveSettings, SDecoinfo * pDecoInfo, const unsigned short *pStopHint);
+static int buehlmann_solve_stop_steps(SDiveSettings *pDiveSettings, float next_depth, int hint_steps);
 
 static float gSurface_pressure_bar;
 static float gPressure;
 static int gGas_id;
 static float gTissue_nitrogen_bar[16];
 static float gTissue_helium_bar[16];
+static STissueTolerance gTissue_tolerance;
 static float gGF_value;
 static float gCNS;
 
 float gGF_low_depth_bar;
 SStop gStop;
 
+static SWarmStart gWarmStart[BUEHLMANN_WARM_START_SLOTS];
+static uint8_t gWarmStartNext = 0;
+
 void buehlmann_init(void)
 {
+	memset(gWarmStart, 0, sizeof(gWarmStart));
+	gWarmStartNext = 0;
 }
 
 static void buehlmann_backup_and_restore(_Bool backup_restore_otherwise)
@@ -93,7 +126,66 @@ float buehlmann_get_gCNS(void)
 	return gCNS;
 }
 
+static SWarmStart* buehlmann_get_warm_start(SDiveSettings *pDiveSettings, SDecoinfo *pDecoInfo, _Bool *pValid)
+{
+	SWarmStart *pWarmStart = NULL;
+
+	for(int i = 0; i < BUEHLMANN_WARM_START_SLOTS; i++)
+	{
+		if(gWarmStart[i].pDecoInfo == pDecoInfo)
+		{
+			pWarmStart = &gWarmStart[i];
+			break;
+		}
+	}
+	if(pWarmStart == NULL)
+	{
+		pWarmStart = &gWarmStart[gWarmStartNext];
+		gWarmStartNext = (gWarmStartNext + 1) % BUEHLMANN_WARM_START_SLOTS;
+		pWarmStart->pDecoInfo = NULL;
+	}
+
+	/* any change of gases or parameters => previous plan is no valid starting point */
+	*pValid = (pWarmStart->pDecoInfo == pDecoInfo)
+			&& (pWarmStart->gf_low == pDiveSettings->gf_low)
+			&& (pWarmStart->gf_high == pDiveSettings->gf_high)
+			&& (pWarmStart->ascentRate_meterperminute == pDiveSettings->ascentRate_meterperminute)
+			&& (pWarmStart->last_stop_depth_bar == pDiveSettings->last_stop_depth_bar)
+			&& (pWarmStart->input_second_to_last_stop_depth_bar == pDiveSettings->input_second_to_last_stop_depth_bar)
+			&& (pWarmStart->input_next_stop_increment_depth_bar == pDiveSettings->input_next_stop_increment_depth_bar)
+			&& (memcmp(pWarmStart->decogaslist, pDiveSettings->decogaslist, sizeof(pWarmStart->decogaslist)) == 0);
+
+	if(!*pValid)
+	{
+		pWarmStart->pDecoInfo = pDecoInfo;
+		pWarmStart->gf_low = pDiveSettings->gf_low;
+		pWarmStart->gf_high = pDiveSettings->gf_high;
+		pWarmStart->ascentRate_meterperminute = pDiveSettings->ascentRate_meterperminute;
+		pWarmStart->last_stop_depth_bar = pDiveSettings->last_stop_depth_bar;
+		pWarmStart->input_second_to_last_stop_depth_bar = pDiveSettings->input_second_to_last_stop_depth_bar;
+		pWarmStart->input_next_stop_increment_depth_bar = pDiveSettings->input_next_stop_increment_depth_bar;
+		memcpy(pWarmStart->decogaslist, pDiveSettings->decogaslist, sizeof(pWarmStart->decogaslist));
+	}
+	return pWarmStart;
+}
+
+//  ===============================================================================
+//	buehlmann_calc_deco
+/// @brief	The stop list of the previous call for the same pDecoInfo is used as hint
+///			for the stop search (warm start). A change of gases, GF or stop settings
+///			and buehlmann_init() discard the hint => full calculation.
+//  ===============================================================================
 void buehlmann_calc_deco(SLifeData* pLifeData, SDiveSettings * pDiveSettings, SDecoinfo * pDecoInfo)
+{
+	SWarmStart *pWarmStart;
+	_Bool warmStartValid;
+
+	pWarmStart = buehlmann_get_warm_start(pDiveSettings, pDecoInfo, &warmStartValid);
+	buehlmann_calc_deco_plan(pLifeData, pDiveSettings, pDecoInfo, warmStartValid ? pWarmStart->stop_length_seconds : NULL);
+	memcpy(pWarmStart->stop_length_seconds, pDecoInfo->output_stop_length_seconds, sizeof(pWarmStart->stop_length_seconds));
+}
+
+static void buehlmann_calc_deco_plan(SLifeData* pLifeData, SDiveSettings * pDiveSettings, SDecoinfo * pDecoInfo, const unsigned short *pStopHint)
 {
 	float ceiling;
 	int ascend_time;
@@ -103,6 +195,7 @@ void buehlmann_calc_deco(SLifeData* pLifeData, SDiveSettings * pDiveSettings, SD
 	_Bool deco_reached = false;
 	unsigned short *stoplist;
 	int i;
+	int stop_steps;
 
 	gCNS = 0;
 	pDecoInfo->output_time_to_surface_seconds = 0;
@@ -229,31 +322,14 @@ void buehlmann_calc_deco(SLifeData* pLifeData, SDiveSettings * pDiveSettings, SD
 
 	while(gStop.depth > 0)
 	{
-		do
-		{
-			next_depth = next_stop_depth_input_is_actual_stop_id(pDiveSettings, gStop.id);
-			gGF_value = get_gf_at_pressure(pDiveSettings, next_depth + gSurface_pressure_bar);
-			buehlmann_backup_and_restore(true);
-			ascend_time = ascend_with_all_gaschanges(pDiveSettings, gStop.depth - next_depth);
-			ceiling = tissue_tolerance();
-			/* pre check actual limit */
-			if(pDecoInfo->output_stop_length_seconds[gStop.id] >= 999*60)
-			{
-				tts_seconds -= 999*60 - pDecoInfo->output_stop_length_seconds[gStop.id];
-				pDecoInfo->output_stop_length_seconds[gStop.id] = 999*60;
-			}
-			else
-			/* more deco on the actual depth */
-			if(ceiling > next_depth + gSurface_pressure_bar)
-			{
-				next_depth = -1;
-				buehlmann_backup_and_restore(false);
-				decom_tissues_exposure2(10, &pDiveSettings->decogaslist[gGas_id], gPressure,gTissue_nitrogen_bar,gTissue_helium_bar); // some seconds at least at each stop
-				decom_oxygen_calculate_cns_exposure(10, &pDiveSettings->decogaslist[gGas_id], gPressure, &gCNS);
-				pDecoInfo->output_stop_length_seconds[gStop.id] += 10;
-        tts_seconds += 10;
-			}
-		} while(next_depth == -1);
+		next_depth = next_stop_depth_input_is_actual_stop_id(pDiveSettings, gStop.id);
+		gGF_value = get_gf_at_pressure(pDiveSettings, next_depth + gSurface_pressure_bar);
+
+		stop_steps = buehlmann_solve_stop_steps(pDiveSettings, next_depth, (pStopHint != NULL) ? (pStopHint[gStop.id] / 10) : 0);
+		pDecoInfo->output_stop_length_seconds[gStop.id] += stop_steps * 10;
+		tts_seconds += stop_steps * 10;
+
+		ascend_time = ascend_with_all_gaschanges(pDiveSettings, gStop.depth - next_depth);
 		tts_seconds += ascend_time;
 		gStop.depth = next_depth;
     for(i = gGas_id + 1; i < BUEHLMANN_STRUCT_MAX_GASES; i++)
@@ -283,46 +359,143 @@ void buehlmann_calc_deco(SLifeData* pLifeData, SDiveSettings * pDiveSettings, SD
 }
 
 
-static float tissue_tolerance(void)
+typedef struct
+{
+	float tissue_nitrogen_bar[16];
+	float tissue_helium_bar[16];
+	float cns;
+} SStopState;
+
+static void stop_state_expose(SDiveSettings *pDiveSettings, SStopState *pState, float cns_step, int steps)
+{
+	for(int i = 0; i < steps; i++)
+	{
+		decom_tissues_exposure2(DECO_STOP_STEP_SECONDS, &pDiveSettings->decogaslist[gGas_id], gPressure, pState->tissue_nitrogen_bar, pState->tissue_helium_bar);
+		pState->cns += cns_step;
+	}
+}
+
+/* ceiling after the ascent to next_depth, starting with the tissues of pState */
+static float stop_state_ceiling(SDiveSettings *pDiveSettings, const SStopState *pState, float next_depth)
 {
-	float tissue_inertgas_saturation;
-	float inertgas_a;
-	float inertgas_b;
 	float ceiling;
-	float global_ceiling;
-	int ci;
 
-	global_ceiling = -1;
+	memcpy(gTissue_nitrogen_bar, pState->tissue_nitrogen_bar, (4*16));
+	memcpy(gTissue_helium_bar, pState->tissue_helium_bar, (4*16));
+	gCNS = pState->cns;
+	buehlmann_backup_and_restore(true);
+	ascend_with_all_gaschanges(pDiveSettings, gStop.depth - next_depth);
+	ceiling = tissue_tolerance();
+	buehlmann_backup_and_restore(false);
 
-	for (ci = 0; ci < 16; ci++)
+	return ceiling;
+}
+
+//  ===============================================================================
+//	buehlmann_solve_stop_steps
+/// @brief	Number of 10 second steps at the actual stop (gStop) until the ascent to
+///			next_depth is possible. Leaves the tissues at the end of the stop.
+///
+///			Same result as adding 10 seconds until the ceiling clears: the exposure
+///			is still applied in 10 second steps (identical float results), but the
+///			ascent check is done for a few candidates only. The previous stop length
+///			(hint_steps, 0 = none) is checked first, then the step count is bracketed
+///			with doubling steps and bisected.
+///			This requires the ceiling after the ascent to fall with the time at the
+///			stop. A candidate which does not clear is therefore compared with one step
+///			more. If the ceiling does not fall (e.g. slow compartments on-gassing at
+///			a shallow stop on a long schedule) the stop is searched step by step.
+//  ===============================================================================
+static int buehlmann_solve_stop_steps(SDiveSettings *pDiveSettings, float next_depth, int hint_steps)
+{
+	SStopState begin;
+	SStopState lower;		/* state after lower_steps: ascent not possible (or begin of stop) */
+	SStopState probe;
+	float cns_step = 0;
+	float ceiling_limit = next_depth + gSurface_pressure_bar;
+	float ceiling;
+	float ceiling_next;
+	int lower_steps = -1;
+	int upper_steps = DECO_STOP_MAX_STEPS;	/* ascent possible or limit reached */
+	int probe_steps;
+	int increment = 1;
+	_Bool stepwise = false;
+
+	memcpy(begin.tissue_nitrogen_bar, gTissue_nitrogen_bar, (4*16));
+	memcpy(begin.tissue_helium_bar, gTissue_helium_bar, (4*16));
+	begin.cns = gCNS;
+	memcpy(&lower, &begin, sizeof(SStopState));
+	decom_oxygen_calculate_cns_exposure(DECO_STOP_STEP_SECONDS, &pDiveSettings->decogaslist[gGas_id], gPressure, &cns_step);
+
+	while((upper_steps - lower_steps > 1) && !stepwise)
 	{
-		if(gTissue_helium_bar[ci] == 0)
+		if((hint_steps - 1 > lower_steps) && (hint_steps - 1 < upper_steps))
+			probe_steps = hint_steps - 1;
+		else
+		if((hint_steps > lower_steps) && (hint_steps < upper_steps))
+			probe_steps = hint_steps;
+		else
+		if(upper_steps == DECO_STOP_MAX_STEPS)
 		{
-			tissue_inertgas_saturation = gTissue_nitrogen_bar[ci];
-			//
-			inertgas_a = buehlmann_N2_a[ci];
-			inertgas_b = buehlmann_N2_b[ci];
+			probe_steps = lower_steps + increment;
+			increment *= 2;
+			if(probe_steps >= upper_steps)
+				probe_steps = lower_steps + (upper_steps - lower_steps) / 2;
 		}
 		else
+			probe_steps = lower_steps + (upper_steps - lower_steps) / 2;
+
+		memcpy(&probe, &lower, sizeof(SStopState));
+		stop_state_expose(pDiveSettings, &probe, cns_step, probe_steps - ((lower_steps < 0) ? 0 : lower_steps));
+		ceiling = stop_state_ceiling(pDiveSettings, &probe, next_depth);
+
+		if(!(ceiling > ceiling_limit))
+		{
+			upper_steps = probe_steps;
+		}
+		else
+		{
+			lower_steps = probe_steps;
+			memcpy(&lower, &probe, sizeof(SStopState));
+
+			stop_state_expose(pDiveSettings, &probe, cns_step, 1);
+			ceiling_next = stop_state_ceiling(pDiveSettings, &probe, next_depth);
+			if(!(ceiling_next < ceiling))
+				stepwise = true;
+		}
+	}
+
+	if(stepwise)
+	{
+		memcpy(&lower, &begin, sizeof(SStopState));
+		for(upper_steps = 0; upper_steps < DECO_STOP_MAX_STEPS; upper_steps++)
 		{
-			tissue_inertgas_saturation =  gTissue_nitrogen_bar[ci] + gTissue_helium_bar[ci];
-			//
-			inertgas_a = ( ( buehlmann_N2_a[ci] *  gTissue_nitrogen_bar[ci]) + ( buehlmann_He_a[ci] * gTissue_helium_bar[ci]) ) / tissue_inertgas_saturation;
-			inertgas_b = ( ( buehlmann_N2_b[ci] *  gTissue_nitrogen_bar[ci]) + ( buehlmann_He_b[ci] * gTissue_helium_bar[ci]) ) / tissue_inertgas_saturation;
+			if(!(stop_state_ceiling(pDiveSettings, &lower, next_depth) > ceiling_limit))
+				break;
+			stop_state_expose(pDiveSettings, &lower, cns_step, 1);
 		}
-		//
-		ceiling = (inertgas_b * ( tissue_inertgas_saturation - gGF_value * inertgas_a ) ) / (gGF_value - (inertgas_b * gGF_value) + inertgas_b);
-		if(ceiling > global_ceiling)
-			global_ceiling = ceiling;
 	}
-	return global_ceiling;
+	else
+	{
+		/* step from the last state which did not clear to the final one */
+		stop_state_expose(pDiveSettings, &lower, cns_step, upper_steps - ((lower_steps < 0) ? 0 : lower_steps));
+	}
+
+	memcpy(gTissue_nitrogen_bar, lower.tissue_nitrogen_bar, (4*16));
+	memcpy(gTissue_helium_bar, lower.tissue_helium_bar, (4*16));
+	gCNS = lower.cns;
+
+	return upper_steps;
+}
+
+static float tissue_tolerance(void)
+{
+	decom_tissue_tolerance_load(&gTissue_tolerance, gTissue_nitrogen_bar, gTissue_helium_bar);
+	return decom_tissue_tolerance_ceiling(&gTissue_tolerance, gGF_value);
 }
 
 void buehlmann_super_saturation_calculator(SLifeData* pLifeData, SDecoinfo * pDecoInfo)
 {
-	float tissue_inertgas_saturation;
-	float inertgas_a;
-	float inertgas_b;
 	float ceiling;
 	float super_saturation;
 	float pres_respiration = pLifeData->pressure_ambient_bar;
@@ -330,26 +503,14 @@ void buehlmann_super_saturation_calculator(SLifeData* pLifeData, SDecoinfo * pDe
 
 	pDecoInfo->super_saturation = 0;
 
+	/* gTissue_tolerance has been loaded by buehlmann_ceiling_calculator() */
 	for (ci = 0; ci < 16; ci++)
 	{
-		if(gTissue_helium_bar[ci] == 0)
-		{
-			tissue_inertgas_saturation = gTissue_nitrogen_bar[ci];
-			inertgas_a = buehlmann_N2_a[ci];
-			inertgas_b = buehlmann_N2_b[ci];
-		}
-		else
-		{
-			tissue_inertgas_saturation =  gTissue_nitrogen_bar[ci] + gTissue_helium_bar[ci];
-			inertgas_a = ( ( buehlmann_N2_a[ci] *  gTissue_nitrogen_bar[ci]) + ( buehlmann_He_a[ci] * gTissue_helium_bar[ci]) ) / tissue_inertgas_saturation;
-			inertgas_b = ( ( buehlmann_N2_b[ci] *  gTissue_nitrogen_bar[ci]) + ( buehlmann_He_b[ci] * gTissue_helium_bar[ci]) ) / tissue_inertgas_saturation;
-		}
-
-		ceiling = pres_respiration / inertgas_b + inertgas_a;
-		if(tissue_inertgas_saturation > pres_respiration)
+		ceiling = pres_respiration / gTissue_tolerance.inertgas_b[ci] + gTissue_tolerance.inertgas_a[ci];
+		if(gTissue_tolerance.inertgas_saturation[ci] > pres_respiration)
 		{
 			super_saturation =
-					(tissue_inertgas_saturation - pres_respiration) / (ceiling - pres_respiration);
+					(gTissue_tolerance.inertgas_saturation[ci] - pres_respiration) / (ceiling - pres_respiration);
 
 			if (super_saturation > pDecoInfo->super_saturation)
 				pDecoInfo->super_saturation = super_saturation;
@@ -360,33 +521,7 @@ void buehlmann_super_saturation_calculator(SLifeData* pLifeData, SDecoinfo * pDe
 
 static float buehlmann_tissue_test_tolerance(float depth_in_bar_absolute)
 {
-	float tissue_inertgas_saturation;
-	float inertgas_a;
-	float inertgas_b;
-	float inertgas_tolerance;
-	float gf_minus_1;
-
-	gf_minus_1 = gGF_value - 1.0f;
-
-	for (int ci = 0; ci < 16; ci++)
-	{
-		if(gTissue_helium_bar[ci] == 0)
-		{
-			tissue_inertgas_saturation = gTissue_nitrogen_bar[ci];
-			inertgas_a = buehlmann_N2_a[ci];
-			inertgas_b = buehlmann_N2_b[ci];
-		}
-		else
-		{
-			tissue_inertgas_saturation =  gTissue_nitrogen_bar[ci] + gTissue_helium_bar[ci];
-			inertgas_a = ( ( buehlmann_N2_a[ci] *  gTissue_nitrogen_bar[ci]) + ( buehlmann_He_a[ci] * gTissue_helium_bar[ci]) ) / tissue_inertgas_saturation;
-			inertgas_b = ( ( buehlmann_N2_b[ci] *  gTissue_nitrogen_bar[ci]) + ( buehlmann_He_b[ci] * gTissue_helium_bar[ci]) ) / tissue_inertgas_saturation;
-		}
-		inertgas_tolerance = ( (gGF_value / inertgas_b - gf_minus_1) * depth_in_bar_absolute ) + ( gGF_value * inertgas_a );
-		if(inertgas_tolerance < tissue_inertgas_saturation)
-			return tissue_inertgas_saturation - inertgas_tolerance; // positive
-	}
-	return tissue_inertgas_saturation - inertgas_tolerance; // negative
+	return decom_tissue_tolerance_margin(&gTissue_tolerance, gGF_value, depth_in_bar_absolute);
 }
 
 
@@ -537,55 +672,291 @@ static float get_gf_at_pressure(SDiveSettings *pDiveSettings, float pressure)
 }
 
 #define MAX_NDL 240
+#define NDL_NEWTON_ITERATIONS	(12)
+#define NDL_SCAN_MINUTES		(10)		/* blocks of the counter diffusion scan, two five minute steps */
+
+/* inspired inert gas pressures at the actual depth */
+static void ndl_inspired_pressures(SDiveSettings *pDiveSettings, float *pNitrogen, float *pHelium)
+{
+	float fraction_nitrogen;
+	float fraction_helium;
+
+	decom_get_inert_gases(gPressure, &pDiveSettings->decogaslist[gGas_id], &fraction_nitrogen, &fraction_helium);
+	*pNitrogen = (gPressure - WATER_VAPOUR_PRESSURE) * fraction_nitrogen;
+	*pHelium = (gPressure - WATER_VAPOUR_PRESSURE) * fraction_helium;
+}
+
+/* margin of one compartment against the tolerated surface pressure (positive => deco) and its derivative */
+static float ndl_compartment_margin(int ci, float nitrogen, float helium, float dNitrogen, float dHelium, float *pDerivative)
+{
+	float p = nitrogen + helium;
+	float a = buehlmann_N2_a[ci] * nitrogen + buehlmann_He_a[ci] * helium;
+	float b = buehlmann_N2_b[ci] * nitrogen + buehlmann_He_b[ci] * helium;
+	float d_margin_dN;
+	float d_margin_dHe;
+
+	/* tolerance = (gf / b_mix - gf + 1) * surface + gf * a_mix, a_mix = a / p, b_mix = b / p */
+	d_margin_dN  = 1.0f - gGF_value * gSurface_pressure_bar * (b - p * buehlmann_N2_b[ci]) / (b * b)
+					- gGF_value * (buehlmann_N2_a[ci] * p - a) / (p * p);
+	d_margin_dHe = 1.0f - gGF_value * gSurface_pressure_bar * (b - p * buehlmann_He_b[ci]) / (b * b)
+					- gGF_value * (buehlmann_He_a[ci] * p - a) / (p * p);
+	*pDerivative = d_margin_dN * dNitrogen + d_margin_dHe * dHelium;
+
+	return p - ((gGF_value * p / b - gGF_value + 1.0f) * gSurface_pressure_bar + gGF_value * a / p);
+}
+
+//  ===============================================================================
+//	ndl_scan_counter_diffusion
+/// @brief	First minute (max_minutes at most) in which the margin of compartment ci
+///			exceeds the tolerance while N2 and He move in opposite directions. The
+///			margin may then exceed the tolerance only for a while.
+///			Within a block of NDL_SCAN_MINUTES both gases are monotonic, so the
+///			pressure stays below the sum of their maxima. a and b of He are above /
+///			below the ones of N2 in all compartments, the tolerance therefore rises
+///			with the He ratio and stays above the one of the lowest ratio (N2 max,
+///			He min). Blocks with this bound tolerated are skipped, the others are
+///			checked minute by minute. Step factors are the tables of decom.c.
+//  ===============================================================================
+static int ndl_scan_counter_diffusion(int ci, float inspired_nitrogen, float inspired_helium, int max_minutes)
+{
+	float step_nitrogen = 1.0f - float_buehlmann_N2_factor_expositon_one_minute[ci];
+	float step_helium = 1.0f - float_buehlmann_He_factor_expositon_one_minute[ci];
+	float block_nitrogen = 1.0f - float_buehlmann_N2_factor_expositon_five_minutes[ci];
+	float block_helium = 1.0f - float_buehlmann_He_factor_expositon_five_minutes[ci];
+	float nitrogen = gTissue_nitrogen_bar[ci];
+	float helium = gTissue_helium_bar[ci];
+	float nitrogen_end;
+	float helium_end;
+	float derivative;
+	int minute = 0;
+
+	block_nitrogen *= block_nitrogen;
+	block_helium *= block_helium;
+
+	while(minute < max_minutes)
+	{
+		nitrogen_end = inspired_nitrogen + (nitrogen - inspired_nitrogen) * block_nitrogen;
+		helium_end = inspired_helium + (helium - inspired_helium) * block_helium;
+
+		if(ndl_compartment_margin(ci, fmaxf(nitrogen, nitrogen_end), fminf(helium, helium_end), 0, 0, &derivative)
+				+ fabsf(helium_end - helium) <= 0)
+		{
+			nitrogen = nitrogen_end;
+			helium = helium_end;
+			minute += NDL_SCAN_MINUTES;
+			continue;
+		}
+
+		for(int i = 0; (i < NDL_SCAN_MINUTES) && (minute < max_minutes); i++)
+		{
+			nitrogen = inspired_nitrogen + (nitrogen - inspired_nitrogen) * step_nitrogen;
+			helium = inspired_helium + (helium - inspired_helium) * step_helium;
+			minute++;
+			if(ndl_compartment_margin(ci, nitrogen, helium, 0, 0, &derivative) > 0)
+				return minute;
+		}
+	}
+	return max_minutes;
+}
+
+//  ===============================================================================
+//	ndl_estimate_minutes
+/// @brief	Time at the actual depth until the first compartment exceeds its
+///			tolerated surface pressure (ascent not considered).
+///			N2 only: a / b are constant => closed form. N2 + He: a / b depend on the
+///			ratio of both gases => Newton iteration, bracketed by bisection.
+///			N2 and He in opposite directions (counter diffusion): neither the end
+///			of the range nor Newton would notice a margin exceeded only for a
+///			while => ndl_scan_counter_diffusion().
+//  ===============================================================================
+static int ndl_estimate_minutes(SDiveSettings *pDiveSettings)
+{
+	float inspired_nitrogen;
+	float inspired_helium;
+	float ndl_minutes = MAX_NDL;
+	float tolerance;
+	float t, t_low, t_high;
+	float nitrogen, helium, margin, derivative;
+	float exp_nitrogen, exp_helium;
+
+	ndl_inspired_pressures(pDiveSettings, &inspired_nitrogen, &inspired_helium);
+
+	for(int ci = 0; ci < 16; ci++)
+	{
+		if((gTissue_helium_bar[ci] == 0) && (inspired_helium == 0))
+		{
+			tolerance = (gGF_value / buehlmann_N2_b[ci] - gGF_value + 1.0f) * gSurface_pressure_bar + gGF_value * buehlmann_N2_a[ci];
+			if(gTissue_nitrogen_bar[ci] >= tolerance)
+				return 0;
+			if(inspired_nitrogen <= tolerance)
+				continue;
+			t = logf((inspired_nitrogen - gTissue_nitrogen_bar[ci]) / (inspired_nitrogen - tolerance)) / nitrogen_time_constant[ci];
+		}
+		else if(((inspired_nitrogen - gTissue_nitrogen_bar[ci]) * (inspired_helium - gTissue_helium_bar[ci])) < 0)
+		{
+			t = ndl_scan_counter_diffusion(ci, inspired_nitrogen, inspired_helium, (int)ndl_minutes);
+		}
+		else
+		{
+			t_low = 0;
+			t_high = ndl_minutes;
+
+			/* margin at the end of the search range, nothing to do if still tolerated */
+			exp_nitrogen = expf(-nitrogen_time_constant[ci] * t_high);
+			exp_helium = expf(-helium_time_constant[ci] * t_high);
+			nitrogen = inspired_nitrogen + (gTissue_nitrogen_bar[ci] - inspired_nitrogen) * exp_nitrogen;
+			helium = inspired_helium + (gTissue_helium_bar[ci] - inspired_helium) * exp_helium;
+			if(ndl_compartment_margin(ci, nitrogen, helium, 0, 0, &derivative) <= 0)
+				continue;
+
+			t = t_high / 2;
+			for(int i = 0; i < NDL_NEWTON_ITERATIONS; i++)
+			{
+				exp_nitrogen = expf(-nitrogen_time_constant[ci] * t);
+				exp_helium = expf(-helium_time_constant[ci] * t);
+				nitrogen = inspired_nitrogen + (gTissue_nitrogen_bar[ci] - inspired_nitrogen) * exp_nitrogen;
+				helium = inspired_helium + (gTissue_helium_bar[ci] - inspired_helium) * exp_helium;
+				margin = ndl_compartment_margin(ci, nitrogen, helium,
+								nitrogen_time_constant[ci] * (inspired_nitrogen - nitrogen),
+								helium_time_constant[ci] * (inspired_helium - helium), &derivative);
+				if(margin > 0)
+					t_high = t;
+				else
+					t_low = t;
+				if(t_high - t_low < 0.1f)
+					break;
+
+				/* Newton step, bisection if it leaves the bracket */
+				if(derivative > 0)
+					t -= margin / derivative;
+				if((derivative <= 0) || (t <= t_low) || (t >= t_high))
+					t = (t_low + t_high) / 2;
+			}
+			t = t_high;
+		}
+		if(t < ndl_minutes)
+			ndl_minutes = t;
+	}
+	return (int)ndl_minutes;
+}
+
+/* deco obligation after the check of the tissues in gTissue_nitrogen_bar / gTissue_helium_bar, these stay unchanged */
+static _Bool ndl_check_deco(SDiveSettings *pDiveSettings)
+{
+	_Bool deco;
+
+	buehlmann_backup_and_restore(true);
+	deco = dive1_check_deco(pDiveSettings);
+	buehlmann_backup_and_restore(false);
+
+	return deco;
+}
+
+/* deco obligation after minutes at the actual depth, starting from pNitrogen / pHelium */
+static _Bool ndl_check_deco_after(SDiveSettings *pDiveSettings, const float *pNitrogen, const float *pHelium, int minutes)
+{
+	float inspired_nitrogen;
+	float inspired_helium;
+
+	/* closed form like decom_tissues_exposure2(), without a period in its cache */
+	ndl_inspired_pressures(pDiveSettings, &inspired_nitrogen, &inspired_helium);
+	for(int ci = 0; ci < 16; ci++)
+	{
+		gTissue_nitrogen_bar[ci] = pNitrogen[ci] + (inspired_nitrogen - pNitrogen[ci]) * -expm1f(-nitrogen_time_constant[ci] * minutes);
+		gTissue_helium_bar[ci] = pHelium[ci] + (inspired_helium - pHelium[ci]) * -expm1f(-helium_time_constant[ci] * minutes);
+	}
+	return ndl_check_deco(pDiveSettings);
+}
+
+/* deco obligation one minute after the previous check */
+static _Bool ndl_check_deco_next_minute(SDiveSettings *pDiveSettings)
+{
+	float inspired_nitrogen;
+	float inspired_helium;
+
+	ndl_inspired_pressures(pDiveSettings, &inspired_nitrogen, &inspired_helium);
+	for(int ci = 0; ci < 16; ci++)
+	{
+		gTissue_nitrogen_bar[ci] += (inspired_nitrogen - gTissue_nitrogen_bar[ci]) * float_buehlmann_N2_factor_expositon_one_minute[ci];
+		gTissue_helium_bar[ci] += (inspired_helium - gTissue_helium_bar[ci]) * float_buehlmann_He_factor_expositon_one_minute[ci];
+	}
+	return ndl_check_deco(pDiveSettings);
+}
+
+/* CNS of the time at depth the former block wise NDL search exposed, part of the plans of simulation.c */
+static void ndl_expose_cns(SDiveSettings *pDiveSettings, int ndl)
+{
+	int blocks;
+	int minutes = 0;
+
+	if(ndl > MAX_NDL)
+		blocks = MAX_NDL / 10;
+	else
+	{
+		blocks = (ndl + 9) / 10;
+		if((blocks - 1) * 10 <= MAX_NDL / 2)
+			minutes = ndl - (blocks - 1) * 10;
+	}
+
+	while(blocks--)
+		decom_oxygen_calculate_cns_exposure(600, &pDiveSettings->decogaslist[gGas_id], gPressure, &gCNS);
+	while(minutes--)
+		decom_oxygen_calculate_cns_exposure(60, &pDiveSettings->decogaslist[gGas_id], gPressure, &gCNS);
+}
+
+//  ===============================================================================
+//	buehlmann_calc_ndl
+/// @brief	NDL in seconds: first minute with deco obligation, in 10 minutes steps
+///			beyond MAX_NDL / 2, MAX_NDL at most.
+///			The analytic estimate is verified (and corrected minute by minute) with
+///			dive1_check_deco() which includes the ascent and the gas changes. The
+///			tissues of the estimate are calculated once, the correction upwards
+///			continues from them with the one minute factors of decom.c.
+///			gCNS is increased by the time at depth up to the NDL.
+//  ===============================================================================
 static int buehlmann_calc_ndl(SDiveSettings *pDiveSettings)
 {
 	float local_tissue_nitrogen_bar[16];
 	float local_tissue_helium_bar[16];
-	int i;
-	int ndl = 0;
+	int ndl;
 
 	//Check ndl always use gHigh
 	gGF_value = ((float)pDiveSettings->gf_high) / 100.0f;
-	//10 minutes steps
-	while(ndl < (MAX_NDL * 60))
+
+	memcpy(local_tissue_nitrogen_bar, gTissue_nitrogen_bar, (4*16));
+	memcpy(local_tissue_helium_bar, gTissue_helium_bar, (4*16));
+
+	ndl = ndl_estimate_minutes(pDiveSettings);
+	if(ndl < 1)
+		ndl = 1;
+
+	if(ndl_check_deco_after(pDiveSettings, local_tissue_nitrogen_bar, local_tissue_helium_bar, ndl))
 	{
-		memcpy(local_tissue_nitrogen_bar, gTissue_nitrogen_bar, (4*16));
-		memcpy(local_tissue_helium_bar, gTissue_helium_bar, (4*16));
-		//
-		ndl += 600;
-		decom_tissues_exposure2(600, &pDiveSettings->decogaslist[gGas_id], gPressure,gTissue_nitrogen_bar,gTissue_helium_bar);
-		decom_oxygen_calculate_cns_exposure(600,&pDiveSettings->decogaslist[gGas_id],gPressure,&gCNS);
-		buehlmann_backup_and_restore(true);
-		if(dive1_check_deco(pDiveSettings))
+		while((ndl > 1) && ndl_check_deco_after(pDiveSettings, local_tissue_nitrogen_bar, local_tissue_helium_bar, ndl - 1))
+			ndl--;
+	}
+	else
+	{
+		do
 		{
-			buehlmann_backup_and_restore(false);
-			break;
-		}
-		buehlmann_backup_and_restore(false);
+			ndl++;
+		} while((ndl <= MAX_NDL) && !ndl_check_deco_next_minute(pDiveSettings));
 	}
 
-	if(ndl < (MAX_NDL * 60))
-		ndl -= 600;
-
-	if(ndl > (MAX_NDL/2 * 60))
-		return ndl;
-
-	// refine
 	memcpy(gTissue_nitrogen_bar, local_tissue_nitrogen_bar, (4*16));
 	memcpy(gTissue_helium_bar, local_tissue_helium_bar, (4*16));
 
-	//One minutes step
-	for(i = 0; i < 10; i++)
-	{
-		ndl += 60;
-		decom_tissues_exposure2(60, &pDiveSettings->decogaslist[gGas_id], gPressure,gTissue_nitrogen_bar,gTissue_helium_bar);
-		decom_oxygen_calculate_cns_exposure(60,&pDiveSettings->decogaslist[gGas_id],gPressure,&gCNS);
-		buehlmann_backup_and_restore(true);
-		if(dive1_check_deco(pDiveSettings))
-			break;
-		buehlmann_backup_and_restore(false);
-	}
-	return ndl;
+	ndl_expose_cns(pDiveSettings, ndl);
+
+	/* deco within the last 10 minutes step is reported as MAX_NDL as well */
+	if(ndl > MAX_NDL - 10)
+		return MAX_NDL * 60;
+
+	/* long NDL in 10 minutes resolution */
+	if(((ndl - 1) / 10) * 10 > MAX_NDL/2)
+		return ((ndl - 1) / 10) * 10 * 60;
+
+	return ndl * 60;
 }
 
 
@@ -650,6 +1021,7 @@ void buehlmann_ceiling_calculator(SLifeData *pLifeData, SDecoinfo *pDecoInfo)
 
 	memcpy(gTissue_nitrogen_bar, pLifeData->tissue_nitrogen_bar, (4*16));
 	memcpy(gTissue_helium_bar, pLifeData->tissue_helium_bar, (4*16));
+	decom_tissue_tolerance_load(&gTissue_tolerance, gTissue_nitrogen_bar, gTissue_helium_bar);
 
 	// this is just performance optimizing. The code below runs just fine
 	// without this. There is never a ceiling in NDL deco state
@@ -69,6 +69,8 @@
 #include "ostc.h"
 #include "settings.h"
 #include "gfx_engine.h"
+#include <string.h>
+#include <stddef.h>
 
 #ifndef BOOTLOADER_STANDALONE
 #include "logbook.h"
@@ -84,6 +86,22 @@
 
 #define HEADER2OFFSET 0x400
 
+#define READ_BURST_MAX	0x8000	/* HAL_SPI_Receive() takes 16 bit sizes */
+
+#define HEADER_INDEX_SLOTS		(256)
+#define HEADER_SLOTS_PER_64K	(0x10000 / 0x800)
+
+#define SAMPLE_CACHE_PAGE		(0x100)			/* program page size of the flash */
+#define SAMPLE_CACHE_MAGIC		(0x53434146)	/* marks a cache page holding samples of the running dive */
+
+#define SAMPLE_SECTOR_COUNT		((SAMPLESTOP + 1 - SAMPLESTART) / 0x10000)
+#define SAMPLE_PREERASE_SECTORS	(2)			/* 64k sectors kept erased ahead of the next sample while at the surface */
+#define SAMPLE_PREERASE_CHECK	(0x400)		/* bytes of a sector verified per call of ext_flash_preerase_samples() */
+
+#define JOURNAL_MAGIC			(0x4A50)	/* marks a written entry of the pointer journal */
+#define JOURNAL_ENTRIES			((JOURNALSTOP + 1 - JOURNALSTART) / sizeof(SLogJournalEntry))
+#define JOURNAL_UNKNOWN			(0xFFFF)	/* position of the next entry not searched yet */
+
 typedef enum{
 	EF_HEADER,
 	EF_SAMPLE,
@@ -92,8 +110,14 @@ typedef enum{
 	EF_SETTINGS,
 	EF_FIRMWARE,
 	EF_FIRMWARE2,
+	EF_JOURNAL,
 }which_ring_enum;
 
+typedef enum{
+	JOURNAL_DIVE_OPEN = 1,		/* a dive or a raw write has started, the ring ends have to be searched */
+	JOURNAL_DIVE_CLOSED,		/* ring ends as recorded by the entry */
+}journal_state_enum;
+
 
 typedef struct{
 uint8_t IsBusy:1;
@@ -112,6 +136,31 @@ uint8_t uw;
 } extFlashStatusBit8_Type;
 
 
+#ifndef BOOTLOADER_STANDALONE
+/* one program page of samples collected in RAM, data[0] belongs to address */
+typedef struct
+{
+	uint32_t magic;
+	uint32_t address;
+	uint16_t length;		/* bytes collected */
+	uint16_t committed;		/* bytes already programmed to the flash */
+	uint16_t checksum;
+	uint8_t data[SAMPLE_CACHE_PAGE];
+} SSampleCachePage;
+#endif
+
+/* entry of the pointer journal, written at the start and the end of every dive */
+typedef struct
+{
+	uint16_t magic;
+	uint8_t state;
+	uint8_t lastDiveLogId;
+	uint32_t diveEnd;				/* pEndProfileData of the post-dive header */
+	uint32_t nextSampleStart;		/* logFlashNextSampleStartAddress after the dive */
+	uint16_t reserved;
+	uint16_t checksum;
+} SLogJournalEntry;
+
 /* Exported variables --------------------------------------------------------*/
 
 /* Private variables ---------------------------------------------------------*/
@@ -120,10 +169,16 @@ uint8_t uw;
 static uint32_t	entryPoint = 0;
 static uint32_t	LengthLeftSampleRead = 0;
 static uint32_t	actualPointerDevicedata_Read = DDSTART;
+static SLogbookHeader *headerIndex = 0;	/* copy of the post-dive header of every slot */
+static uint8_t	headerIndexCheckId = 0;
+
+/* not cleared by the startup code, so samples not yet programmed survive a reset */
+static SSampleCachePage sampleCache[2] __attribute__((section(".noinit")));
+static uint8_t	sampleCacheActive = 0;
 #endif
 
 static uint32_t	actualAddress = 0;
-static uint32_t	preparedPageAddress = 0;
+static uint8_t	sampleSectorErased[(SAMPLE_SECTOR_COUNT + 7) / 8];	/* sample sectors erased and not written since */
 static uint32_t closeSectorAddress = 0;
 static uint32_t	actualPointerHeader = 0;
 static uint32_t	actualPointerSample = 0;
@@ -132,6 +187,11 @@ static uint32_t	actualPointerVPM = 0;
 static uint32_t	actualPointerSettings = SETTINGSSTART;
 static uint32_t	actualPointerFirmware = 0;
 static uint32_t	actualPointerFirmware2 = 0;
+static uint32_t	actualPointerJournal = JOURNALSTART;
+static uint16_t	journalNextEntry = JOURNAL_UNKNOWN;
+static uint8_t	journalLastState = 0;
+static uint8_t	readRestartPending = 0;	/* read wrapped at the ring end, the flash continues behind it */
+static uint8_t	headerIndexValid = 0;	/* cleared by every write to the header ring */
 
 /* Private function prototypes -----------------------------------------------*/
 static void chip_unselect(void);
@@ -146,10 +206,12 @@ static void ext_flash_set_to_begin_of_next_page(uint32_t *pointer, uint8_t type)
 #endif
 static void write_spi(uint8_t data, uint8_t unselect_CS_afterwards);
 static uint8_t read_spi(uint8_t unselect_CS_afterwards);
+static void read_spi_burst(uint8_t *pData, uint32_t length);
 static void write_address(uint8_t unselect_CS_afterwards);
 static void Error_Handler_extflash(void);
 static void wait_chip_not_busy(void);
 static void ext_flash_incf_address(uint8_t type);
+static void ext_flash_get_ring(uint8_t type, uint32_t *pRingStart, uint32_t *pRingStop);
 //void ext_flash_incf_address_ring(void);
 
 static void ext_flash_erase4kB(void);
@@ -166,9 +228,21 @@ static void ext_flash_read_block_stop(void);
 static void ef_hw_rough_delay_us(uint32_t delayUs);
 static void ef_erase_64K(uint32_t blocks);
 
+static _Bool ext_flash_sample_sector_erased(uint32_t address);
+static void ext_flash_sample_sector_mark(uint32_t address, _Bool erased);
+static void ext_flash_sample_sectors_written(uint32_t startAddress, uint32_t length);
+
 #ifndef BOOTLOADER_STANDALONE
+static uint8_t ext_flash_chip_busy(void);
 static void ext_flash_overwrite_sample_without_erase(uint8_t *pSample, uint16_t length);
 static void ext_flash_find_start(void);
+static uint16_t ext_flash_journal_checksum(const SLogJournalEntry *pEntry);
+static uint16_t ext_flash_journal_search(void);
+static void ext_flash_journal_write(uint8_t state, uint8_t id, uint32_t diveEnd, uint32_t nextSampleStart);
+static uint8_t ext_flash_journal_restore(void);
+static uint8_t ext_flash_header_index_build(void);
+static uint16_t ext_flash_sample_cache_checksum(const SSampleCachePage *pPage);
+static void ext_flash_sample_cache_program(SSampleCachePage *pPage);
 #endif
 
 
@@ -250,11 +324,7 @@ uint32_t ext_flash_read_firmware(uint8_t *pSample1, uint32_t max_length, uint8_t
 	}
 	else
 	{
-		for(uint32_t i = 0; i<lengthTransform.u32; i++)
-		{
-			ext_flash_read_block(&pSample1[i], EF_FIRMWARE);
-		}
-		
+		ext_flash_read_block_multi(pSample1, lengthTransform.u32, EF_FIRMWARE);
 	}
 	
 	ext_flash_read_block_stop();
@@ -330,25 +400,16 @@ uint32_t ext_flash_read_firmware2(uint32_t *offset, uint8_t *pSample1, uint32_t
 		
 		if(pSample1)
 		{
-			for(uint32_t i = 0; i<length1; i++)
-			{
-				ext_flash_read_block(&pSample1[i], EF_FIRMWARE2);
-			}
+			ext_flash_read_block_multi(pSample1, length1, EF_FIRMWARE2);
 			if(pSample2)
 			{
-				for(uint32_t i = 0; i<length2; i++)
-				{
-					ext_flash_read_block(&pSample2[i], EF_FIRMWARE2);
-				}
+				ext_flash_read_block_multi(pSample2, length2, EF_FIRMWARE2);
 			}
 		}
 		else if(pSample2)
 		{
 			actualAddress += length1;
-			for(uint32_t i = 0; i<length2; i++)
-			{
-				ext_flash_read_block(&pSample2[i], EF_FIRMWARE2);
-			}
+			ext_flash_read_block_multi(pSample2, length2, EF_FIRMWARE2);
 		}
 	}
 	ext_flash_read_block_stop();
@@ -510,8 +571,7 @@ int ext_flash_read_vpm(SVpm *vpmOutput)
 		&&(length_hi == (uint8_t)(length >> 8)))
 	{
 		pData = (uint8_t *)vpmOutput;
-		for(uint16_t i = 0; i < length; i++)
-			ext_flash_read_block(&pData[i], EF_VPMDATA);
+		ext_flash_read_block_multi(pData, length, EF_VPMDATA);
 		output = length;
 	}
 	else
@@ -599,8 +659,7 @@ uint8_t ext_flash_read_settings(void)
 				returnValue = HAL_OK;
 				pSettings->header = header;
 				pData = (uint8_t *)pSettings + 4; /* header */
-				for(uint16_t i = 0; i < (lengthOnEEPROM-4); i++)
-					ext_flash_read_block(&pData[i], EF_SETTINGS);
+				ext_flash_read_block_multi(pData, lengthOnEEPROM-4, EF_SETTINGS);
 				if(header != pSettings->header)				/* setting layout changed => no additional setting sets expected */
 				{
 					exit = 1;
@@ -621,8 +680,7 @@ uint8_t ext_flash_read_settings(void)
 				returnValue = HAL_OK;
 				pSettings->header = header;
 				pData = (uint8_t *)pSettings + 4; /* header */
-				for(uint16_t i = 0; i < (lengthStandardNow-4); i++) 		/* only read the data fitting into the structure */
-					ext_flash_read_block(&pData[i], EF_SETTINGS);
+				ext_flash_read_block_multi(pData, lengthStandardNow-4, EF_SETTINGS); 		/* only read the data fitting into the structure */
 			}
 			else
 			{
@@ -659,6 +717,8 @@ void ext_flash_start_new_dive_log_and_set_actualPointerSample(uint8_t *pHeaderPr
 	convert_Type data;
 	SSettings *settings = settingsGetPointer();
 
+	ext_flash_flush_sample_cache();		/* samples of a dive which did not reach divetimeToCreateLogbook */
+
 	/* new 5. Jan. 2015 */
 	actualPointerSample = settings->logFlashNextSampleStartAddress;
 
@@ -674,6 +734,7 @@ void ext_flash_start_new_dive_log_and_set_actualPointerSample(uint8_t *pHeaderPr
 	pHeaderPreDive[4] = data.u8bit.byteMidHigh;
 	/* to start sample writing and header etc. pp. */
 	ext_flash_disable_protection_for_logbook();
+	ext_flash_journal_write(JOURNAL_DIVE_OPEN, settings->lastDiveLogId, 0, actualPointerSample);
 }
 
 
@@ -691,6 +752,7 @@ void ext_flash_create_new_dive_log(uint8_t *pHeaderPreDive)
 	SSettings *settings;
 	uint8_t id;
 	uint8_t  header1, header2;
+	uint8_t indexInStep;
 
 	settings = settingsGetPointer();
 	id = settings->lastDiveLogId;
@@ -726,7 +788,18 @@ void ext_flash_create_new_dive_log(uint8_t *pHeaderPreDive)
 	actualPointerHeader = HEADERSTART + (0x800 * id);
 
 	if(pHeaderPreDive != 0)
+	{
+		indexInStep = headerIndexValid;
 		ef_write_block(pHeaderPreDive,HEADERSIZE, EF_HEADER, 0);
+
+		/* the pre-dive header is not part of the index, only the erase of a new 64k block changes it */
+		if(indexInStep)
+		{
+			if(((HEADERSTART + (0x800 * id)) & 0xFFFF) == 0)
+				memset(&headerIndex[id], 0xFF, HEADER_SLOTS_PER_64K * HEADERSIZE);
+			headerIndexValid = 1;
+		}
+	}
 }
 
 
@@ -737,12 +810,14 @@ void ext_flash_close_new_dive_log(uint8_t *pHeaderPostDive )
 	convert_Type startAddress;
 	convert_Type data;
 	uint32_t backup;
+	uint8_t indexInStep;
 
 	uint8_t	sampleData[3];
   actualAddress = actualPointerSample;
 	sampleData[0] = 0xFD;
 	sampleData[1] = 0xFD;
   ext_flash_write_sample(sampleData, 2);
+	ext_flash_flush_sample_cache();		/* the length is written to the start of the profile below */
 	
 	/* end of sample data, pointing to the last sample 0xFD
 	*/
@@ -777,7 +852,13 @@ void ext_flash_close_new_dive_log(uint8_t *pHeaderPostDive )
 	id = settings->lastDiveLogId;
 	actualPointerHeader = HEADERSTART + (0x800 * id) + HEADER2OFFSET;
 
+	indexInStep = headerIndexValid;
 	ef_write_block(pHeaderPostDive,HEADERSIZE, EF_HEADER, 0);
+	if(indexInStep)
+	{
+		memcpy(&headerIndex[id], pHeaderPostDive, HEADERSIZE);
+		headerIndexValid = 1;
+	}
 
 	/* write length at beginning of sample
 		and write proper beginning for next dive to actualPointerSample
@@ -792,34 +873,310 @@ void ext_flash_close_new_dive_log(uint8_t *pHeaderPostDive )
 	actualAddress = backup;
 	ext_flash_incf_address(EF_SAMPLE);
 	actualPointerSample = actualAddress;
+	ext_flash_journal_write(JOURNAL_DIVE_CLOSED, id, backup, actualPointerSample);
 	ext_flash_enable_protection();
 }
 
 
+/* Samples are collected in a RAM page and programmed once the flash page is full,
+ * by ext_flash_commit_sample_cache() from the main loop or here if the next page fills first.
+ * actualPointerSample and logFlashNextSampleStartAddress are the logical write position,
+ * including the bytes still held in the cache.
+ */
 void ext_flash_write_sample(uint8_t *pSample, uint16_t length)
 {
-	uint32_t actualAdressBackup = 0;
+	SSettings *settings = settingsGetPointer();
+	SSampleCachePage *pPage;
+	uint16_t space, chunk;
+	uint16_t index = 0;
 
-	ef_write_block(pSample,length, EF_SAMPLE, 0);
+	while(index < length)
+	{
+		pPage = &sampleCache[sampleCacheActive];
+		if((pPage->magic == SAMPLE_CACHE_MAGIC) && (pPage->address + pPage->length != actualPointerSample))	/* write position moved, e.g. a new dive */
+		{
+			ext_flash_sample_cache_program(pPage);
+			pPage->magic = 0;
+		}
+		if(pPage->magic != SAMPLE_CACHE_MAGIC)
+		{
+			pPage->address = actualPointerSample;
+			pPage->length = 0;
+			pPage->committed = 0;
+			pPage->magic = SAMPLE_CACHE_MAGIC;
+		}
+		space = SAMPLE_CACHE_PAGE - (pPage->address & (SAMPLE_CACHE_PAGE - 1)) - pPage->length;
+		chunk = length - index;
+		if(chunk > space)
+			chunk = space;
 
-	SSettings *settings = settingsGetPointer();
+		memcpy(&pPage->data[pPage->length], &pSample[index], chunk);
+		pPage->length += chunk;
+		pPage->checksum = ext_flash_sample_cache_checksum(pPage);
+		index += chunk;
+
+		actualPointerSample += chunk;		/* the ring end is page aligned, pages never wrap */
+		if(actualPointerSample > SAMPLESTOP)
+			actualPointerSample = SAMPLESTART;
+
+		if(chunk == space)					/* page is full, collect into the other one */
+		{
+			sampleCacheActive ^= 1;
+			if(sampleCache[sampleCacheActive].magic == SAMPLE_CACHE_MAGIC)	/* main loop did not commit it in time */
+			{
+				ext_flash_sample_cache_program(&sampleCache[sampleCacheActive]);
+			}
+		}
+	}
 	settings->logFlashNextSampleStartAddress = actualPointerSample;
+}
+
+static uint16_t ext_flash_sample_cache_checksum(const SSampleCachePage *pPage)
+{
+	uint16_t sum1 = (uint16_t)(pPage->address ^ (pPage->address >> 16));
+	uint16_t sum2 = pPage->length ^ (pPage->committed << 8);
 
-	if(0xFFFF - (actualAddress & 0x0000FFFF) < 255)								/* are we close to a sector border? */
+	for(uint16_t i = 0; i < pPage->length; i++)
 	{
-		if (((actualAddress & 0x0000FFFF) != 0) && (preparedPageAddress == 0))		/* only prepare if not already at start of sector */
+		sum1 = (sum1 + pPage->data[i]) % 255;
+		sum2 = (sum2 + sum1) % 255;
+	}
+	return (sum2 << 8) | sum1;
+}
+
+/* program the part of the page not yet in flash, a full page is released afterwards */
+static void ext_flash_sample_cache_program(SSampleCachePage *pPage)
+{
+	uint32_t logicalPointer = actualPointerSample;
+	uint32_t actualAdressBackup;
+
+	if(pPage->committed < pPage->length)
+	{
+		actualAddress = pPage->address + pPage->committed;
+		if(pPage->committed == 0)
+		{
+			ext_flash_erase_if_on_page_start();
+		}
+		actualPointerSample = actualAddress;
+		ef_write_block(&pPage->data[pPage->committed], pPage->length - pPage->committed, EF_SAMPLE, 1);
+		pPage->committed = pPage->length;
+
+		if((pPage->address & 0x0000FFFF) >= (0x10000 - SAMPLE_CACHE_PAGE))	/* last page of the sector: prepare the next one */
 		{
 			actualAdressBackup = actualAddress;
-			actualAddress = (actualAddress & 0xFFFF0000) + 0x00010000;	/* Set to start of next 64k sector */
+			actualAddress = (pPage->address & 0xFFFF0000) + 0x00010000;	/* Set to start of next 64k sector */
 			if(actualAddress >= SAMPLESTOP)
 			{
 				actualAddress = SAMPLESTART;
 			}
-			preparedPageAddress = actualAddress;
-			ext_flash_erase64kB();
+			if(!ext_flash_sample_sector_erased(actualAddress))		/* not done by ext_flash_preerase_samples() before the dive */
+			{
+				ext_flash_erase64kB();
+				ext_flash_sample_sector_mark(actualAddress, 1);
+			}
 			actualAddress = actualAdressBackup;
 		}
+		actualPointerSample = logicalPointer;
+	}
+
+	if((pPage->address & (SAMPLE_CACHE_PAGE - 1)) + pPage->length == SAMPLE_CACHE_PAGE)
+	{
+		pPage->magic = 0;
+	}
+	else
+	{
+		pPage->checksum = ext_flash_sample_cache_checksum(pPage);
+	}
+}
+
+/* low priority slot of the main loop: program a page filled since the last call */
+void ext_flash_commit_sample_cache(void)
+{
+	uint8_t pending = sampleCacheActive ^ 1;
+
+	if(sampleCache[pending].magic == SAMPLE_CACHE_MAGIC)
+	{
+		ext_flash_sample_cache_program(&sampleCache[pending]);
+	}
+}
+
+/* program everything collected so far, e.g. at the end of the dive or on low battery */
+void ext_flash_flush_sample_cache(void)
+{
+	ext_flash_commit_sample_cache();
+	if(sampleCache[sampleCacheActive].magic == SAMPLE_CACHE_MAGIC)
+	{
+		ext_flash_sample_cache_program(&sampleCache[sampleCacheActive]);
+	}
+}
+
+/* called once at startup, before the log repair: the cache is kept in a RAM section which is not
+ * initialized, so after a reset during a dive it still holds the samples not yet programmed.
+ * They are programmed if magic and checksum are intact and the flash behind them is still erased.
+ */
+void ext_flash_recover_sample_cache(void)
+{
+	SSampleCachePage *pPage;
+	uint8_t data;
+	uint8_t erased;
+
+	sampleCacheActive = 0;
+	for(int i = 0; i < 2; i++)
+	{
+		pPage = &sampleCache[i];
+		if((pPage->magic == SAMPLE_CACHE_MAGIC) && (pPage->checksum == ext_flash_sample_cache_checksum(pPage))
+			&& (pPage->address >= SAMPLESTART) && (pPage->address <= SAMPLESTOP)
+			&& ((pPage->address & (SAMPLE_CACHE_PAGE - 1)) + pPage->length <= SAMPLE_CACHE_PAGE)
+			&& (pPage->committed < pPage->length))
+		{
+			erased = 1;
+			actualAddress = pPage->address + pPage->committed;
+			ext_flash_read_block_start();
+			for(uint16_t j = pPage->committed; j < pPage->length; j++)
+			{
+				ext_flash_read_block(&data, EF_SAMPLE);
+				if(data != 0xFF)
+				{
+					erased = 0;
+				}
+			}
+			ext_flash_read_block_stop();
+
+			if(erased)
+			{
+				ext_flash_disable_protection_for_logbook();
+				actualPointerSample = pPage->address + pPage->committed;
+				ef_write_block(&pPage->data[pPage->committed], pPage->length - pPage->committed, EF_SAMPLE, 1);
+				ext_flash_enable_protection();
+			}
+		}
+		pPage->magic = 0;
+	}
+}
+
+/* Bytes of the sample ring ahead of nextSample which are not part of the profile of a dive still in the logbook.
+ * The dives are walked from the newest back as long as each profile ends where the newer one begins,
+ * i.e. up to the first profile already (partly) overwritten. 0 if the header index is not available.
+ */
+static uint32_t ext_flash_sample_free_ahead(uint32_t nextSample)
+{
+	const uint32_t ring = SAMPLESTOP + 1 - SAMPLESTART;
+	uint32_t freeAhead = ring;
+	uint32_t begin;
+	uint32_t end;
+	uint32_t distanceBegin;
+	uint32_t distanceEnd;
+	uint8_t id;
+
+	if(!ext_flash_header_index_build())
+		return 0;
+
+	id = settingsGetPointer()->lastDiveLogId;
+	for(int step = 0; step < HEADER_INDEX_SLOTS - 1; step++, id--)
+	{
+		if(headerIndex[id].diveHeaderStart != 0xFAFA)
+			break;
+
+		begin = headerIndex[id].pBeginProfileData[0] | (headerIndex[id].pBeginProfileData[1] << 8) | (headerIndex[id].pBeginProfileData[2] << 16);
+		end = headerIndex[id].pEndProfileData[0] | (headerIndex[id].pEndProfileData[1] << 8) | (headerIndex[id].pEndProfileData[2] << 16);
+		if((begin < SAMPLESTART) || (begin > SAMPLESTOP) || (end < SAMPLESTART) || (end > SAMPLESTOP))
+			break;
+
+		distanceBegin = (begin + ring - nextSample) % ring;
+		distanceEnd = (end + ring - nextSample) % ring;
+		if((distanceEnd < distanceBegin) || (distanceEnd >= freeAhead))	/* crosses the write position or a newer profile */
+			break;
+		freeAhead = distanceBegin;
+	}
+	return freeAhead;
+}
+
+/* Surface mode scheduler, called from the main loop: keeps the SAMPLE_PREERASE_SECTORS sectors behind
+ * the one of the next sample erased, so ef_write_block() does not have to erase during the dive.
+ * Each call does one step and returns at once while the flash is busy with an erase:
+ * a sector is verified SAMPLE_PREERASE_CHECK bytes at a time and erased only if it is not blank.
+ * There is no flash access at all once the sectors are known to be erased.
+ * Sectors still holding a profile of a dive in the logbook are left alone, the oldest dives are only
+ * overwritten when the next dive actually needs the space.
+ */
+void ext_flash_preerase_samples(void)
+{
+	static uint32_t checkAddress = 0;
+	static uint32_t freeAheadFor = 0xFFFFFFFF;		/* next sample address freeAhead was determined for */
+	static uint8_t freeAheadId = 0;
+	static uint32_t freeAhead = 0;
+	static uint8_t buffer[0x100];				/* not on the stack of the main loop */
+	uint32_t nextSample;
+	uint32_t sector;
+	uint32_t actualAddressBackup;
+	uint8_t blank = 1;
+	uint8_t index;
+
+	nextSample = settingsGetPointer()->logFlashNextSampleStartAddress;
+	if((nextSample < SAMPLESTART) || (nextSample > SAMPLESTOP))
+		nextSample = SAMPLESTART;
+	sector = nextSample & 0xFFFF0000;
+
+	for(index = 0; index < SAMPLE_PREERASE_SECTORS; index++)
+	{
+		sector += 0x10000;
+		if(sector > SAMPLESTOP)
+			sector = SAMPLESTART;
+		if(!ext_flash_sample_sector_erased(sector))
+			break;
+	}
+	if(index == SAMPLE_PREERASE_SECTORS)
+		return;
+
+	if((freeAheadFor != nextSample) || (freeAheadId != settingsGetPointer()->lastDiveLogId))
+	{
+		freeAhead = ext_flash_sample_free_ahead(nextSample);
+		freeAheadFor = nextSample;
+		freeAheadId = settingsGetPointer()->lastDiveLogId;
+	}
+	if((sector + SAMPLESTOP + 1 - SAMPLESTART - nextSample) % (SAMPLESTOP + 1 - SAMPLESTART) + 0xFFFF >= freeAhead)
+		return;
+
+	if(ext_flash_chip_busy())
+		return;
+
+	if((checkAddress & 0xFFFF0000) != sector)
+		checkAddress = sector;
+
+	actualAddressBackup = actualAddress;
+	actualAddress = checkAddress;
+	ext_flash_read_block_start();
+	for(uint16_t part = 0; (part < SAMPLE_PREERASE_CHECK / sizeof(buffer)) && blank; part++)
+	{
+		ext_flash_read_block_multi(buffer, sizeof(buffer), EF_SAMPLE);
+		for(uint16_t i = 0; i < sizeof(buffer); i++)
+		{
+			if(buffer[i] != 0xFF)
+			{
+				blank = 0;
+				break;
+			}
+		}
+	}
+	ext_flash_read_block_stop();
+
+	if(!blank)
+	{
+		actualAddress = sector;
+		ext_flash_erase64kB();
+		ext_flash_sample_sector_mark(sector, 1);
+		checkAddress = 0;
 	}
+	else
+	{
+		checkAddress += SAMPLE_PREERASE_CHECK;
+		if((checkAddress & 0xFFFF) == 0)		/* whole sector verified */
+		{
+			ext_flash_sample_sector_mark(sector, 1);
+			checkAddress = 0;
+		}
+	}
+	actualAddress = actualAddressBackup;
 }
 
 static void ext_flash_overwrite_sample_without_erase(uint8_t *pSample, uint16_t length)
@@ -828,20 +1185,88 @@ static void ext_flash_overwrite_sample_without_erase(uint8_t *pSample, uint16_t
 }
 
 
+/* The header index keeps the post-dive header of all 256 slots in an SDRAM area of its own
+ * behind the glyph atlas (GFX_getHeaderIndexMemory()), no frame of the pool is held for it.
+ * It is read once from flash on first use, so listing the logbook (menu, 0x61 and 0x6D download)
+ * does not read 256 headers from the flash each time. Creating and closing a dive keep it in step,
+ * any other write to the header ring drops it and the next reader builds it again.
+ */
+static uint8_t ext_flash_header_index_build(void)
+{
+	if(headerIndexValid)
+		return 1;
+
+	headerIndex = (SLogbookHeader *)GFX_getHeaderIndexMemory();
+
+	for(int id = 0; id < HEADER_INDEX_SLOTS; id++)
+	{
+		actualAddress = HEADERSTART + (0x800 * id) + HEADER2OFFSET;
+		ext_flash_read_block_start();
+		ext_flash_read_block_multi(&headerIndex[id], HEADERSIZE, EF_HEADER);
+		ext_flash_read_block_stop();
+	}
+	headerIndexValid = 1;
+	return 1;
+}
+
+
+/* Spot check of the header index, not a full comparison: only the newest slot, the slot used next
+ * and one further slot in turn (all 256 after 256 calls) are compared with the flash, the index is
+ * dropped if one of them differs. A change of any other slot is found when the turn reaches it;
+ * the header writes of this firmware keep the index in step or drop it themselves.
+ * Returns 0 if the index had to be dropped
+ */
+uint8_t ext_flash_header_index_spot_check(void)
+{
+	static SLogbookHeader flashHeader;
+	uint8_t slot[3];
+
+	if(!headerIndexValid)
+		return 1;
+
+	slot[0] = settingsGetPointer()->lastDiveLogId;
+	slot[1] = slot[0] + 1;
+	slot[2] = headerIndexCheckId++;
+
+	for(int i = 0; i < 3; i++)
+	{
+		actualAddress = HEADERSTART + (0x800 * slot[i]) + HEADER2OFFSET;
+		ext_flash_read_block_start();
+		ext_flash_read_block_multi(&flashHeader, HEADERSIZE, EF_HEADER);
+		ext_flash_read_block_stop();
+		if(memcmp(&flashHeader, &headerIndex[slot[i]], HEADERSIZE) != 0)
+		{
+			headerIndexValid = 0;
+			return 0;
+		}
+	}
+	return 1;
+}
+
+
 uint8_t ext_flash_count_dive_headers(void)
 {
 	uint8_t id = 0;
 	uint8_t counter = 0;
 	uint16_t headerStartData = 0x0000;
+	uint8_t useIndex;
 	
 	id = settingsGetPointer()->lastDiveLogId;
+	useIndex = ext_flash_header_index_build();
 
 	do
 	{
-		actualAddress = HEADERSTART + (0x800 * id) + HEADER2OFFSET;
-		ext_flash_read_block_start();
-		ext_flash_read_block_multi((uint8_t *)&headerStartData, 2, EF_HEADER);
-		ext_flash_read_block_stop();
+		if(useIndex)
+		{
+			headerStartData = headerIndex[id].diveHeaderStart;
+		}
+		else
+		{
+			actualAddress = HEADERSTART + (0x800 * id) + HEADER2OFFSET;
+			ext_flash_read_block_start();
+			ext_flash_read_block_multi((uint8_t *)&headerStartData, 2, EF_HEADER);
+			ext_flash_read_block_stop();
+		}
 		counter++;
 		id -=1;
 	} while((headerStartData == 0xFAFA) && (counter < 255));
@@ -849,35 +1274,61 @@ uint8_t ext_flash_count_dive_headers(void)
 }
 
 
+/* number of the newest dives with a dive number above diveNumber, counted back from the last dive
+ * until the first older or empty header. Uses the header index like ext_flash_count_dive_headers()
+ */
+uint8_t ext_flash_count_dives_since(uint16_t diveNumber)
+{
+	static SLogbookHeader header;
+	uint8_t counter = 0;
+
+	while(counter < 255)
+	{
+		ext_flash_read_dive_header((uint8_t *)&header, counter);
+		if((header.diveHeaderStart != 0xFAFA) || (header.diveNumber <= diveNumber))
+			break;
+		counter++;
+	}
+	return counter;
+}
+
+
 void ext_flash_read_dive_header(uint8_t *pHeaderToFill, uint8_t StepBackwards)
 {
 	SSettings *settings;
 	uint8_t id;
-	uint16_t i;
 
 	settings = settingsGetPointer();
 	id = settings->lastDiveLogId;
 	id -= StepBackwards; /* 0-255, auto rollover */
 
+	if(ext_flash_header_index_build())
+	{
+		memcpy(pHeaderToFill, &headerIndex[id], HEADERSIZE);
+		return;
+	}
+
 	actualAddress = HEADERSTART + (0x800 * id) + HEADER2OFFSET;
 	ext_flash_read_block_start();
-	for(i = 0; i < HEADERSIZE; i++)
-		ext_flash_read_block(&pHeaderToFill[i], EF_HEADER);
+	ext_flash_read_block_multi(pHeaderToFill, HEADERSIZE, EF_HEADER);
 	ext_flash_read_block_stop();
 
 }
 
 void ext_flash_read_dive_header2(uint8_t *pHeaderToFill, uint8_t id, _Bool bOffset)
 {
+	if(bOffset && ext_flash_header_index_build())
+	{
+		memcpy(pHeaderToFill, &headerIndex[id], HEADERSIZE);
+		return;
+	}
 
-	uint16_t i;
 	actualAddress = HEADERSTART + (0x800 * id) ;
 
 	if(bOffset)
 	  actualAddress += HEADER2OFFSET;
 	ext_flash_read_block_start();
-	for(i = 0; i < HEADERSIZE; i++)
-		ext_flash_read_block(&pHeaderToFill[i], EF_HEADER);
+	ext_flash_read_block_multi(pHeaderToFill, HEADERSIZE, EF_HEADER);
 	ext_flash_read_block_stop();
 }
 
@@ -901,15 +1352,13 @@ uint32_t ext_flash_read_dive_raw_with_double_header_1K(uint8_t *data, uint32_t m
 	// copy primary/pre-dive
 	actualAddress = HEADERSTART + (0x800 * id);
 	ext_flash_read_block_start();
-	for(int i = 0; i < HEADERSIZE; i++)
-		ext_flash_read_block(&data[i], EF_HEADER);
+	ext_flash_read_block_multi(data, HEADERSIZE, EF_HEADER);
 	ext_flash_read_block_stop();
 
 	// copy main/secondary/post-dive
 	actualAddress = HEADERSTART + (0x800 * id) + HEADER2OFFSET;
 	ext_flash_read_block_start();
-	for(int i = 0x400; i < HEADERSIZE+0x400; i++)
-		ext_flash_read_block(&data[i], EF_HEADER);
+	ext_flash_read_block_multi(&data[0x400], HEADERSIZE, EF_HEADER);
 	ext_flash_read_block_stop();
 	
 	// data
@@ -937,8 +1386,7 @@ uint32_t ext_flash_read_dive_raw_with_double_header_1K(uint8_t *data, uint32_t m
 
 	actualAddress = actualPointerSample;
 	ext_flash_read_block_start();
-	for(uint32_t i = 0x800; i < LengthAll; i++)
-		ext_flash_read_block(&data[i], EF_SAMPLE);
+	ext_flash_read_block_multi(&data[0x800], LengthAll - 0x800, EF_SAMPLE);
 	ext_flash_read_block_stop();
 	return LengthAll;
 }
@@ -1008,6 +1456,7 @@ void ext_flash_read_header_memory(uint8_t *data)
 //  ===============================================================================
 void ext_flash_write_header_memory(uint8_t *data)
 {
+	ext_flash_journal_write(JOURNAL_DIVE_OPEN, 0, 0, 0);
 	actualAddress = HEADERSTART;
 	actualPointerHeader = actualAddress;
 	ef_write_block(data, 0x40000, EF_HEADER, 0);
@@ -1025,6 +1474,7 @@ void ext_flash_read_sample_memory(uint8_t *data,uint16_t blockId)
 
 void ext_flash_write_sample_memory(uint8_t *data,uint16_t blockId)
 {
+	ext_flash_journal_write(JOURNAL_DIVE_OPEN, 0, 0, 0);
 	actualAddress = SAMPLESTART;
 	actualAddress += blockId * 0x8000;	/* add 32k Block offset */
 	actualPointerSample = actualAddress;
@@ -1071,10 +1521,9 @@ void ext_flash_open_read_sample(uint8_t StepBackwards, uint32_t *totalNumberOfBy
 }
 
 
-void ext_flash_read_next_sample_part(uint8_t *pSample, uint8_t length)
+void ext_flash_read_next_sample_part(uint8_t *pSample, uint16_t length)
 {
-	for(uint16_t i = 0; i < length; i++)
-		ext_flash_read_block(&pSample[i], EF_SAMPLE);
+	ext_flash_read_block_multi(pSample, length, EF_SAMPLE);
 }
 
 
@@ -1270,15 +1719,13 @@ void OLD_ext_flash_repair_SPECIAL_dive_numbers_starting_count_with(uint16_t star
 			// copy primary/pre-dive
 			actualAddress = HEADERSTART + (0x800 * id);
 			ext_flash_read_block_start();
-			for(int i = 0; i < HEADERSIZE; i++)
-				ext_flash_read_block(&data[i], EF_HEADER);
+			ext_flash_read_block_multi(data, HEADERSIZE, EF_HEADER);
 			ext_flash_read_block_stop();
 
 			// copy main/secondary/post-dive
 			actualAddress = HEADERSTART + (0x800 * id) + HEADER2OFFSET;
 			ext_flash_read_block_start();
-			for(int i = 0x400; i < HEADERSIZE+0x400; i++)
-				ext_flash_read_block(&data[i], EF_HEADER);
+			ext_flash_read_block_multi(&data[0x400], HEADERSIZE, EF_HEADER);
 			ext_flash_read_block_stop();
 			
 			// repair
@@ -1310,15 +1757,13 @@ void OLD_ext_flash_repair_SPECIAL_dive_numbers_starting_count_with(uint16_t star
 			// copy second pre-dive
 			actualAddress = HEADERSTART + (0x800 * startAbsolute);
 			ext_flash_read_block_start();
-			for(int i = 0x800; i < HEADERSIZE+0x800; i++)
-				ext_flash_read_block(&data[i], EF_HEADER);
+			ext_flash_read_block_multi(&data[0x800], HEADERSIZE, EF_HEADER);
 			ext_flash_read_block_stop();
 
 			// copy second post-dive
 			actualAddress = HEADERSTART + HEADER2OFFSET + (0x800 * startAbsolute);
 			ext_flash_read_block_start();
-			for(int i = 0xC00; i < HEADERSIZE+0xC00; i++)
-				ext_flash_read_block(&data[i], EF_HEADER);
+			ext_flash_read_block_multi(&data[0xC00], HEADERSIZE, EF_HEADER);
 			ext_flash_read_block_stop();
 
 			if(counterStorage[count] != startCount)
@@ -1337,15 +1782,13 @@ void OLD_ext_flash_repair_SPECIAL_dive_numbers_starting_count_with(uint16_t star
 				// copy  first pre-dive
 				actualAddress = HEADERSTART + (0x800 * startAbsolute);
 				ext_flash_read_block_start();
-				for(int i = 0; i < HEADERSIZE; i++)
-					ext_flash_read_block(&data[i], EF_HEADER);
+				ext_flash_read_block_multi(data, HEADERSIZE, EF_HEADER);
 				ext_flash_read_block_stop();
 
 				// copy first post-dive
 				actualAddress = HEADERSTART + (0x800 * startAbsolute);
 				ext_flash_read_block_start();
-				for(int i = 0x400; i < HEADERSIZE+0x400; i++)
-					ext_flash_read_block(&data[i], EF_HEADER);
+				ext_flash_read_block_multi(&data[0x400], HEADERSIZE, EF_HEADER);
 				ext_flash_read_block_stop();
 
 				if(counterStorage[count] != startCount)
@@ -1365,15 +1808,13 @@ void OLD_ext_flash_repair_SPECIAL_dive_numbers_starting_count_with(uint16_t star
 			// copy  first pre-dive
 			actualAddress = HEADERSTART + (0x800 * startAbsolute);
 			ext_flash_read_block_start();
-			for(int i = 0; i < HEADERSIZE; i++)
-				ext_flash_read_block(&data[i], EF_HEADER);
+			ext_flash_read_block_multi(data, HEADERSIZE, EF_HEADER);
 			ext_flash_read_block_stop();
 
 			// copy first post-dive
 			actualAddress = HEADERSTART + (0x800 * startAbsolute);
 			ext_flash_read_block_start();
-			for(int i = 0x400; i < HEADERSIZE+0x400; i++)
-				ext_flash_read_block(&data[i], EF_HEADER);
+			ext_flash_read_block_multi(&data[0x400], HEADERSIZE, EF_HEADER);
 			ext_flash_read_block_stop();
 
 			if(counterStorage[count] != startCount)
@@ -1495,7 +1936,10 @@ void ext_flash_repair_dive_log(void)
       }
     }
   }
-  ext_flash_find_start();
+  if(!ext_flash_journal_restore())	/* newest journal entry is a closed dive and the ring ends are confirmed by the flash */
+  {
+    ext_flash_find_start();
+  }
 }
 
 
@@ -1578,6 +2022,7 @@ static void ext_flash_find_start(void)
     // Set new start address
     actualPointerSample = actualAddress;
     settings->logFlashNextSampleStartAddress = actualPointerSample;
+    ext_flash_journal_write(JOURNAL_DIVE_CLOSED, id, dataEnd.u32bit, actualPointerSample);	/* next startup takes the short way */
   }
   else
   {
@@ -1588,6 +2033,146 @@ static void ext_flash_find_start(void)
 
 
 
+/* The pointer journal keeps the ring ends of the logbook, so the startup does not have to search them
+ * header by header and byte by byte. Entries are appended to the journal sector, the first free entry
+ * is found by a binary search. The newest entry is only trusted if it belongs to a closed dive and
+ * the header and the sample ring still look like it says, otherwise the full search runs.
+ */
+static uint16_t ext_flash_journal_checksum(const SLogJournalEntry *pEntry)
+{
+	const uint8_t *pData = (const uint8_t *)pEntry;
+	uint16_t sum1 = 0;
+	uint16_t sum2 = 0;
+
+	for(uint8_t i = 0; i < offsetof(SLogJournalEntry, checksum); i++)
+	{
+		sum1 = (sum1 + pData[i]) % 255;
+		sum2 = (sum2 + sum1) % 255;
+	}
+	return (sum2 << 8) | sum1;
+}
+
+static uint16_t ext_flash_journal_search(void)
+{
+	uint16_t low = 0;
+	uint16_t high = JOURNAL_ENTRIES;
+	uint16_t middle;
+	uint16_t magic;
+
+	while(low < high)
+	{
+		middle = (low + high) / 2;
+		actualAddress = JOURNALSTART + (middle * sizeof(SLogJournalEntry));
+		ext_flash_read_block_start();
+		ext_flash_read_block_multi(&magic, 2, EF_JOURNAL);
+		ext_flash_read_block_stop();
+		if(magic == 0xFFFF)
+			high = middle;
+		else
+			low = middle + 1;
+	}
+	return low;
+}
+
+static void ext_flash_journal_write(uint8_t state, uint8_t id, uint32_t diveEnd, uint32_t nextSampleStart)
+{
+	SLogJournalEntry entry;
+
+	if(journalNextEntry == JOURNAL_UNKNOWN)
+		journalNextEntry = ext_flash_journal_search();
+
+	if((state == JOURNAL_DIVE_OPEN) && (journalLastState == JOURNAL_DIVE_OPEN))	/* already invalid, e.g. during a memory upload */
+		return;
+
+	if(journalNextEntry >= JOURNAL_ENTRIES)
+	{
+		actualAddress = JOURNALSTART;
+		ef_erase_64K(1);
+		journalNextEntry = 0;
+	}
+
+	entry.magic = JOURNAL_MAGIC;
+	entry.state = state;
+	entry.lastDiveLogId = id;
+	entry.diveEnd = diveEnd;
+	entry.nextSampleStart = nextSampleStart;
+	entry.reserved = 0xFFFF;
+	entry.checksum = ext_flash_journal_checksum(&entry);
+
+	actualPointerJournal = JOURNALSTART + (journalNextEntry * sizeof(SLogJournalEntry));
+	ef_write_block((uint8_t *)&entry, sizeof(SLogJournalEntry), EF_JOURNAL, 1);
+	journalNextEntry++;
+	journalLastState = state;
+}
+
+static uint8_t ext_flash_journal_restore(void)
+{
+	SLogJournalEntry entry;
+	SSettings *settings = settingsGetPointer();
+	uint8_t headerStart[2];
+	uint8_t headerEnd[8];
+	uint8_t sampleEnd[10];
+	convert_Type dataEnd;
+
+	journalNextEntry = ext_flash_journal_search();
+	if(journalNextEntry == 0)
+		return 0;
+
+	actualAddress = JOURNALSTART + ((journalNextEntry - 1) * sizeof(SLogJournalEntry));
+	ext_flash_read_block_start();
+	ext_flash_read_block_multi(&entry, sizeof(SLogJournalEntry), EF_JOURNAL);
+	ext_flash_read_block_stop();
+	journalLastState = entry.state;
+
+	if(entry.magic != JOURNAL_MAGIC)		/* sector not written by the journal, erase it with the next entry */
+	{
+		journalNextEntry = JOURNAL_ENTRIES;
+		return 0;
+	}
+	if((entry.checksum != ext_flash_journal_checksum(&entry)) || (entry.reserved != 0xFFFF)
+		|| (entry.state != JOURNAL_DIVE_CLOSED)
+		|| (entry.nextSampleStart < SAMPLESTART) || (entry.nextSampleStart > SAMPLESTOP))
+		return 0;
+
+	/* pre-dive and post-dive header of the dive and the blank space behind its samples */
+	actualAddress = HEADERSTART + (0x800 * entry.lastDiveLogId);
+	ext_flash_read_block_start();
+	ext_flash_read_block_multi(headerStart, 2, EF_HEADER);
+	ext_flash_read_block_stop();
+
+	actualAddress = HEADERSTART + (0x800 * entry.lastDiveLogId) + HEADER2OFFSET;
+	ext_flash_read_block_start();
+	ext_flash_read_block_multi(headerEnd, 8, EF_HEADER);
+	ext_flash_read_block_stop();
+
+	actualAddress = entry.nextSampleStart;
+	ext_flash_read_block_start();
+	ext_flash_read_block_multi(sampleEnd, 10, EF_SAMPLE);
+	ext_flash_read_block_stop();
+
+	dataEnd.u8bit.byteLow = headerEnd[5];
+	dataEnd.u8bit.byteMidLow = headerEnd[6];
+	dataEnd.u8bit.byteMidHigh = headerEnd[7];
+	dataEnd.u8bit.byteHigh = 0;
+
+	if((headerStart[0] != 0xFA) || (headerStart[1] != 0xFA) || (headerEnd[0] != 0xFA) || (headerEnd[1] != 0xFA)
+		|| (dataEnd.u32bit != entry.diveEnd))
+		return 0;
+
+	for(uint8_t i = 0; i < sizeof(sampleEnd); i++)
+	{
+		if(sampleEnd[i] != 0xFF)
+			return 0;
+	}
+
+	settings->lastDiveLogId = entry.lastDiveLogId;
+	actualPointerHeader = HEADERSTART + (0x800 * entry.lastDiveLogId) + HEADER2OFFSET;
+	actualPointerSample = entry.nextSampleStart;
+	settings->logFlashNextSampleStartAddress = actualPointerSample;
+	return 1;
+}
+
+
 static void ext_flash_disable_protection(void)
 {
 /*	
@@ -1687,6 +2272,17 @@ void ext_flash_erase_logbook(void)
 	blocks_64k = size / 0x10000;
 	ef_erase_64K(blocks_64k);
 
+	actualAddress = JOURNALSTART;
+	ef_erase_64K(1);
+	journalNextEntry = 0;
+	journalLastState = 0;
+	headerIndexValid = 0;
+	memset(sampleSectorErased, 0xFF, sizeof(sampleSectorErased));
+#ifndef BOOTLOADER_STANDALONE
+	sampleCache[0].magic = 0;
+	sampleCache[1].magic = 0;
+#endif
+
 	ext_flash_enable_protection();
 }
 
@@ -1730,6 +2326,7 @@ void ext_flash_read_block_start(void)
 	wait_chip_not_busy();
 	write_spi(0x03,HOLDCS);		/* WREN */
 	write_address(HOLDCS);
+	readRestartPending = 0;
 }
 
 /* 4KB, 32KB, 64 KB, not the upper 16 MB with 4 Byte address at the moment */
@@ -1759,12 +2356,7 @@ static uint8_t ext_flash_erase_if_on_page_start(void)
 		/* 64K Byte is 0x10000 */
 		if((actualAddress & 0xFFFF) == 0)
 		{
-			if(preparedPageAddress == actualAddress)	/* has page already been prepared before? (at the moment for samples only) */
-			{
-				preparedPageAddress = 0;
-
-			}
-			else
+			if(!ext_flash_sample_sector_erased(actualAddress))	/* has page already been prepared before? (samples only) */
 			{
 				ext_flash_erase64kB();
 			}
@@ -1778,20 +2370,51 @@ static uint8_t ext_flash_erase_if_on_page_start(void)
 
 static void ext_flash_read_block(uint8_t *getByte, uint8_t type)
 {
-	*getByte = read_spi(HOLDCS);/* read data */
-	ext_flash_incf_address(type);
+	ext_flash_read_block_multi(getByte, 1, type);
 }
 
 
+/* reads in bursts up to the end of the ring, a new read command continues at the ring start */
 static void ext_flash_read_block_multi(void *getByte, uint32_t size, uint8_t type)
 {
 	uint8_t  *data;
+	uint32_t ringStart, ringStop;
+	uint32_t run;
+
 	data = getByte;
+	ext_flash_get_ring(type, &ringStart, &ringStop);
 
-	for(uint32_t i=0;i<size;i++)
+	if((actualAddress < ringStart) || (actualAddress > ringStop))
 	{
-		data[i] = read_spi(HOLDCS);/* read data */
-		ext_flash_incf_address(type);
+		/* outside of the ring: the flash keeps reading linear, only the address moves into the ring (see ext_flash_incf_address()) */
+		if(size)
+		{
+			read_spi_burst(data, size);
+			actualAddress = ringStart + ((size - 1) % (ringStop - ringStart + 1));
+		}
+		return;
+	}
+
+	while(size)
+	{
+		if(readRestartPending)
+		{
+			ext_flash_read_block_start();
+		}
+		run = ringStop - actualAddress + 1;
+		if(run > size)
+			run = size;
+
+		read_spi_burst(data, run);
+		data += run;
+		size -= run;
+		actualAddress += run;
+
+		if(actualAddress > ringStop)
+		{
+			actualAddress = ringStart;
+			readRestartPending = 1;
+		}
 	}
 }
 
@@ -1808,6 +2431,7 @@ static void ef_write_block(uint8_t * sendByte, uint32_t length, uint8_t type, ui
 {
 	uint32_t remaining_page_size, remaining_length, remaining_space_to_ring_end;
 	uint32_t i=0;
+	uint32_t startAddress;
 
 	if(!length)
 		return;
@@ -1820,6 +2444,7 @@ static void ef_write_block(uint8_t * sendByte, uint32_t length, uint8_t type, ui
 			actualAddress = actualPointerHeader;
 			ringStart = HEADERSTART;
 			ringStop = HEADERSTOP;
+			headerIndexValid = 0;
 			break;
 		case EF_SAMPLE:
 			actualAddress = actualPointerSample;
@@ -1851,6 +2476,11 @@ static void ef_write_block(uint8_t * sendByte, uint32_t length, uint8_t type, ui
 			ringStart = FWSTART2;
 			ringStop = FWSTOP2;
 			break;
+		case EF_JOURNAL:
+			actualAddress = actualPointerJournal;
+			ringStart = JOURNALSTART;
+			ringStop = JOURNALSTOP;
+			break;
 		default:
 			ringStart = FLASHSTART;
 			ringStop = FLASHSTOP;
@@ -1859,6 +2489,7 @@ static void ef_write_block(uint8_t * sendByte, uint32_t length, uint8_t type, ui
 	/* safety */
 	if(actualAddress < ringStart)
 		actualAddress = ringStart;
+	startAddress = actualAddress;
 
 	if(do_not_erase == 0)
 	{
@@ -1916,6 +2547,7 @@ static void ef_write_block(uint8_t * sendByte, uint32_t length, uint8_t type, ui
 			break;
 		case EF_SAMPLE:
 			actualPointerSample = actualAddress;
+			ext_flash_sample_sectors_written(startAddress, length);
 			break;
 		case EF_DEVICEDATA:
 			actualPointerDevicedata = actualAddress;
@@ -1932,6 +2564,9 @@ static void ef_write_block(uint8_t * sendByte, uint32_t length, uint8_t type, ui
 		case EF_FIRMWARE2:
 			actualPointerFirmware2 = actualAddress;
 			break;
+		case EF_JOURNAL:
+			actualPointerJournal = actualAddress;
+			break;
 		default:
 			break;
 	}
@@ -2063,6 +2698,27 @@ static uint8_t read_spi(uint8_t unselect_CS_afterwards)
 }
 
 
+static void read_spi_burst(uint8_t *pData, uint32_t length)
+{
+	uint16_t chunk;
+
+	chip_select();
+
+	while(length)
+	{
+		chunk = (length > READ_BURST_MAX) ? READ_BURST_MAX : length;
+		if(HAL_SPI_Receive(&hspiDisplay, pData, chunk, 10000) != HAL_OK)
+			Error_Handler_extflash();
+
+		while (HAL_SPI_GetState(&hspiDisplay) != HAL_SPI_STATE_READY)
+	  {
+	  }
+		pData += chunk;
+		length -= chunk;
+	}
+}
+
+
 static void write_spi(uint8_t data, uint8_t unselect_CS_afterwards)
 {
 	chip_select();
@@ -2108,48 +2764,114 @@ static void wait_chip_not_busy(void)
 	chip_unselect();
 }
 
+#ifndef BOOTLOADER_STANDALONE
+static uint8_t ext_flash_chip_busy(void)
+{
+	uint8_t status;
 
-static void ext_flash_incf_address(uint8_t type)
+	chip_unselect();
+	write_spi(0x05,HOLDCS);		/* RDSR */
+	status = read_spi(HOLDCS);/* read status */
+	chip_unselect();
+	return status & 0x01;
+}
+#endif
+
+static _Bool ext_flash_sample_sector_erased(uint32_t address)
+{
+	uint32_t sector;
+
+	if((address < SAMPLESTART) || (address > SAMPLESTOP))
+		return 0;
+
+	sector = (address - SAMPLESTART) >> 16;
+	return (sampleSectorErased[sector / 8] >> (sector % 8)) & 0x01;
+}
+
+static void ext_flash_sample_sector_mark(uint32_t address, _Bool erased)
+{
+	uint32_t sector;
+
+	if((address < SAMPLESTART) || (address > SAMPLESTOP))
+		return;
+
+	sector = (address - SAMPLESTART) >> 16;
+	if(erased)
+		sampleSectorErased[sector / 8] |= (1 << (sector % 8));
+	else
+		sampleSectorErased[sector / 8] &= ~(1 << (sector % 8));
+}
+
+/* clears the erased flag of every sector a sample write of length bytes went through, wrapping at the ring end */
+static void ext_flash_sample_sectors_written(uint32_t startAddress, uint32_t length)
+{
+	uint32_t sector = startAddress & 0xFFFF0000;
+	uint32_t count = ((startAddress & 0xFFFF) + length + 0xFFFF) >> 16;
+
+	if(count > SAMPLE_SECTOR_COUNT)
+		count = SAMPLE_SECTOR_COUNT;
+
+	while(count--)
+	{
+		ext_flash_sample_sector_mark(sector, 0);
+		sector += 0x10000;
+		if(sector > SAMPLESTOP)
+			sector = SAMPLESTART;
+	}
+}
+
+
+static void ext_flash_get_ring(uint8_t type, uint32_t *pRingStart, uint32_t *pRingStop)
 {
-	uint32_t ringStart, ringStop;
-	
-	actualAddress += 1;
-	
 	switch(type)
 	{
 		case EF_HEADER:
-			ringStart = HEADERSTART;
-			ringStop = HEADERSTOP;
+			*pRingStart = HEADERSTART;
+			*pRingStop = HEADERSTOP;
 			break;
 		case EF_SAMPLE:
-			ringStart = SAMPLESTART;
-			ringStop = SAMPLESTOP;
+			*pRingStart = SAMPLESTART;
+			*pRingStop = SAMPLESTOP;
 			break;
 		case EF_DEVICEDATA:
-			ringStart = DDSTART;
-			ringStop = DDSTOP;
+			*pRingStart = DDSTART;
+			*pRingStop = DDSTOP;
 			break;
 		case EF_VPMDATA:
-			ringStart = VPMSTART;
-			ringStop = VPMSTOP;
+			*pRingStart = VPMSTART;
+			*pRingStop = VPMSTOP;
 			break;
 		case EF_SETTINGS:
-			ringStart = SETTINGSSTART;
-			ringStop = SETTINGSSTOP;
+			*pRingStart = SETTINGSSTART;
+			*pRingStop = SETTINGSSTOP;
 			break;
 		case EF_FIRMWARE:
-			ringStart = FWSTART;
-			ringStop = FWSTOP;
+			*pRingStart = FWSTART;
+			*pRingStop = FWSTOP;
 			break;
 		case EF_FIRMWARE2:
-			ringStart = FWSTART2;
-			ringStop = FWSTOP2;
+			*pRingStart = FWSTART2;
+			*pRingStop = FWSTOP2;
+			break;
+		case EF_JOURNAL:
+			*pRingStart = JOURNALSTART;
+			*pRingStop = JOURNALSTOP;
 			break;
 		default:
-			ringStart = FLASHSTART;
-			ringStop = FLASHSTOP;
+			*pRingStart = FLASHSTART;
+			*pRingStop = FLASHSTOP;
 			break;
 	}
+}
+
+
+static void ext_flash_incf_address(uint8_t type)
+{
+	uint32_t ringStart, ringStop;
+	
+	actualAddress += 1;
+	
+	ext_flash_get_ring(type, &ringStart, &ringStop);
 	
 	if((actualAddress < ringStart) || (actualAddress > ringStop))
 		actualAddress = ringStart;
@@ -2160,41 +2882,7 @@ static void ext_flash_decf_address_ring(uint8_t type)
 {
 	uint32_t ringStart, ringStop;
 	
-	switch(type)
-	{
-		case EF_HEADER:
-			ringStart = HEADERSTART;
-			ringStop = HEADERSTOP;
-			break;
-		case EF_SAMPLE:
-			ringStart = SAMPLESTART;
-			ringStop = SAMPLESTOP;
-			break;
-		case EF_DEVICEDATA:
-			ringStart = DDSTART;
-			ringStop = DDSTOP;
-			break;
-		case EF_VPMDATA:
-			ringStart = VPMSTART;
-			ringStop = VPMSTOP;
-			break;
-		case EF_SETTINGS:
-			ringStart = SETTINGSSTART;
-			ringStop = SETTINGSSTOP;
-			break;
-		case EF_FIRMWARE:
-			ringStart = FWSTART;
-			ringStop = FWSTOP;
-			break;
-		case EF_FIRMWARE2:
-			ringStart = FWSTART2;
-			ringStop = FWSTOP2;
-			break;
-		default:
-			ringStart = FLASHSTART;
-			ringStop = FLASHSTOP;
-			break;
-	}
+	ext_flash_get_ring(type, &ringStart, &ringStop);
 	
 	if((actualAddress <= ringStart) || (actualAddress > ringStop))
 		actualAddress = ringStop;
@@ -2228,6 +2916,7 @@ void ext_flash_CloseSector(void)
 	{
 	/* write some dummy bytes to the sector which is currently used for storing samples. This is done to "hide" problem if function is calles again */
 		actualAddress = closeSectorAddress;
+		ext_flash_sample_sector_mark(closeSectorAddress, 0);
 
 		wait_chip_not_busy();
 		write_spi(0x06,RELEASE);		/* WREN */
@@ -21,6 +21,7 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "stm32f4xx_hal.h"
 
@@ -89,6 +90,7 @@ typedef struct
 	uint32_t 	StartAddress;
 	int8_t 		status;
 	uint8_t		caller;
+	uint8_t		next;			/* following frame in cleanFrames or releasedFrames */
 } SFrameList;
 
 enum FRAMESTATE
@@ -98,6 +100,13 @@ enum FRAMESTATE
 	RELEASED
 };
 
+typedef struct
+{
+	uint8_t first;
+	uint8_t last;
+	uint8_t count;
+} SFrameQueue;
+
 enum LOGOSTATE
 {
 	LOGOOFF = 0,
@@ -105,6 +114,48 @@ enum LOGOSTATE
 	LOGOSTOP = 255
 };
 
+typedef struct
+{
+	const tFont *font;
+	uint8_t	glyph[256];		/* position of the character in font->chars, GLYPH_NONE if the font does not have it */
+} SGlyphIndex;
+
+#define GLYPH_INDEX_FONTS	(16u)		/* fonts and extra fonts in use, each gets its index on first use */
+#define GLYPH_NONE			(0xFFu)
+
+typedef struct
+{
+	const tFont *font;
+	GFX_DrawCfgWindow window;	/* copy, the caller may reuse its window struct before the replay */
+	uint16_t textStart;			/* offset of the string in retainedText */
+	uint8_t windowIndex;
+	uint8_t line;
+	uint8_t color;
+} SRetainedCommand;
+
+#define RETAINED_WINDOWS	(8u)
+#define RETAINED_COMMANDS	(32u)
+#define RETAINED_TEXT_POOL	(768u)
+#define RETAINED_HASH_NONE	(0u)		/* window has to be rendered in any case */
+
+#define DMA2D_BLOCKING		(254u)		/* DMA2D_at_work while a blocking transfer is running */
+
+#define FRAME_NONE			(0xFFu)
+#define FRAME_CALLERS		(256u)		/* callerId is an uint8_t */
+
+typedef struct
+{
+	const tChar *glyph;
+	uint32_t address;			/* decoded AL88 pixels in the atlas, column by column like the frames */
+	uint8_t color;
+	uint8_t variant;			/* GLYPH_ATLAS_INVERT, GLYPH_ATLAS_FLIP */
+} SGlyphAtlasEntry;
+
+#define GLYPH_ATLAS_ENTRIES		(64u)
+#define GLYPH_ATLAS_MIN_PIXELS	(1024u)		/* below the DMA2D setup costs more than the CPU loop */
+#define GLYPH_ATLAS_INVERT		(0x01u)
+#define GLYPH_ATLAS_FLIP		(0x02u)
+
 // should be 43
 #define MAXFRAMES 39
 
@@ -115,6 +166,11 @@ enum LOGOSTATE
 #define SDRAM_DOUBLE_BUFFER_ONE ((uint32_t)(FBGlobalStart + (MAXFRAMES * FBOffsetEachIndex)))
 #define SDRAM_DOUBLE_BUFFER_TWO ((uint32_t)(SDRAM_DOUBLE_BUFFER_ONE + (2 * FBOffsetEachIndex)))
 #define SDRAM_DOUBLE_BUFFER_END ((uint32_t)(SDRAM_DOUBLE_BUFFER_TWO + (2 * FBOffsetEachIndex)))
+#define SDRAM_END				((uint32_t)(SDRAM_BANK_ADDR + 0x2000000))	/* 32 MByte */
+
+#define GLYPH_ATLAS_START		SDRAM_DOUBLE_BUFFER_END
+#define GLYPH_ATLAS_END			HEADER_INDEX_START
+#define HEADER_INDEX_START		((uint32_t)(SDRAM_END - GFX_HEADER_INDEX_SIZE))
 
 /* Semi Private variables ---------------------------------------------------------*/
 
@@ -123,7 +179,30 @@ static LTDC_HandleTypeDef	LtdcHandle;
 
 /* Private variables ---------------------------------------------------------*/
 
-static uint8_t DMA2D_at_work = 0;
+static volatile uint8_t DMA2D_at_work = 0;
+
+static SGlyphIndex glyphIndex[GLYPH_INDEX_FONTS];
+static uint8_t glyphIndexCount = 0;
+static SGlyphIndex *pGlyphIndexLast = 0;
+
+static SGlyphAtlasEntry glyphAtlas[GLYPH_ATLAS_ENTRIES];
+static uint8_t glyphAtlasCount = 0;
+static uint32_t glyphAtlasNext = GLYPH_ATLAS_START;
+
+static GFX_DrawCfgScreen *pRetainedScreen = 0;
+static GFX_DrawCfgWindow * const *pRetainedWindow = 0;
+static uint8_t retainedWindowCount = 0;
+static uint8_t retainedCaller = 0;
+static uint8_t retainedActive = 0;			/* text for the retained windows is recorded instead of drawn */
+static uint8_t retainedCopied = 0;			/* the new frame starts as a copy of retainedFrame */
+static uint32_t retainedFrame = 0;			/* frame of the last completed session, 0 if not usable */
+static uint32_t retainedHash[RETAINED_WINDOWS];
+static uint8_t retainedDirty[RETAINED_WINDOWS];
+static uint8_t retainedFlushed[RETAINED_WINDOWS];
+static SRetainedCommand retainedCommand[RETAINED_COMMANDS];
+static uint8_t retainedCommandCount = 0;
+static char retainedText[RETAINED_TEXT_POOL];
+static uint16_t retainedTextUsed = 0;
 
 static GFX_layerControl FrameHandler = { 0 };
 
@@ -134,7 +213,13 @@ static uint32_t pBackgroundHwFrame = 0;
 static uint8_t backgroundHwStatus;
 
 static SFrameList frame[MAXFRAMES];
+static SFrameQueue cleanFrames;				/* CLEAR, handed out in the order they became clean */
+static SFrameQueue releasedFrames;			/* RELEASED, cleared by housekeepingFrame() oldest first */
+static uint8_t blockedFrames = 0;
+static uint8_t framesOfCaller[FRAME_CALLERS];
+static SFramePoolStatistics framePoolStatistics;
 
+static void GFX_init_frames(uint8_t blockFrames);
 static void GFX_clear_frame_immediately(uint32_t pDestination);
 static void GFX_draw_image_color(GFX_DrawCfgScreen *hgfx, SWindowGimpStyle window, const tImage *image);
 /* ITM Trace-----------------------------------------------------------------*/
@@ -173,6 +258,7 @@ uint32_t MaxU32GFX(uint32_t a, uint32_t b)
 
 /* Private function prototypes -----------------------------------------------*/
 
+static const tChar* GFX_get_glyph(const tFont *Font, uint8_t character);
 static uint32_t GFX_write_char(GFX_DrawCfgWindow* hgfx, GFX_CfgWriteString* cfg, uint8_t character, tFont *Font);
 static uint32_t GFX_write_substring(GFX_CfgWriteString* cfg, GFX_DrawCfgWindow* hgfx, uint8_t textId, int8_t nextCharFor2Byte);
 static uint32_t GFX_write__Modify_Xdelta__Centered(GFX_CfgWriteString* cfg, GFX_DrawCfgWindow* hgfx, const char *pText);
@@ -181,6 +267,9 @@ static void GFX_Error_Handler(void);
 static void GFX_Dma2d_TransferComplete(DMA2D_HandleTypeDef* Dma2dHandle);
 static void GFX_Dma2d_TransferError(DMA2D_HandleTypeDef* Dma2dHandle);
 static void  GFX_clear_frame_dma2d(uint8_t frameId);
+static uint8_t GFX_dma2d_blocking(uint32_t mode, uint32_t source, uint16_t inputOffset, uint32_t pDestination, uint16_t pixelsPerLine, uint16_t lines, uint16_t outputOffset);
+static uint8_t GFX_glyph_atlas_write(const tChar *pGlyph, GFX_CfgWriteString* cfg, uint16_t *pDestination, uint16_t imageHeight, uint8_t flip);
+static uint8_t GFX_retained_record(const tFont *Font, GFX_DrawCfgWindow* hgfx, const char *pText, uint32_t line_number, uint8_t color);
 
 static uint32_t GFX_doubleBufferOne(void);
 static uint32_t GFX_doubleBufferTwo(void);
@@ -321,18 +410,7 @@ void GFX_build_logo_frame(void)
 
 void GFX_init(uint32_t  * pDestinationOut)
 {
-	frame[0].StartAddress = FBGlobalStart;
-	GFX_clear_frame_immediately(frame[0].StartAddress);
-	frame[0].status = CLEAR;
-	frame[0].caller = 0;
-
-	for(int i=1;i<MAXFRAMES;i++)
-	{
-		frame[i].StartAddress = frame[i-1].StartAddress + FBOffsetEachIndex;
-		GFX_clear_frame_immediately(frame[i].StartAddress);
-		frame[i].status = CLEAR;
-		frame[i].caller = 0;
-	}
+	GFX_init_frames(0);
 
 	pInvisibleFrame = getFrame(2);
 	*pDestinationOut = pInvisibleFrame;
@@ -362,25 +440,8 @@ void GFX_init(uint32_t  * pDestinationOut)
 }
 void GFX_init1_no_DMA(uint32_t  * pDestinationOut, uint8_t blockFrames)
 {
-	frame[0].StartAddress = FBGlobalStart;
-	GFX_clear_frame_immediately(frame[0].StartAddress);
-	frame[0].status = CLEAR;
-	frame[0].caller = 0;
+	GFX_init_frames(blockFrames);
 
-	for(int i=1;i<MAXFRAMES;i++)
-	{
-		frame[i].StartAddress = frame[i-1].StartAddress + FBOffsetEachIndex;
-		GFX_clear_frame_immediately(frame[i].StartAddress);
-		frame[i].status = CLEAR;
-		frame[i].caller = 0;
-	}
-
-	for(int i=0;i<blockFrames;i++)
-	{
-		frame[i].status = BLOCKED;
-		frame[i].caller = 1;
-	}
-	
 	pInvisibleFrame = getFrame(2);
 	*pDestinationOut = pInvisibleFrame;
 
@@ -780,6 +841,158 @@ static void  GFX_clear_frame_dma2d(uint8_t frameId)
 }
 
 
+/* synchronous DMA2D transfer in the layout of the frames, returns 0 if DMA2D is in use by housekeeping */
+static uint8_t GFX_dma2d_blocking(uint32_t mode, uint32_t source, uint16_t inputOffset, uint32_t pDestination, uint16_t pixelsPerLine, uint16_t lines, uint16_t outputOffset)
+{
+	uint8_t success = 0;
+
+	/* a frame clear once started is finished by the DMA2D interrupt, one not yet started would never be */
+	while((DMA2D_at_work < MAXFRAMES) && (Dma2dHandle.State == HAL_DMA2D_STATE_BUSY))
+		;
+
+	if(DMA2D_at_work != 255)
+		return 0;
+
+	DMA2D_at_work = DMA2D_BLOCKING;
+
+	Dma2dHandle.Init.Mode = mode;
+	Dma2dHandle.Init.OutputOffset = outputOffset;
+	Dma2dHandle.LayerCfg[1].InputOffset = inputOffset;
+	Dma2dHandle.LayerCfg[1].InputColorMode = DMA2D_INPUT_ARGB4444;
+
+	if((HAL_DMA2D_Init(&Dma2dHandle) == HAL_OK)
+	&& (HAL_DMA2D_ConfigLayer(&Dma2dHandle, 1) == HAL_OK)
+	&& (HAL_DMA2D_Start(&Dma2dHandle, source, pDestination, pixelsPerLine, lines) == HAL_OK)
+	&& (HAL_DMA2D_PollForTransfer(&Dma2dHandle, 100) == HAL_OK))
+		success = 1;
+
+	/* back to the register to memory setup used by GFX_clear_frame_dma2d() */
+	Dma2dHandle.Init.Mode = DMA2D_R2M;
+	Dma2dHandle.Init.OutputOffset = 0;
+	if(HAL_DMA2D_Init(&Dma2dHandle) != HAL_OK)
+		GFX_Error_Handler();
+
+	DMA2D_at_work = 255;
+	return success;
+}
+
+
+/* Large glyphs are decoded once per colour into the SDRAM behind the frame buffers and copied
+ * into the frame by DMA2D. The fonts are alpha only and the frames are AL88, a format DMA2D can
+ * not convert to, therefore the atlas holds the final pixels including the colour and the blit
+ * is a plain 16 bit copy. The atlas starts over when it is full.
+ */
+static SGlyphAtlasEntry* GFX_glyph_atlas_get(const tChar *pGlyph, uint8_t color, uint8_t variant)
+{
+	SGlyphAtlasEntry *pEntry;
+	const uint8_t *pSource;
+	uint16_t *pDest;
+	uint32_t width, height, size;
+	uint32_t i, j;
+	uint16_t pixel;
+	int8_t stepdir;
+
+	for(i = 0; i < glyphAtlasCount; i++)
+	{
+		pEntry = &glyphAtlas[i];
+		if((pEntry->glyph == pGlyph) && (pEntry->color == color) && (pEntry->variant == variant))
+			return pEntry;
+	}
+
+	width = pGlyph->image->width;
+	height = pGlyph->image->height;
+	size = 2 * width * height;
+	if(size > (GLYPH_ATLAS_END - GLYPH_ATLAS_START))
+		return 0;
+
+	if((glyphAtlasCount == GLYPH_ATLAS_ENTRIES) || (glyphAtlasNext + size > GLYPH_ATLAS_END))
+	{
+		glyphAtlasCount = 0;
+		glyphAtlasNext = GLYPH_ATLAS_START;
+	}
+
+	pEntry = &glyphAtlas[glyphAtlasCount++];
+	pEntry->glyph = pGlyph;
+	pEntry->address = glyphAtlasNext;
+	pEntry->color = color;
+	pEntry->variant = variant;
+	glyphAtlasNext += size;
+
+	/* same pixels as GFX_write_char(), a flipped glyph is stored in reverse order */
+	pSource = pGlyph->image->data;
+	if(variant & GLYPH_ATLAS_FLIP)
+	{
+		pDest = (uint16_t *)(pEntry->address + size) - 1;
+		stepdir = -1;
+	}
+	else
+	{
+		pDest = (uint16_t *)pEntry->address;
+		stepdir = 1;
+	}
+
+	for(i = width; i > 0; i--)
+	{
+		if(*pSource != 0x01)
+		{
+			for(j = height; j > 0; j--)
+			{
+				if(variant & GLYPH_ATLAS_INVERT)
+					pixel = (0xFF - *pSource++) << 8 | color;
+				else
+					pixel = *pSource++ << 8 | color;
+				*pDest = pixel;
+				pDest += stepdir;
+			}
+		}
+		else /* empty line */
+		{
+			pSource++;
+			if(variant & GLYPH_ATLAS_INVERT)
+				pixel = 0xFF << 8 | color;
+			else
+				pixel = color;
+			for(j = height; j > 0; j--)
+			{
+				*pDest = pixel;
+				pDest += stepdir;
+			}
+		}
+	}
+	return pEntry;
+}
+
+
+/* returns 1 if the glyph has been copied to pDestination, the first pixel GFX_write_char() would write */
+static uint8_t GFX_glyph_atlas_write(const tChar *pGlyph, GFX_CfgWriteString* cfg, uint16_t *pDestination, uint16_t imageHeight, uint8_t flip)
+{
+	SGlyphAtlasEntry *pEntry;
+	uint32_t width, height;
+	uint8_t variant = 0;
+
+	width = pGlyph->image->width;
+	height = pGlyph->image->height;
+
+	/* odd heights are written without their last pixel row by the CPU loops */
+	if((width * height < GLYPH_ATLAS_MIN_PIXELS) || (height & 1) || (height > imageHeight))
+		return 0;
+
+	if(cfg->invert)
+		variant |= GLYPH_ATLAS_INVERT;
+	if(flip)
+	{
+		variant |= GLYPH_ATLAS_FLIP;
+		pDestination -= (width - 1) * imageHeight + (height - 1);
+	}
+
+	pEntry = GFX_glyph_atlas_get(pGlyph, cfg->color, variant);
+	if(!pEntry)
+		return 0;
+
+	return GFX_dma2d_blocking(DMA2D_M2M, pEntry->address, 0, (uint32_t)pDestination, height, width, imageHeight - height);
+}
+
+
 void GFX_fill_buffer(uint32_t pDestination, uint8_t alpha, uint8_t color)
 {
 
@@ -1892,8 +2105,8 @@ void Gfx_write_label_var(GFX_DrawCfgScreen *screenInput, uint16_t XleftGimpStyle
 uint16_t GFX_return_offset(const tFont *Font, char *pText, uint8_t position)
 {
 	char character;
-	uint16_t digit, i;
-	uint8_t found;
+	uint16_t digit;
+	const tChar *pGlyph;
 	uint16_t distance;
 
 	if(position == 0)
@@ -1906,18 +2119,10 @@ uint16_t GFX_return_offset(const tFont *Font, char *pText, uint8_t position)
 		if(character == 0)
 			return 0;
 
-		found = 0;
-		for(i=0;i<Font->length;i++)
-		{
-			if(Font->chars[i].code == character)
-			{
-				found = 1;
-				break;
-			}
-		}
-		if(found)
+		pGlyph = GFX_get_glyph(Font, (uint8_t)character);
+		if(pGlyph)
 		{
-			distance += (uint16_t)(Font->chars[i].image->width);
+			distance += (uint16_t)(pGlyph->image->width);
 			if(Font == &FontT144)
 				distance += 3;
 			else
@@ -2026,6 +2231,9 @@ uint32_t GFX_write_string_color(const tFont *Font, GFX_DrawCfgWindow* hgfx, cons
 	if(hgfx->Image->FBStartAdress < FBGlobalStart)
 		return 0;
 
+	if(retainedActive && GFX_retained_record(Font, hgfx, pText, line_number, color))
+		return 0;
+
 	GFX_CfgWriteString settings;
 	uint32_t newXdelta;
 	uint8_t minimal = 0;
@@ -2370,7 +2578,7 @@ static uint32_t GFX_write_char_doubleSize(GFX_DrawCfgWindow* hgfx, GFX_CfgWriteS
 {
 	uint32_t i, j;
 	uint32_t width, height;
-	uint32_t found;
+	const tChar *pGlyph;
 	uint16_t* pDestination;
 	uint32_t pSource;
 	uint32_t OffsetDestination;
@@ -2400,23 +2608,15 @@ static uint32_t GFX_write_char_doubleSize(GFX_DrawCfgWindow* hgfx, GFX_CfgWriteS
 		return 0x0000FFFF;
 
 	// -----------------------------
-	found = 0;
-	for(i=0;i<Font->length;i++)
-	{
-		if(Font->chars[i].code == character)
-		{
-			found = 1;
-			break;
-		}
-	}
-	if(!found)
+	pGlyph = GFX_get_glyph(Font, character);
+	if(!pGlyph)
 		return cfg->Xdelta;
 
-	pSource = ((uint32_t)Font->chars[i].image->data);
+	pSource = ((uint32_t)pGlyph->image->data);
 	pDestination = (uint16_t*)(hgfx->Image->FBStartAdress);
 
-	heightFont = Font->chars[i].image->height;
-	widthFont = Font->chars[i].image->width;
+	heightFont = pGlyph->image->height;
+	widthFont = pGlyph->image->width;
 
 	height = heightFont*2;
 	width = widthFont*2;
@@ -2761,7 +2961,7 @@ static uint32_t GFX_write_char(GFX_DrawCfgWindow* hgfx, GFX_CfgWriteString* cfg,
 	
 	uint32_t i, j;
 	uint32_t width, height;
-	uint32_t found;
+	const tChar *pGlyph;
 	uint16_t* pDestination;
 	uint32_t pSource;
 	uint32_t OffsetDestination;
@@ -2789,16 +2989,8 @@ static uint32_t GFX_write_char(GFX_DrawCfgWindow* hgfx, GFX_CfgWriteString* cfg,
 		return 0x0000FFFF;
 
 	// -----------------------------
-	found = 0;
-	for(i=0;i<Font->length;i++)
-	{
-		if(Font->chars[i].code == character)
-		{
-			found = 1;
-			break;
-		}
-	}
-	if(!found)
+	pGlyph = GFX_get_glyph(Font, character);
+	if(!pGlyph)
 		return cfg->Xdelta;
 // -----------------------------
 /*
@@ -2811,12 +3003,12 @@ static uint32_t GFX_write_char(GFX_DrawCfgWindow* hgfx, GFX_CfgWriteString* cfg,
 // -----------------------------
 
 
-	pSource = ((uint32_t)Font->chars[i].image->data);
+	pSource = ((uint32_t)pGlyph->image->data);
 	pDestination = (uint16_t*)(hgfx->Image->FBStartAdress);
 
 
-	height = Font->chars[i].image->height;
-	width = Font->chars[i].image->width;
+	height = pGlyph->image->height;
+	width = pGlyph->image->width;
 
 	OffsetDestination = hgfx->Image->ImageHeight - height;
 
@@ -2878,6 +3070,12 @@ static uint32_t GFX_write_char(GFX_DrawCfgWindow* hgfx, GFX_CfgWriteString* cfg,
 		return 0x0000FFFF;
 // -----------------------------
 	
+	if(!cfg->singleSpaceWithSizeOfNextChar && !char_truncated_WidthFlag && !char_truncated_Height
+	&& GFX_glyph_atlas_write(pGlyph, cfg, pDestination, hgfx->Image->ImageHeight, pSettings->FlipDisplay))
+	{
+		/* copied from the glyph atlas */
+	}
+	else
 	if(cfg->singleSpaceWithSizeOfNextChar)
 	{
 		cfg->singleSpaceWithSizeOfNextChar = 0;
@@ -3574,123 +3772,287 @@ static uint32_t GFX_doubleBufferTwo(void)
 	return SDRAM_DOUBLE_BUFFER_TWO;
 }
 
-uint32_t getFrame(uint8_t callerId)
+/* Frame pool: CLEAR frames wait in cleanFrames, RELEASED ones in releasedFrames until housekeepingFrame()
+ * has DMA2D clear them, the transfer complete interrupt moves them to cleanFrames. BLOCKED frames are
+ * counted per caller. The queues are shared with the DMA2D interrupt, hence the short critical sections.
+ */
+static uint32_t GFX_frame_pool_lock(void)
+{
+	uint32_t priMask = __get_PRIMASK();
+
+	__disable_irq();
+	return priMask;
+}
+
+
+static void GFX_frame_pool_unlock(uint32_t priMask)
+{
+	__set_PRIMASK(priMask);
+}
+
+
+static void GFX_frame_queue_push(SFrameQueue *pQueue, uint8_t index)
+{
+	frame[index].next = FRAME_NONE;
+	if(pQueue->count == 0)
+		pQueue->first = index;
+	else
+		frame[pQueue->last].next = index;
+
+	pQueue->last = index;
+	pQueue->count++;
+}
+
+
+static uint8_t GFX_frame_queue_pop(SFrameQueue *pQueue)
+{
+	uint8_t index = pQueue->first;
+
+	if(pQueue->count == 0)
+		return FRAME_NONE;
+
+	pQueue->first = frame[index].next;
+	pQueue->count--;
+	return index;
+}
+
+
+/* oldest released frame which is not on the display, at most two are, so the search ends within three steps */
+static uint8_t GFX_frame_take_released(uint8_t allowShown)
 {
-	static uint8_t lastFrameProvided = 0;
+	uint8_t previous = FRAME_NONE;
+	uint8_t index = releasedFrames.first;
 	uint8_t i;
 
-/* first iteration: look for a clear frame */
-	i = lastFrameProvided;
-	do
+	for(i = 0; i < releasedFrames.count; i++)
 	{
-		i++;
-		if(i == MAXFRAMES)
+		if((frame[index].StartAddress != GFX_get_pActualFrameTop()) && (frame[index].StartAddress != GFX_get_pActualFrameBottom()))
+			break;
+		previous = index;
+		index = frame[index].next;
+	}
+
+	if(i == releasedFrames.count)
+		return allowShown ? GFX_frame_queue_pop(&releasedFrames) : FRAME_NONE;
+
+	if(previous == FRAME_NONE)
+		return GFX_frame_queue_pop(&releasedFrames);
+
+	frame[previous].next = frame[index].next;
+	if(releasedFrames.last == index)
+		releasedFrames.last = previous;
+	releasedFrames.count--;
+	return index;
+}
+
+
+static void GFX_frame_block(uint8_t index, uint8_t callerId)
+{
+	frame[index].status = BLOCKED;
+	frame[index].caller = callerId;
+	framesOfCaller[callerId]++;
+	blockedFrames++;
+	if(blockedFrames > framePoolStatistics.blockedMax)
+		framePoolStatistics.blockedMax = blockedFrames;
+}
+
+
+static void GFX_frame_release(uint8_t index)
+{
+	frame[index].status = RELEASED;
+	framesOfCaller[frame[index].caller]--;
+	blockedFrames--;
+	GFX_frame_queue_push(&releasedFrames, index);
+	if(frame[index].StartAddress == retainedFrame)
+		retainedFrame = 0;
+}
+
+
+/* frames are laid out back to back from FBGlobalStart, FRAME_NONE for any other address */
+static uint8_t GFX_frame_index(uint32_t frameStartAddress)
+{
+	uint32_t offset;
+
+	if(frameStartAddress < FBGlobalStart)
+		return FRAME_NONE;
+
+	offset = frameStartAddress - FBGlobalStart;
+	if((offset % FBOffsetEachIndex) || ((offset / FBOffsetEachIndex) >= MAXFRAMES))
+		return FRAME_NONE;
+
+	return offset / FBOffsetEachIndex;
+}
+
+
+static void GFX_init_frames(uint8_t blockFrames)
+{
+	uint8_t i;
+
+	cleanFrames.count = 0;
+	releasedFrames.count = 0;
+	blockedFrames = 0;
+	memset(framesOfCaller, 0, sizeof(framesOfCaller));
+	memset(&framePoolStatistics, 0, sizeof(framePoolStatistics));
+
+	for(i = 0; i < MAXFRAMES; i++)
+	{
+		frame[i].StartAddress = FBGlobalStart + (i * FBOffsetEachIndex);
+		GFX_clear_frame_immediately(frame[i].StartAddress);
+		if(i < blockFrames)
 		{
-			i = 0;
+			GFX_frame_block(i, 1);
 		}
-	} while((i != lastFrameProvided) && (frame[i].status != CLEAR));
+		else
+		{
+			frame[i].status = CLEAR;
+			frame[i].caller = 0;
+			GFX_frame_queue_push(&cleanFrames, i);
+		}
+	}
+}
 
-	if((i < MAXFRAMES) && (frame[i].status == CLEAR))
-	{
-		frame[i].status = BLOCKED;
-		frame[i].caller = callerId;
-		lastFrameProvided = i;
+
+uint32_t getFrame(uint8_t callerId)
+{
+	uint32_t priMask;
+	uint32_t waitStart;
+	uint32_t waitTicks;
+	uint8_t clearHere = 0;
+	uint8_t i;
+
+	priMask = GFX_frame_pool_lock();
+	i = GFX_frame_queue_pop(&cleanFrames);
+	if(i != FRAME_NONE)
+		GFX_frame_block(i, callerId);
+	GFX_frame_pool_unlock(priMask);
+
+	if(i != FRAME_NONE)
 		return frame[i].StartAddress;
+
+/* no clean frame: wait for the one DMA2D is clearing or clear the oldest released frame here */
+	framePoolStatistics.waitCount++;
+	waitStart = HAL_GetTick();
+
+	while((DMA2D_at_work < MAXFRAMES) && (Dma2dHandle.State == HAL_DMA2D_STATE_BUSY))
+		;
+
+	priMask = GFX_frame_pool_lock();
+	i = GFX_frame_queue_pop(&cleanFrames);
+	if(i == FRAME_NONE)
+	{
+		i = GFX_frame_take_released(1);
+		clearHere = 1;
 	}
+	if(i != FRAME_NONE)
+		GFX_frame_block(i, callerId);
+	GFX_frame_pool_unlock(priMask);
 
-/* second iteration: look for a frame which may be reused after clearing */
-	i = lastFrameProvided;
-	do
+	if(i == FRAME_NONE)
 	{
-		i++;
-		if(i == MAXFRAMES)
-		{
-			i = 0;
-		}
-	}while((i != lastFrameProvided) && (frame[i].status != RELEASED));
+		framePoolStatistics.acquireFailed++;
+		framePoolStatistics.failedCaller = callerId;
+		return 0;
+	}
+
+	if(clearHere)
+		GFX_clear_frame_immediately(frame[i].StartAddress);
+
+	waitTicks = HAL_GetTick() - waitStart;
+	framePoolStatistics.waitTicks += waitTicks;
+	if(waitTicks > framePoolStatistics.waitTicksMax)
+		framePoolStatistics.waitTicksMax = waitTicks;
 
+	return frame[i].StartAddress;
+}
+
+
+/* release the frames of a caller except keep, stops once all frames counted for the caller are found */
+static void GFX_release_frames_of_caller(uint8_t callerId, uint8_t keep)
+{
+	uint32_t priMask;
+	uint8_t remaining;
+	uint8_t i;
+
+	priMask = GFX_frame_pool_lock();
+	remaining = framesOfCaller[callerId];
+	if((keep != FRAME_NONE) && (frame[keep].status == BLOCKED) && (frame[keep].caller == callerId))
+		remaining--;
 
-	if((i < MAXFRAMES) && (frame[i].status == RELEASED))
+	for(i = 0; (i < MAXFRAMES) && (remaining > 0); i++)
 	{
-		GFX_clear_frame_immediately(frame[i].StartAddress);
-		frame[i].status = BLOCKED;
-		lastFrameProvided = i;
-		return frame[i].StartAddress;
+		if((i != keep) && (frame[i].status == BLOCKED) && (frame[i].caller == callerId))
+		{
+			GFX_frame_release(i);
+			remaining--;
+		}
 	}
-	return 0;
+	GFX_frame_pool_unlock(priMask);
 }
 
 
 void GFX_forceReleaseFramesWithId(uint8_t callerId)
 {
-	for(int i=0; i<MAXFRAMES; i++)
-		if((frame[i].caller == callerId) && (frame[i].status == BLOCKED))
-			frame[i].status = RELEASED;
+	GFX_release_frames_of_caller(callerId, FRAME_NONE);
 }
 
 
 void releaseAllFramesExcept(uint8_t callerId, uint32_t frameStartAddress)
 {
-	for(int i=0; i<MAXFRAMES; i++)
-		if((frame[i].caller == callerId) && (frame[i].status == BLOCKED) && (frame[i].StartAddress != frameStartAddress))
-			frame[i].status = RELEASED;
+	GFX_release_frames_of_caller(callerId, GFX_frame_index(frameStartAddress));
 }
 
 
 uint8_t releaseFrame(uint8_t callerId, uint32_t frameStartAddress)
 {
-	static uint8_t countErrorCalls = 0;
-	
+	uint32_t priMask;
+	uint8_t retVal = 0;
+	uint8_t i;
+
 	if(frameStartAddress < FBGlobalStart)
 		return 2;
 
+	i = GFX_frame_index(frameStartAddress);
+	if(i == FRAME_NONE)
+		return 0;
 
-	uint8_t i;
-
-	i = 0;
-	while((i < MAXFRAMES) && (frame[i].StartAddress != frameStartAddress))
-		i++;
-
-	if((i < MAXFRAMES) && (frame[i].StartAddress == frameStartAddress))
+	priMask = GFX_frame_pool_lock();
+	if(frame[i].caller == callerId)
 	{
-		if(frame[i].caller == callerId)
-		{
-			frame[i].status = RELEASED;
-			return 1;
-		}
-		else
-			countErrorCalls++;
+		if(frame[i].status == BLOCKED)
+			GFX_frame_release(i);
+		retVal = 1;
 	}
-	return 0;
+	else
+	{
+		framePoolStatistics.releaseForeign++;
+	}
+	GFX_frame_pool_unlock(priMask);
+
+	return retVal;
 }
 
 
 uint16_t blockedFramesCount(void)
 {
-	uint16_t count = MAXFRAMES;
-	
-	for(int i = 0;i<MAXFRAMES;i++)
-		if(frame[i].status == BLOCKED)
-			count--;
-		
-	return count;
+	return MAXFRAMES - blockedFrames;
 }
 
 
 uint8_t housekeepingFrame(void)
 {
 	static uint8_t countLogClear = 0;
+	uint32_t priMask;
 	uint8_t i;
 	uint8_t retVal = 1;
 	
 	if(DMA2D_at_work == 255)
 	{
-		i = 0;
 		/* skip frame cleaning for actual frames which have not yet been replaced by new top/bottom frames */
-		while((i < MAXFRAMES) && ((frame[i].status != RELEASED) || (frame[i].StartAddress == GFX_get_pActualFrameTop()) || (frame[i].StartAddress == GFX_get_pActualFrameBottom())))
-			i++;
-	
-		if((i < MAXFRAMES) && (frame[i].status == RELEASED))
+		priMask = GFX_frame_pool_lock();
+		i = GFX_frame_take_released(0);
+		GFX_frame_pool_unlock(priMask);
+
+		if(i != FRAME_NONE)
 		{
 			if(frame[i].caller == 15)
 				countLogClear++;
@@ -3705,10 +4067,252 @@ uint8_t housekeepingFrame(void)
 }
 
 
+void GFX_getFramePoolStatistics(SFramePoolStatistics *pStatistics)
+{
+	uint32_t priMask;
+
+	priMask = GFX_frame_pool_lock();
+	*pStatistics = framePoolStatistics;
+	pStatistics->total = MAXFRAMES;
+	pStatistics->clean = cleanFrames.count;
+	pStatistics->blocked = blockedFrames;
+	pStatistics->released = releasedFrames.count;
+	if((DMA2D_at_work < MAXFRAMES) && (frame[DMA2D_at_work].status == RELEASED))
+		pStatistics->released++;
+	GFX_frame_pool_unlock(priMask);
+}
+
+
+/* logbook header index of externLogbookFlash.c, behind the glyph atlas and outside of the frame pool */
+uint32_t GFX_getHeaderIndexMemory(void)
+{
+	return HEADER_INDEX_START;
+}
+
+
+void GFX_resetFramePoolStatistics(void)
+{
+	uint32_t priMask;
+
+	priMask = GFX_frame_pool_lock();
+	memset(&framePoolStatistics, 0, sizeof(framePoolStatistics));
+	framePoolStatistics.blockedMax = blockedFrames;
+	GFX_frame_pool_unlock(priMask);
+}
+
+
+uint8_t GFX_getFramesOfCaller(uint8_t callerId)
+{
+	return framesOfCaller[callerId];
+}
+
+
+/* Retained frame: a screen which is refreshed with mostly unchanged content registers the windows
+ * holding its text fields. The new frame starts as a DMA2D copy of the previous one, text written
+ * to a registered window is recorded and only windows whose content hash changed are cleared and
+ * rendered again at GFX_retained_end(). Everything else has to be drawn into areas cleared by
+ * GFX_retained_clear(). Without a usable previous frame the session renders everything as before.
+ */
+void GFX_retained_begin(GFX_DrawCfgScreen *hscreen, uint8_t callerId, GFX_DrawCfgWindow * const *pWindows, uint8_t windowCount)
+{
+	uint8_t i;
+
+	if(windowCount > RETAINED_WINDOWS)
+		windowCount = RETAINED_WINDOWS;
+
+	if((pWindows != pRetainedWindow) || (windowCount != retainedWindowCount) || (callerId != retainedCaller))
+	{
+		pRetainedWindow = pWindows;
+		retainedWindowCount = windowCount;
+		retainedCaller = callerId;
+		retainedFrame = 0;
+	}
+
+	pRetainedScreen = hscreen;
+	retainedCopied = 0;
+	if((retainedFrame != 0) && (retainedFrame != hscreen->FBStartAdress) && (hscreen->FBStartAdress >= FBGlobalStart))
+	{
+		i = GFX_frame_index(retainedFrame);
+		if((i != FRAME_NONE) && (frame[i].status == BLOCKED) && (frame[i].caller == callerId))
+			retainedCopied = GFX_dma2d_blocking(DMA2D_M2M, retainedFrame, 0, hscreen->FBStartAdress, hscreen->ImageHeight, hscreen->ImageWidth, 0);
+	}
+	retainedFrame = 0;
+
+	for(i = 0; i < retainedWindowCount; i++)
+	{
+		retainedDirty[i] = 0;
+		retainedFlushed[i] = 0;
+		if(!retainedCopied)
+			retainedHash[i] = RETAINED_HASH_NONE;
+	}
+	retainedCommandCount = 0;
+	retainedTextUsed = 0;
+	retainedActive = 1;
+}
+
+
+/* the next session renders everything instead of starting with a copy of the previous frame */
+void GFX_retained_invalidate(void)
+{
+	retainedFrame = 0;
+}
+
+
+/* clear an area of volatile content, needed only if the frame was copied */
+void GFX_retained_clear(GFX_DrawCfgWindow* hgfx)
+{
+	uint16_t width, height;
+	uint8_t i;
+
+	if(!retainedActive || !retainedCopied)
+		return;
+
+	for(i = 0; i < retainedWindowCount; i++)
+	{
+		if((hgfx->WindowX0 <= pRetainedWindow[i]->WindowX1) && (hgfx->WindowX1 >= pRetainedWindow[i]->WindowX0)
+		&& (hgfx->WindowY0 <= pRetainedWindow[i]->WindowY1) && (hgfx->WindowY1 >= pRetainedWindow[i]->WindowY0))
+			retainedDirty[i] = 1;
+	}
+
+	width = 1 + hgfx->WindowX1 - hgfx->WindowX0;
+	height = 1 + hgfx->WindowY1 - hgfx->WindowY0;
+	if(!GFX_dma2d_blocking(DMA2D_R2M, 0, 0, hgfx->Image->FBStartAdress + 2 * (hgfx->WindowX0 * hgfx->Image->ImageHeight + hgfx->WindowY0),
+							height, width, hgfx->Image->ImageHeight - height))
+		GFX_clear_window_immediately(hgfx);
+}
+
+
+static uint32_t GFX_retained_hash(uint32_t hash, const uint8_t *pData, uint32_t length)
+{
+	while(length--)
+	{
+		hash ^= *pData++;
+		hash *= 16777619u;	/* FNV-1a */
+	}
+	return hash;
+}
+
+
+static uint32_t GFX_retained_window_hash(uint8_t windowIndex)
+{
+	const SRetainedCommand *pCmd;
+	const char *pText;
+	uint32_t hash = 2166136261u;
+	uint8_t i;
+
+	for(i = 0; i < retainedCommandCount; i++)
+	{
+		pCmd = &retainedCommand[i];
+		if(pCmd->windowIndex != windowIndex)
+			continue;
+
+		pText = &retainedText[pCmd->textStart];
+		hash = GFX_retained_hash(hash, (const uint8_t *)&pCmd->font, sizeof(pCmd->font));
+		hash = GFX_retained_hash(hash, (const uint8_t *)&pCmd->window.WindowX0, 4 * sizeof(uint16_t));
+		hash = GFX_retained_hash(hash, &pCmd->line, sizeof(pCmd->line));
+		hash = GFX_retained_hash(hash, &pCmd->color, sizeof(pCmd->color));
+		hash = GFX_retained_hash(hash, (const uint8_t *)pText, strlen(pText) + 1);
+	}
+	if(hash == RETAINED_HASH_NONE)
+		hash = 1;
+	return hash;
+}
+
+
+static void GFX_retained_render(uint8_t windowIndex)
+{
+	SRetainedCommand *pCmd;
+	uint8_t i;
+
+	if(retainedCopied)
+		GFX_retained_clear(pRetainedWindow[windowIndex]);
+
+	retainedActive = 0;
+	for(i = 0; i < retainedCommandCount; i++)
+	{
+		pCmd = &retainedCommand[i];
+		if(pCmd->windowIndex == windowIndex)
+			GFX_write_string_color(pCmd->font, &pCmd->window, &retainedText[pCmd->textStart], pCmd->line, pCmd->color);
+	}
+	retainedActive = 1;
+}
+
+
+/* returns 1 if the text has been recorded, 0 if it has to be drawn right now */
+static uint8_t GFX_retained_record(const tFont *Font, GFX_DrawCfgWindow* hgfx, const char *pText, uint32_t line_number, uint8_t color)
+{
+	SRetainedCommand *pCmd;
+	uint16_t length;
+	uint8_t i;
+
+	i = 0;
+	while((i < retainedWindowCount) && (pRetainedWindow[i] != hgfx))
+		i++;
+
+	if((i == retainedWindowCount) || retainedFlushed[i])
+		return 0;
+
+	length = strlen(pText) + 1;
+	if((retainedCommandCount == RETAINED_COMMANDS) || (retainedTextUsed + length > RETAINED_TEXT_POOL) || (line_number > 0xFF))
+	{
+		/* out of space: render what has been recorded for this window and draw directly from now on */
+		GFX_retained_render(i);
+		retainedFlushed[i] = 1;
+		return 0;
+	}
+
+	pCmd = &retainedCommand[retainedCommandCount++];
+	pCmd->font = Font;
+	pCmd->window = *hgfx;
+	pCmd->textStart = retainedTextUsed;
+	pCmd->windowIndex = i;
+	pCmd->line = line_number;
+	pCmd->color = color;
+	memcpy(&retainedText[retainedTextUsed], pText, length);
+	retainedTextUsed += length;
+	return 1;
+}
+
+
+/* render the changed windows, the frame will be the source of the next session */
+void GFX_retained_end(void)
+{
+	uint32_t hash;
+	uint8_t i;
+
+	if(!retainedActive)
+		return;
+
+	for(i = 0; i < retainedWindowCount; i++)
+	{
+		if(retainedFlushed[i])
+		{
+			retainedHash[i] = RETAINED_HASH_NONE;
+			continue;
+		}
+
+		hash = GFX_retained_window_hash(i);
+		if(!retainedCopied || retainedDirty[i] || (hash != retainedHash[i]))
+			GFX_retained_render(i);
+		retainedHash[i] = hash;
+	}
+
+	retainedActive = 0;
+	retainedFrame = pRetainedScreen->FBStartAdress;
+}
+
+
 static void GFX_Dma2d_TransferComplete(DMA2D_HandleTypeDef* Dma2dHandle)
 {
-	if(DMA2D_at_work < MAXFRAMES)
+	uint32_t priMask;
+
+	if((DMA2D_at_work < MAXFRAMES) && (frame[DMA2D_at_work].status == RELEASED))
+	{
+		priMask = GFX_frame_pool_lock();
 		frame[DMA2D_at_work].status = CLEAR;
+		GFX_frame_queue_push(&cleanFrames, DMA2D_at_work);
+		GFX_frame_pool_unlock(priMask);
+	}
 
 	DMA2D_at_work = 255;
 }
@@ -4070,18 +4674,9 @@ void GFX_screenshot(void)
 #ifndef BOOTLOADER_STANDALONE
 tFont* GFX_Check_Extra_Font(uint8_t character, tFont *Font)
 {
-	uint32_t i;
 	uint32_t found;
 
-	found = 0;
-	for(i=0;i<Font->length;i++)
-	{
-		if(Font->chars[i].code == character)
-		{
-			found = 1;
-			break;
-		}
-	}
+	found = (GFX_get_glyph(Font, character) != 0);
 	if (!found && Font == &FontT54)
 	{
 		Font = (tFont *)&FontT54Extra;
@@ -4100,17 +4695,15 @@ tFont* GFX_Check_Extra_Font(uint8_t character, tFont *Font)
 #endif
 uint32_t GFX_Character_Width(uint8_t character, tFont *Font)
 {
-	uint32_t i;
+	const tChar *pGlyph;
 #ifndef BOOTLOADER_STANDALONE
 	uint32_t found;
 #endif
 
-	for(i=0;i<Font->length;i++)
+	pGlyph = GFX_get_glyph(Font, character);
+	if(pGlyph)
 	{
-		if(Font->chars[i].code == character)
-		{
-			return Font->chars[i].image->width;
-		}
+		return pGlyph->image->width;
 	}
 
 #ifndef BOOTLOADER_STANDALONE
@@ -4133,18 +4726,64 @@ uint32_t GFX_Character_Width(uint8_t character, tFont *Font)
 
 	if (found)
 	{
-		for(i=0;i<Font->length;i++)
+		pGlyph = GFX_get_glyph(Font, character);
+		if(pGlyph)
 		{
-			if(Font->chars[i].code == character)
-			{
-				return Font->chars[i].image->width;
-			}
+			return pGlyph->image->width;
 		}
 	}
 #endif
 	return 0;
 }
 
+/* Returns the glyph of a character or 0 if the font does not have it.
+ * Every font gets a table from character code to glyph on first use, the glyphs stay
+ * in the font directory of the font pack, so the table can not be part of tFont itself.
+ */
+static const tChar* GFX_get_glyph(const tFont *Font, uint8_t character)
+{
+	SGlyphIndex *pIndex = pGlyphIndexLast;
+	uint32_t i;
+
+	if((pIndex == 0) || (pIndex->font != Font))
+	{
+		pIndex = 0;
+		for(i = 0; i < glyphIndexCount; i++)
+		{
+			if(glyphIndex[i].font == Font)
+			{
+				pIndex = &glyphIndex[i];
+				break;
+			}
+		}
+		if((pIndex == 0) && (glyphIndexCount < GLYPH_INDEX_FONTS) && (Font->length < GLYPH_NONE))
+		{
+			pIndex = &glyphIndex[glyphIndexCount++];
+			pIndex->font = Font;
+			memset(pIndex->glyph, GLYPH_NONE, sizeof(pIndex->glyph));
+			for(i = Font->length; i > 0; i--)	/* backwards, the first glyph of a code wins as with the linear search */
+			{
+				if((Font->chars[i - 1].code >= 0) && (Font->chars[i - 1].code <= 0xFF))
+					pIndex->glyph[Font->chars[i - 1].code] = i - 1;
+			}
+		}
+		if(pIndex == 0)		/* no index available: linear search */
+		{
+			for(i = 0; i < Font->length; i++)
+			{
+				if(Font->chars[i].code == character)
+					return &Font->chars[i];
+			}
+			return 0;
+		}
+		pGlyphIndexLast = pIndex;
+	}
+
+	if(pIndex->glyph[character] == GLYPH_NONE)
+		return 0;
+	return &Font->chars[pIndex->glyph[character]];
+}
+
 void Gfx_colorsscheme_mod(char *text, uint8_t alternativeColor)
 {
 	char *p = text;
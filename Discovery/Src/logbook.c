@@ -58,6 +58,7 @@
 #include "tHome.h" // for  tHome_findNextStop()
 #include "settings.h"
 #include "configuration.h"
+#include "logbook_compact.h"
  
 /* Private types -------------------------------------------------------------*/
 
@@ -67,16 +68,16 @@
 #define DEFAULT_SAMPLES	(100)	/* Number of sample data bytes in case of an broken header information */
 #define DUMMY_SAMPLES	(1000)	/* Maximum number of samples profided by a dummy dive profile */
 
-typedef struct /* don't forget to adjust void clear_divisor(void) */
+typedef struct
 {
-	uint8_t temperature;
-	uint8_t deco_ndl;
-	uint8_t gradientFactor;
-	uint8_t ppo2;
-	uint8_t decoplan;
-	uint8_t cns;
-	uint8_t tank;
-} SDivisor;
+	SCompactState last;
+	SSmallHeader smallHeader;
+	SDivisor divisor;
+	uint8_t sample[COMPACT_SAMPLE_SIZE];	/* decoded standard sample */
+	uint16_t sampleLength;
+	uint16_t sampleIndex;
+	uint8_t end;
+} SCompactReader;
 
 /* Exported variables --------------------------------------------------------*/
 
@@ -93,9 +94,17 @@ static uint16_t	dummyWriteIdx;
 static uint16_t	dummyReadIdx;
 static uint8_t dummyMemoryBuffer[5000];
 
+static SCompactState compactWrite;
+static uint32_t standardProfileLength;		/* length of the profile being written in standard samples */
+static uint8_t readEncoding = PROFILE_ENCODING_STANDARD;	/* encoding of the profile opened for reading */
+static SCompactReader compactRead;
+static SCompactReader compactReadBackup;
+
 
 /* Private function prototypes -----------------------------------------------*/
 static void clear_divisor(void);
+static void logbook_startCompactRead(const SLogbookHeader* pHead);
+static void logbook_setStandardProfileLength(SLogbookHeader* pHead, uint32_t length);
 static void logbook_SetAverageDepth(float average_depth_meter);
 static void logbook_SetMinTemperature(float min_temperature_celsius);
 static void logbook_SetMaxCNS(float max_cns_percentage);
@@ -109,6 +118,8 @@ static void logbook_createDummyProfile(SLogbookHeader* pHeader, uint16_t length,
 
 void logbook_EndDive(void)
 {
+	if(gheader.profileEncoding == PROFILE_ENCODING_COMPACT)
+		logbook_setStandardProfileLength(&gheader, standardProfileLength + 2);	/* + end marker added by ext_flash_close_new_dive_log() */
 	ext_flash_close_new_dive_log((uint8_t*) &gheader);
 }
 
@@ -279,6 +290,12 @@ void logbook_initNewdiveProfile(const SDiveState* pInfo, SSettings* pSettings)
 
 	logbook_SetCompartmentDesaturation(pInfo);
 
+#ifdef ENABLE_COMPACT_PROFILE
+	gheader.profileEncoding = PROFILE_ENCODING_COMPACT;
+#endif
+	memset(&compactWrite, 0, sizeof(compactWrite));
+	standardProfileLength = sizeof(SSmallHeader);
+
 	ext_flash_start_new_dive_log_and_set_actualPointerSample((uint8_t*)&gheader);
 
 	smallHeader.profileLength[0] = 0xFF;
@@ -339,16 +356,9 @@ void logbook_initNewdiveProfile(const SDiveState* pInfo, SSettings* pSettings)
 */
 static void clear_divisor(void)
 {
-	divisor.cns = smallHeader.cnsDivisor - 1;
-	divisor.decoplan = smallHeader.decoplanDivisor - 1;
-	divisor.deco_ndl = smallHeader.deco_ndlDivisor - 1;
-	divisor.gradientFactor = smallHeader.gfDivisor -1 ;
-	divisor.ppo2 = smallHeader.ppo2Divisor - 1;
-	divisor.tank = smallHeader.tankDivisor - 1;
-	divisor.temperature = smallHeader.tempDivisor - 1;
+	compact_setDivisor(&divisor, &smallHeader);
 }
 
-
 /**
   ******************************************************************************
   * @brief   add16. /  adds 16 bit variable to 8 bit array
@@ -370,6 +380,145 @@ static void addS16(uint8_t *pos, int16_t var)
        *((int16_t*)pos) = var;
 }
 
+static void logbook_stopCompactSamples(SCompactReader *pReader)
+{
+	memset(pReader->sample, 0xFF, sizeof(pReader->sample));
+	pReader->sampleLength = sizeof(pReader->sample);
+	pReader->end = 1;
+}
+
+static void logbook_readCompactPart(void *pContext, uint8_t *pTarget, uint16_t length)
+{
+	ext_flash_read_next_sample_part(pTarget, length);
+}
+
+/* reads one compact sample from flash and rebuilds the standard sample */
+static void logbook_decodeCompactSample(SCompactReader *pReader)
+{
+	uint8_t control = 0;
+	uint8_t fields;
+
+	ext_flash_read_next_sample_part(&control, 1);
+	if(control == COMPACT_END_MARKER)
+	{
+		pReader->sample[0] = control;
+		ext_flash_read_next_sample_part(&pReader->sample[1], 1);
+		pReader->sampleLength = 2;
+		pReader->end = 1;
+		return;
+	}
+
+	fields = compact_nextSampleFields(&pReader->divisor, &pReader->smallHeader);
+	pReader->sampleLength = compact_decodeSample(control, fields, &pReader->smallHeader, &pReader->last,
+												 logbook_readCompactPart, NULL, pReader->sample);
+	if(pReader->sampleLength == 0)		/* erased or broken => continue like erased flash */
+	{
+		logbook_stopCompactSamples(pReader);
+	}
+}
+
+static void logbook_startCompactRead(const SLogbookHeader* pHead)
+{
+	uint32_t smallProfileLength;
+
+	memset(&compactRead, 0, sizeof(compactRead));
+	ext_flash_read_next_sample_part((uint8_t*)&compactRead.smallHeader, sizeof(SSmallHeader));
+	compact_setDivisor(&compactRead.divisor, &compactRead.smallHeader);
+
+	/* a consistent profile reports its standard length, a broken one keeps the mismatch checked by the readers */
+	smallProfileLength = (compactRead.smallHeader.profileLength[2] << 16) + (compactRead.smallHeader.profileLength[1] << 8)
+						+ compactRead.smallHeader.profileLength[0];
+	if(smallProfileLength == (pHead->profileLength[2] << 16) + (pHead->profileLength[1] << 8) + pHead->profileLength[0])
+	{
+		memcpy(compactRead.smallHeader.profileLength, pHead->standardProfileLength, 3);
+	}
+	memcpy(compactRead.sample, &compactRead.smallHeader, sizeof(SSmallHeader));
+	compactRead.sampleLength = sizeof(SSmallHeader);
+	readEncoding = PROFILE_ENCODING_COMPACT;
+}
+
+static void logbook_setStandardProfileLength(SLogbookHeader* pHead, uint32_t length)
+{
+	pHead->standardProfileLength[0] = length & 0xFF;
+	pHead->standardProfileLength[1] = (length >> 8) & 0xFF;
+	pHead->standardProfileLength[2] = (length >> 16) & 0xFF;
+}
+
+/**
+  ******************************************************************************
+  * @brief   logbook_getStandardProfileLength. /  profile length as provided by logbook_readStandardProfile()
+  ******************************************************************************
+	*
+  * @param  pHead: header of the dive
+  * @return length of the profile in standard samples
+  */
+uint32_t logbook_getStandardProfileLength(const SLogbookHeader* pHead)
+{
+	const uint8_t *pLength = pHead->profileLength;
+
+	if(pHead->profileEncoding == PROFILE_ENCODING_COMPACT)
+		pLength = pHead->standardProfileLength;
+
+	return (pLength[2] << 16) + (pLength[1] << 8) + pLength[0];
+}
+
+/**
+  ******************************************************************************
+  * @brief   logbook_openStandardProfile. /  opens a profile for logbook_readStandardProfile()
+  ******************************************************************************
+	*
+  * @param  StepBackwards: 0 Last lokbook entry, 1 second to last entry, etc.
+  * @param  pHead: header of the dive
+  * @return length of the profile in standard samples
+  */
+uint32_t logbook_openStandardProfile(uint8_t StepBackwards, const SLogbookHeader* pHead)
+{
+	uint32_t totalNumberOfBytes = 0;
+
+	ext_flash_open_read_sample(StepBackwards, &totalNumberOfBytes);
+	readEncoding = PROFILE_ENCODING_STANDARD;
+
+	if(pHead->profileEncoding == PROFILE_ENCODING_COMPACT)
+	{
+		logbook_startCompactRead(pHead);
+		totalNumberOfBytes = logbook_getStandardProfileLength(pHead);
+	}
+	return totalNumberOfBytes;
+}
+
+/* reads the next bytes of the opened profile in the standard sample format, compact samples are decoded on the fly */
+void logbook_readStandardProfile(uint8_t* pTarget, uint16_t length)
+{
+	uint16_t part;
+
+	if(readEncoding != PROFILE_ENCODING_COMPACT)
+	{
+		ext_flash_read_next_sample_part(pTarget, length);
+		return;
+	}
+
+	while(length)
+	{
+		if(compactRead.sampleIndex == compactRead.sampleLength)
+		{
+			if(compactRead.end)
+			{
+				memset(pTarget, 0xFF, length);
+				return;
+			}
+			logbook_decodeCompactSample(&compactRead);
+			compactRead.sampleIndex = 0;
+		}
+		part = compactRead.sampleLength - compactRead.sampleIndex;
+		if(part > length)
+			part = length;
+		memcpy(pTarget, &compactRead.sample[compactRead.sampleIndex], part);
+		compactRead.sampleIndex += part;
+		pTarget += part;
+		length -= part;
+	}
+}
+
 /**
   ******************************************************************************
   * @brief   logbook_writeSample. /  Writes one logbook sampl
@@ -396,9 +545,12 @@ void logbook_writeSample(const SDiveState *state)
 		uint8_t	nextstopLengthMinutes = 0;
     bit8_Type eventByte1, eventByte2;
     bit8_Type profileByteFlag;
+    SSampleLayout layout;
+    uint8_t compactSample[256];
     int i = 0;
     for(i = 0; i <256 ;i++)
             sample[i] = 0;
+    memset(&layout, 0, sizeof(layout));
     addU16(sample, (uint16_t)(state->lifeData.depth_meter * 100));
     length += 2;
     sample[2] = 0;
@@ -525,10 +677,12 @@ void logbook_writeSample(const SDiveState *state)
         sample[length++] = *pdata++;
         sample[length++] = *pdata++;
     }
+    layout.eventEnd = length;
 
     if(divisor.temperature == 0)
     {
 			divisor.temperature = smallHeader.tempDivisor - 1;
+			layout.temperature = length;
 			addS16(&sample[length], (int16_t)((state->lifeData.temperature_celsius * 10.0f) + 0.5f));
 			length += 2;
     }
@@ -586,6 +740,7 @@ void logbook_writeSample(const SDiveState *state)
 					sample[length] = 0;
 					length += 1;
 				}
+				layout.decoNdl = length - 2;
       }
       else
       {
@@ -599,6 +754,7 @@ void logbook_writeSample(const SDiveState *state)
       if(divisor.ppo2 == 0)
       {
           divisor.ppo2 = smallHeader.ppo2Divisor - 1;
+          layout.ppo2 = length;
 
         for(int i = 0; i <3; i++)
         {
@@ -620,6 +776,7 @@ void logbook_writeSample(const SDiveState *state)
       if(divisor.decoplan == 0)
       {
           divisor.decoplan  = smallHeader.decoplanDivisor - 1;
+          layout.decoplan = length;
           if(state->diveSettings.deco_type.ub.standard == VPM_MODE)
           {
             for(int i = 0; i <15; i++)
@@ -655,6 +812,7 @@ void logbook_writeSample(const SDiveState *state)
     if(divisor.cns == 0)
     {
         divisor.cns = smallHeader.cnsDivisor - 1;
+        layout.cns = length;
         addU16(&sample[length], (uint16_t)state->lifeData.cns);
         length += 2;
     }
@@ -669,6 +827,7 @@ void logbook_writeSample(const SDiveState *state)
       if(divisor.tank == 0)
       {
           divisor.tank = smallHeader.tankDivisor - 1;
+          layout.tank = length;
   		  addS16(&sample[length], ((state->lifeData.bottle_bar[state->lifeData.actualGas.GasIdInSettings])));
   		  length += smallHeader.tankLength;
       }
@@ -685,7 +844,17 @@ void logbook_writeSample(const SDiveState *state)
         profileByteFlag.ub.bit7 = 1;
     }
     sample[2] = profileByteFlag.uw;
-    logbook_writedata((void *) sample,length);
+    standardProfileLength += length;
+
+    if(gheader.profileEncoding == PROFILE_ENCODING_COMPACT)
+    {
+        length = compact_encodeSample(sample, &layout, &compactWrite, compactSample);
+        logbook_writedata((void *) compactSample,length);
+    }
+    else
+    {
+        logbook_writedata((void *) sample,length);
+    }
 
 }
 
@@ -748,12 +917,12 @@ static uint16_t readSample(int32_t* depth, int16_t * gasid, int16_t* setpoint_cb
   if(decostopDepth)
     *decostopDepth = -1;
 
-	ext_flash_read_next_sample_part( (uint8_t*)&temp, 2);
+	logbook_readStandardProfile( (uint8_t*)&temp, 2);
 	if(depth)
         *depth = (int32_t)temp;
 	bytesRead += 2;
 
-	ext_flash_read_next_sample_part( &profileByteFlag.uw, 1);
+	logbook_readStandardProfile( &profileByteFlag.uw, 1);
 	bytesRead ++;
 
 	bEvent = profileByteFlag.ub.bit7;
@@ -762,7 +931,7 @@ static uint16_t readSample(int32_t* depth, int16_t * gasid, int16_t* setpoint_cb
 
 	if(bEvent)
 	{
-			ext_flash_read_next_sample_part( &eventByte1.uw, 1);
+			logbook_readStandardProfile( &eventByte1.uw, 1);
 			bytesRead ++;
 
 			length--;
@@ -776,7 +945,7 @@ static uint16_t readSample(int32_t* depth, int16_t * gasid, int16_t* setpoint_cb
 			//second event byte
 			if(eventByte1.ub.bit7)
 			{
-				ext_flash_read_next_sample_part( &eventByte2.uw, 1);
+				logbook_readStandardProfile( &eventByte2.uw, 1);
 				bytesRead ++;
 				length--;
 			}
@@ -789,11 +958,11 @@ static uint16_t readSample(int32_t* depth, int16_t * gasid, int16_t* setpoint_cb
 			if( eventByte1.ub.bit4)
 			{
           //Evaluate manual Gas
-				ext_flash_read_next_sample_part( (uint8_t*)&tempU8, 1);
+				logbook_readStandardProfile( (uint8_t*)&tempU8, 1);
 				bytesRead +=1;
 				length -= 1;
 				manualGas->percentageO2 = tempU8;
-				ext_flash_read_next_sample_part( (uint8_t*)&tempU8, 1);
+				logbook_readStandardProfile( (uint8_t*)&tempU8, 1);
 				bytesRead +=1;
 				length -= 1;
 				manualGas->percentageHe = tempU8;
@@ -802,7 +971,7 @@ static uint16_t readSample(int32_t* depth, int16_t * gasid, int16_t* setpoint_cb
 			//gas change
 			if( eventByte1.ub.bit5)
 			{
-					ext_flash_read_next_sample_part( &tempU8, 1);
+					logbook_readStandardProfile( &tempU8, 1);
 					bytesRead +=1;
 					length -= 1;
 					if(gasid)
@@ -811,7 +980,7 @@ static uint16_t readSample(int32_t* depth, int16_t * gasid, int16_t* setpoint_cb
 			//SetpointChange
 			if( eventByte1.ub.bit6)
 			{
-					ext_flash_read_next_sample_part( &tempU8, 1);
+					logbook_readStandardProfile( &tempU8, 1);
 					*setpoint_cbar = tempU8;
 					bytesRead +=1;
 					length -= 1;
@@ -824,11 +993,11 @@ static uint16_t readSample(int32_t* depth, int16_t * gasid, int16_t* setpoint_cb
 				//evaluate bailout gas Gas
 				 *bailout = 1;
 
-				ext_flash_read_next_sample_part( (uint8_t*)&tempU8, 1);
+				logbook_readStandardProfile( (uint8_t*)&tempU8, 1);
 				bytesRead +=1;
 				length -= 1;
 				manualGas->percentageO2 = tempU8;
-				ext_flash_read_next_sample_part( (uint8_t*)&tempU8, 1);
+				logbook_readStandardProfile( (uint8_t*)&tempU8, 1);
 				bytesRead +=1;
 				length -= 1;
 				manualGas->percentageHe = tempU8;
@@ -842,7 +1011,7 @@ static uint16_t readSample(int32_t* depth, int16_t * gasid, int16_t* setpoint_cb
 				tempU32 = 0;
 				for(index = 0; index < 4; index++)
 				{
-					ext_flash_read_next_sample_part( (uint8_t*)&tempU8, 1);
+					logbook_readStandardProfile( (uint8_t*)&tempU8, 1);
 					bytesRead +=1;
 					length -= 1;
 					tempU32 |= (tempU8 << (index * 8));
@@ -854,7 +1023,7 @@ static uint16_t readSample(int32_t* depth, int16_t * gasid, int16_t* setpoint_cb
 				tempU32 = 0;
 				for(index = 0; index < 4; index++)
 				{
-					ext_flash_read_next_sample_part( (uint8_t*)&tempU8, 1);
+					logbook_readStandardProfile( (uint8_t*)&tempU8, 1);
 					bytesRead +=1;
 					length -= 1;
 					tempU32 |= (tempU8 << (index * 8));
@@ -869,7 +1038,7 @@ static uint16_t readSample(int32_t* depth, int16_t * gasid, int16_t* setpoint_cb
 	if(divisor.temperature == 0)
 	{
 			divisor.temperature = smallHeader.tempDivisor - 1;
-			ext_flash_read_next_sample_part( (uint8_t*)&temp, 2);
+			logbook_readStandardProfile( (uint8_t*)&temp, 2);
 			bytesRead +=2;
 			length -= 2;
 			if(temperature)
@@ -887,12 +1056,12 @@ static uint16_t readSample(int32_t* depth, int16_t * gasid, int16_t* setpoint_cb
     if(divisor.deco_ndl == 0)
     {
       divisor.deco_ndl = smallHeader.deco_ndlDivisor - 1;
-      ext_flash_read_next_sample_part( &tempU8, 1);
+      logbook_readStandardProfile( &tempU8, 1);
 			if(decostopDepth)
 			{
 				*decostopDepth = tempU8 * 100;
 			}
-      ext_flash_read_next_sample_part( &tempU8, 1);
+      logbook_readStandardProfile( &tempU8, 1);
       bytesRead += 2;
       length -= 2;
     }
@@ -908,11 +1077,11 @@ static uint16_t readSample(int32_t* depth, int16_t * gasid, int16_t* setpoint_cb
 			divisor.ppo2 = smallHeader.ppo2Divisor -1;
 			for(int i = 0; i <3 ; i++)
       {
-        ext_flash_read_next_sample_part( &tempU8, 1);
+        logbook_readStandardProfile( &tempU8, 1);
         ppO2Tmp += tempU8;
         bytesRead +=1;
         length -= 1;
-        ext_flash_read_next_sample_part( (uint8_t*)&temp, 2);
+        logbook_readStandardProfile( (uint8_t*)&temp, 2);
         bytesRead +=2;
         length -= 2;
 				if(sensor1 && (i==0))
@@ -934,7 +1103,7 @@ static uint16_t readSample(int32_t* depth, int16_t * gasid, int16_t* setpoint_cb
     {
       divisor.decoplan = smallHeader.decoplanDivisor - 1;
       for(int i = 0; i <15; i++)
-        ext_flash_read_next_sample_part( &tempU8, 1);
+        logbook_readStandardProfile( &tempU8, 1);
       bytesRead += 15;
       length -= 15;
     }
@@ -950,7 +1119,7 @@ static uint16_t readSample(int32_t* depth, int16_t * gasid, int16_t* setpoint_cb
 	{
 			 divisor.cns = smallHeader.cnsDivisor - 1;
 
-      ext_flash_read_next_sample_part( (uint8_t*)&temp, 2);
+      logbook_readStandardProfile( (uint8_t*)&temp, 2);
 			bytesRead +=2;
 			length -= 2;
 			if(cns)
@@ -968,7 +1137,7 @@ static uint16_t readSample(int32_t* depth, int16_t * gasid, int16_t* setpoint_cb
 		if(divisor.tank == 0)
 		{
 				divisor.tank = smallHeader.tankDivisor - 1;
-				ext_flash_read_next_sample_part( (uint8_t*)&temp, 2);
+				logbook_readStandardProfile( (uint8_t*)&temp, 2);
 				bytesRead +=2;
 				length -= 2;
 				if(tank)
@@ -1107,8 +1276,8 @@ uint16_t logbook_readSampleData(uint8_t StepBackwards, uint16_t length,uint16_t*
 		//uint16_t* ppo2, uint16_t* cns#
     uint32_t totalNumberOfBytes = 0;
     uint32_t bytesRead = 0;
-    ext_flash_open_read_sample( StepBackwards,&totalNumberOfBytes);
-    ext_flash_read_next_sample_part((uint8_t*)&smallHeader,  sizeof(SSmallHeader));
+    totalNumberOfBytes = logbook_openStandardProfile(StepBackwards, &header);
+    logbook_readStandardProfile((uint8_t*)&smallHeader,  sizeof(SSmallHeader));
     bytesRead += sizeof(SSmallHeader);
 
     clear_divisor();
@@ -1125,6 +1294,7 @@ uint16_t logbook_readSampleData(uint8_t StepBackwards, uint16_t length,uint16_t*
 		{
 				ext_flash_set_entry_point();
 				divisorBackup = divisor;
+				compactReadBackup = compactRead;
 				retVal = readSample(&depthVal,&gasidVal, &setPointVal, &temperatureVal, &sensor1Val, &sensor2Val, &sensor3Val, &cnsVal, &manualGasVal,
 									&bailoutVal, &decostepDepthVal, &tankVal, &posCoord, &eventdata);
 
@@ -1133,6 +1303,7 @@ uint16_t logbook_readSampleData(uint8_t StepBackwards, uint16_t length,uint16_t*
 						//Error try to read again!!!
 						ext_flash_reopen_read_sample_at_entry_point();
 						divisor = divisorBackup;
+						compactRead = compactReadBackup;
 						retVal = readSample(&depthVal,&gasidVal,&setPointVal, &temperatureVal, &sensor1Val, &sensor2Val, &sensor3Val, &cnsVal,
 											&manualGasVal, &bailoutVal, &decostepDepthVal, &tankVal, &posCoord, &eventdata);
 
@@ -1340,6 +1511,10 @@ void logbook_InitAndWrite(SDiveState *pStateReal)
 		{
 			//Write logbook sample
 			logbook_writeSample(pStateReal);
+			if(pStateReal->warnings.lowBattery)
+			{
+				ext_flash_flush_sample_cache();		/* do not keep samples in RAM if power may fail */
+			}
 			resetEvents(pStateReal);
 			if(min_temperature_float_celsius > pStateReal->lifeData.temperature_celsius)
 				min_temperature_float_celsius = pStateReal->lifeData.temperature_celsius;
@@ -1633,6 +1808,10 @@ SLogbookHeaderOSTC3 * logbook_build_ostc3header(SLogbookHeader* pHead)
 				data2.u32bit = sampleProfileStart + dummyLength;	/* calc new end address (which is equal to dummyLength) */
 				data.u32bit = dummyLength;				    /* data is used below to represent the length */
 			}
+			else if(pHead->profileEncoding == PROFILE_ENCODING_COMPACT)
+			{
+				data.u32bit = logbook_getStandardProfileLength(pHead);	/* the download provides standard samples */
+			}
 
 			data.u32bit += 3;
 			headerOSTC3.profileLength[0] = data.u8bit.byteLow;
@@ -1808,6 +1987,10 @@ SLogbookHeaderOSTC3compact * logbook_build_ostc3header_compact(SLogbookHeader* p
 				data2.u32bit = sampleProfileStart + dummyLength;	/* calc new end address (which is equal to dummyLength) */
 				data.u32bit = dummyLength;				   			/* data is used below to represent the length */
 			}
+			else if(pHead->profileEncoding == PROFILE_ENCODING_COMPACT)
+			{
+				data.u32bit = logbook_getStandardProfileLength(pHead);
+			}
 			data.u32bit += 3;
 			headerOSTC3compact.profileLength[0] = data.u8bit.byteLow;
 			headerOSTC3compact.profileLength[1] = data.u8bit.byteMidLow;
@@ -1874,12 +2057,19 @@ void logbook_recover_brokenlog(uint8_t headerId)
 	uint16_t tankVal = 0;
 	uint8_t eventdata;
 	SGnssCoord posCoord;
+	SLogbookHeader header;
 
 		//uint16_t* ppo2, uint16_t* cns#
      uint32_t bytesRead = 0;
 
-    ext_flash_read_block_start();
-    ext_flash_read_next_sample_part((uint8_t*)&smallHeader,  sizeof(SSmallHeader));
+    ext_flash_set_entry_point();	/* the caller points to the begin of the profile */
+    ext_flash_read_dive_header2((uint8_t*) &header, headerId, false);
+    ext_flash_reopen_read_sample_at_entry_point();
+
+    readEncoding = PROFILE_ENCODING_STANDARD;
+    if(header.profileEncoding == PROFILE_ENCODING_COMPACT)
+        logbook_startCompactRead(&header);
+    logbook_readStandardProfile((uint8_t*)&smallHeader,  sizeof(SSmallHeader));
     bytesRead += sizeof(SSmallHeader);
 
     clear_divisor();
@@ -1893,6 +2083,7 @@ void logbook_recover_brokenlog(uint8_t headerId)
 
         ext_flash_set_entry_point();
         divisorBackup = divisor;
+        compactReadBackup = compactRead;
 		retVal = readSample(&depthVal,&gasidVal, &setPointVal, &temperatureVal, &sensor1Val, &sensor2Val, &sensor3Val, &cnsVal, &manualGasVal,
 							&bailoutVal, &decostepDepthVal,&tankVal, &posCoord, &eventdata);
         if(retVal == 0)
@@ -1900,6 +2091,7 @@ void logbook_recover_brokenlog(uint8_t headerId)
           //Error try to read again!!!
           ext_flash_reopen_read_sample_at_entry_point();
           divisor = divisorBackup;
+          compactRead = compactReadBackup;
 		  retVal = readSample(&depthVal,&gasidVal, &setPointVal, &temperatureVal, &sensor1Val, &sensor2Val, &sensor3Val, &cnsVal, &manualGasVal,
 								&bailoutVal, &decostepDepthVal, &tankVal, &posCoord, &eventdata);
           if(retVal == 0)
@@ -1907,6 +2099,7 @@ void logbook_recover_brokenlog(uint8_t headerId)
               //Error try to read again!!!
               ext_flash_reopen_read_sample_at_entry_point();
               divisor = divisorBackup;
+              compactRead = compactReadBackup;
 			  retVal = readSample(&depthVal,&gasidVal, &setPointVal, &temperatureVal, &sensor1Val, &sensor2Val, &sensor3Val, &cnsVal, &manualGasVal,
 				 				&bailoutVal, &decostepDepthVal,&tankVal, &posCoord, &eventdata);
               if(retVal == 0)
@@ -1925,9 +2118,10 @@ void logbook_recover_brokenlog(uint8_t headerId)
     }
     avrdepth/= sampleCounter;
     ext_flash_close_read_sample();
-    SLogbookHeader header;
 
     ext_flash_read_dive_header2((uint8_t*) &header, headerId, false);
+    if(header.profileEncoding == PROFILE_ENCODING_COMPACT)
+        logbook_setStandardProfileLength(&header, bytesRead + 2);
     header.total_diveTime_seconds = sampleCounter * header.samplingRate;
     header.diveTimeMinutes = header.total_diveTime_seconds /60;
     header.diveTimeSeconds = header.total_diveTime_seconds - header.diveTimeMinutes * 60;
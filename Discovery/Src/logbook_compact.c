@@ -0,0 +1,296 @@
+/**
+  ******************************************************************************
+  * @file   		logbook_compact.c
+  * @author 		heinrichs weikamp gmbh
+  * @date   		17-Oct-2026
+  * @version		V0.0.1
+  * @since			17-Oct-2026
+  * @brief			compact (delta / varint) encoding of the logbook samples
+	*							The flash access stays in logbook.c, the decoder reads through
+	*							a callback so HostSim/logbook_image can use it for dumps.
+	* @bug
+	* @warning
+  ******************************************************************************
+  */
+
+/* Includes ------------------------------------------------------------------*/
+#include <string.h>
+#include "logbook_compact.h"
+
+/* Private functions ---------------------------------------------------------*/
+
+static uint16_t getU16(const uint8_t *pos)
+{
+	return pos[0] | (pos[1] << 8);
+}
+
+static void addU16(uint8_t *pos, uint16_t var)
+{
+	pos[0] = var & 0xFF;
+	pos[1] = var >> 8;
+}
+
+/* adds a zig-zag varint, returns the number of bytes used */
+static uint8_t addVarint(uint8_t *pos, int32_t delta)
+{
+	uint32_t value = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+	uint8_t length = 0;
+
+	while(value >= 0x80)
+	{
+		pos[length++] = (uint8_t)(value | 0x80);
+		value >>= 7;
+	}
+	pos[length++] = (uint8_t)value;
+	return length;
+}
+
+static int32_t readVarint(CompactReadFunc pRead, void *pContext)
+{
+	uint32_t value = 0;
+	uint8_t shift = 0;
+	uint8_t data;
+
+	do
+	{
+		pRead(pContext, &data, 1);
+		value |= (uint32_t)(data & 0x7F) << shift;
+		shift += 7;
+	} while((data & 0x80) && (shift < 35));
+
+	return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static uint8_t addDelta(uint8_t *pos, int32_t value, int32_t *pLast)
+{
+	int32_t delta = value - *pLast;
+
+	*pLast = value;
+	return addVarint(pos, delta);
+}
+
+/* Exported functions --------------------------------------------------------*/
+
+void compact_setDivisor(SDivisor *pDivisor, const SSmallHeader *pSmallHeader)
+{
+	pDivisor->cns = pSmallHeader->cnsDivisor - 1;
+	pDivisor->decoplan = pSmallHeader->decoplanDivisor - 1;
+	pDivisor->deco_ndl = pSmallHeader->deco_ndlDivisor - 1;
+	pDivisor->gradientFactor = pSmallHeader->gfDivisor - 1;
+	pDivisor->ppo2 = pSmallHeader->ppo2Divisor - 1;
+	pDivisor->tank = pSmallHeader->tankDivisor - 1;
+	pDivisor->temperature = pSmallHeader->tempDivisor - 1;
+}
+
+/* the fields due at the next sample, same order of divisors as in logbook_writeSample() */
+uint8_t compact_nextSampleFields(SDivisor *pDivisor, const SSmallHeader *pSmallHeader)
+{
+	uint8_t fields = SAMPLE_TEMPERATURE | SAMPLE_DECO_NDL | SAMPLE_PPO2 | SAMPLE_DECOPLAN | SAMPLE_CNS | SAMPLE_TANK;
+
+	if(pDivisor->temperature == 0)
+		pDivisor->temperature = pSmallHeader->tempDivisor - 1;
+	else
+	{
+		pDivisor->temperature--;
+		fields &= ~SAMPLE_TEMPERATURE;
+	}
+
+	if(pSmallHeader->deco_ndlDivisor && (pDivisor->deco_ndl == 0))
+		pDivisor->deco_ndl = pSmallHeader->deco_ndlDivisor - 1;
+	else
+	{
+		if(pSmallHeader->deco_ndlDivisor)
+			pDivisor->deco_ndl--;
+		fields &= ~SAMPLE_DECO_NDL;
+	}
+
+	if(pSmallHeader->ppo2Divisor && (pDivisor->ppo2 == 0))
+		pDivisor->ppo2 = pSmallHeader->ppo2Divisor - 1;
+	else
+	{
+		if(pSmallHeader->ppo2Divisor)
+			pDivisor->ppo2--;
+		fields &= ~SAMPLE_PPO2;
+	}
+
+	if(pSmallHeader->decoplanDivisor && (pDivisor->decoplan == 0))
+		pDivisor->decoplan = pSmallHeader->decoplanDivisor - 1;
+	else
+	{
+		if(pSmallHeader->decoplanDivisor)
+			pDivisor->decoplan--;
+		fields &= ~SAMPLE_DECOPLAN;
+	}
+
+	if(pDivisor->cns == 0)
+		pDivisor->cns = pSmallHeader->cnsDivisor - 1;
+	else
+	{
+		pDivisor->cns--;
+		fields &= ~SAMPLE_CNS;
+	}
+
+	if(pSmallHeader->tankDivisor && (pDivisor->tank == 0))
+		pDivisor->tank = pSmallHeader->tankDivisor - 1;
+	else
+	{
+		if(pSmallHeader->tankDivisor)
+			pDivisor->tank--;
+		fields &= ~SAMPLE_TANK;
+	}
+	return fields;
+}
+
+/**
+  ******************************************************************************
+  * @brief   compact_encodeSample. /  converts a standard sample into the compact encoding
+  ******************************************************************************
+	*
+  * @param  pSample: standard sample as built by logbook_writeSample()
+  * @param  pLayout: position of the fields within pSample
+  * @param  pLast: previous values, updated
+  * @param  pCompact: Output compact sample
+  * @return length of the compact sample
+  */
+uint16_t compact_encodeSample(const uint8_t *pSample, const SSampleLayout *pLayout, SCompactState *pLast, uint8_t *pCompact)
+{
+	uint16_t length = 1;
+	uint8_t control = 0;
+	uint8_t eventLength;
+	const uint8_t *pos;
+
+	length += addDelta(&pCompact[length], getU16(&pSample[0]), &pLast->depth);
+
+	eventLength = pLayout->eventEnd - 3;
+	if(eventLength)
+	{
+		control |= COMPACT_EVENT;
+		pCompact[length++] = eventLength;
+		memcpy(&pCompact[length], &pSample[3], eventLength);
+		length += eventLength;
+	}
+
+	if(pLayout->temperature)
+		length += addDelta(&pCompact[length], (int16_t)getU16(&pSample[pLayout->temperature]), &pLast->temperature);
+
+	if(pLayout->decoNdl && memcmp(&pSample[pLayout->decoNdl], pLast->decoNdl, 2))
+	{
+		control |= COMPACT_DECO_NDL;
+		memcpy(pLast->decoNdl, &pSample[pLayout->decoNdl], 2);
+		memcpy(&pCompact[length], pLast->decoNdl, 2);
+		length += 2;
+	}
+
+	if(pLayout->ppo2)
+	{
+		for(int i = 0; i < 3; i++)
+		{
+			pos = &pSample[pLayout->ppo2 + (i * 3)];
+			length += addDelta(&pCompact[length], pos[0], &pLast->ppo2[i]);
+			length += addDelta(&pCompact[length], getU16(&pos[1]), &pLast->voltage[i]);
+		}
+	}
+
+	if(pLayout->decoplan && memcmp(&pSample[pLayout->decoplan], pLast->decoplan, 15))
+	{
+		control |= COMPACT_DECOPLAN;
+		memcpy(pLast->decoplan, &pSample[pLayout->decoplan], 15);
+		memcpy(&pCompact[length], pLast->decoplan, 15);
+		length += 15;
+	}
+
+	if(pLayout->cns)
+		length += addDelta(&pCompact[length], getU16(&pSample[pLayout->cns]), &pLast->cns);
+
+	if(pLayout->tank)
+		length += addDelta(&pCompact[length], (int16_t)getU16(&pSample[pLayout->tank]), &pLast->tank);
+
+	pCompact[0] = control;
+	return length;
+}
+
+/**
+  ******************************************************************************
+  * @brief   compact_decodeSample. /  rebuilds the standard sample from a compact one
+  ******************************************************************************
+	*
+  * @note   the caller reads the control byte and handles COMPACT_END_MARKER
+  * @param  control: control byte of the sample
+  * @param  fields: fields due at this sample, see compact_nextSampleFields()
+  * @param  pSmallHeader: header of the profile
+  * @param  pLast: previous values, updated
+  * @param  pRead: reads the bytes following the control byte
+  * @param  pContext: passed to pRead
+  * @param  pSample: Output standard sample, COMPACT_SAMPLE_SIZE bytes
+  * @return length of the standard sample, 0 if the sample is broken (e.g. erased flash)
+  */
+uint16_t compact_decodeSample(uint8_t control, uint8_t fields, const SSmallHeader *pSmallHeader, SCompactState *pLast,
+							  CompactReadFunc pRead, void *pContext, uint8_t *pSample)
+{
+	uint16_t length = 3;
+	uint8_t eventLength = 0;
+
+	if(control & ~COMPACT_CONTROL_MASK)
+		return 0;
+
+	pLast->depth += readVarint(pRead, pContext);
+	addU16(&pSample[0], (uint16_t)pLast->depth);
+
+	if(control & COMPACT_EVENT)
+	{
+		pRead(pContext, &eventLength, 1);
+		if(eventLength > COMPACT_SAMPLE_SIZE - 3 - COMPACT_MAX_FIELDS)
+			return 0;
+		pRead(pContext, &pSample[length], eventLength);
+		length += eventLength;
+	}
+
+	if(fields & SAMPLE_TEMPERATURE)
+	{
+		pLast->temperature += readVarint(pRead, pContext);
+		addU16(&pSample[length], (uint16_t)pLast->temperature);
+		length += 2;
+	}
+	if(fields & SAMPLE_DECO_NDL)
+	{
+		if(control & COMPACT_DECO_NDL)
+			pRead(pContext, pLast->decoNdl, 2);
+		memcpy(&pSample[length], pLast->decoNdl, 2);
+		length += 2;
+	}
+	if(fields & SAMPLE_PPO2)
+	{
+		for(int i = 0; i < 3; i++)
+		{
+			pLast->ppo2[i] += readVarint(pRead, pContext);
+			pSample[length++] = (uint8_t)pLast->ppo2[i];
+			pLast->voltage[i] += readVarint(pRead, pContext);
+			addU16(&pSample[length], (uint16_t)pLast->voltage[i]);
+			length += 2;
+		}
+	}
+	if(fields & SAMPLE_DECOPLAN)
+	{
+		if(control & COMPACT_DECOPLAN)
+			pRead(pContext, pLast->decoplan, 15);
+		memcpy(&pSample[length], pLast->decoplan, 15);
+		length += 15;
+	}
+	if(fields & SAMPLE_CNS)
+	{
+		pLast->cns += readVarint(pRead, pContext);
+		addU16(&pSample[length], (uint16_t)pLast->cns);
+		length += 2;
+	}
+	if(fields & SAMPLE_TANK)
+	{
+		pLast->tank += readVarint(pRead, pContext);
+		addU16(&pSample[length], (uint16_t)pLast->tank);
+		length += pSmallHeader->tankLength;
+	}
+
+	pSample[2] = length - 3;
+	if(eventLength)
+		pSample[2] |= 0x80;
+	return length;
+}
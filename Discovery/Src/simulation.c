@@ -499,17 +499,22 @@ static void sim_reduce_deco_time_one_second(SDiveState* pDiveState)
     }
 }
 
-SDecoinfo* simulation_decoplaner(uint16_t depth_meter, uint16_t intervall_time_minutes, uint16_t dive_time_minutes, uint8_t *gasChangeListDepthGas20x2)
+/**
+  ******************************************************************************
+  * @brief  prepares stateSim for a planned dive
+  ******************************************************************************
+  * @note   diveSettings have to be copied to stateSim before (copyDiveSettingsToSim())
+  * @param  intervall_time_minutes : surface intervall on air before the dive
+  * @param  gasChangeListDepthGas20x2 : list of gas changes, may be NULL
+  * @return next free position in gasChangeListDepthGas20x2
+  */
+static uint8_t simulation_plan_start(uint16_t intervall_time_minutes, uint8_t *gasChangeListDepthGas20x2)
 {
     uint8_t ptrGasChangeList = 0; // new hw 160704
 #ifdef ENABLE_DECOCALC_OPTION
     uint8_t index = 0;
 #endif
-    for (int i = 0; i < 40; i++)
-    	gasChangeListDepthGas20x2[i] = 0;
-
     SDiveState * pDiveState = &stateSim;
-    copyDiveSettingsToSim();
 
 #ifdef ENABLE_DECOCALC_OPTION
     /* activate deco calculation for all deco gases */
@@ -545,11 +550,23 @@ SDecoinfo* simulation_decoplaner(uint16_t depth_meter, uint16_t intervall_time_m
         gasChangeListDepthGas20x2[ptrGasChangeList++] = pDiveState->lifeData.actualGas.GasIdInSettings;
         gasChangeListDepthGas20x2[0] =0; // depth zero
     }
+    return ptrGasChangeList;
+}
 
-    //Going down / descent
-    simulation_set_aim_depth(depth_meter);
-    sim_aim_time_minutes = 0;
-    for(int i = 0; i < 60 * dive_time_minutes; i++)
+/**
+  ******************************************************************************
+  * @brief  continues the planned dive towards aim depth, including switches to better gases
+  ******************************************************************************
+  * @param  seconds : dive time to add
+  * @param  gasChangeListDepthGas20x2 : list of gas changes, may be NULL
+  * @param  ptrGasChangeList : next free position in gasChangeListDepthGas20x2
+  * @return next free position in gasChangeListDepthGas20x2
+  */
+static uint8_t simulation_plan_bottom(uint32_t seconds, uint8_t *gasChangeListDepthGas20x2, uint8_t ptrGasChangeList)
+{
+    SDiveState * pDiveState = &stateSim;
+
+    for(uint32_t i = 0; i < seconds; i++)
     {
         simulation_UpdateLifeData(0);
         check_warning2(pDiveState);
@@ -563,6 +580,20 @@ SDecoinfo* simulation_decoplaner(uint16_t depth_meter, uint16_t intervall_time_m
             }
         }
     }
+    return ptrGasChangeList;
+}
+
+/**
+  ******************************************************************************
+  * @brief  creates the deco gas list and completes the list of gas changes with the ascent gases
+  ******************************************************************************
+  * @param  gasChangeListDepthGas20x2 : list of gas changes, may be NULL
+  * @param  ptrGasChangeList : next free position in gasChangeListDepthGas20x2
+  * @return void
+  */
+static void simulation_plan_ascent_gases(uint8_t *gasChangeListDepthGas20x2, uint8_t ptrGasChangeList)
+{
+    SDiveState * pDiveState = &stateSim;
 
     decom_CreateGasChangeList(&pDiveState->diveSettings, &pDiveState->lifeData); // was there before and needed for buehlmann_calc_deco and vpm_calc
 
@@ -587,6 +618,26 @@ SDecoinfo* simulation_decoplaner(uint16_t depth_meter, uint16_t intervall_time_m
         }
         gasChangeListDepthGas20x2[0] = 0;
     }
+}
+
+SDecoinfo* simulation_decoplaner(uint16_t depth_meter, uint16_t intervall_time_minutes, uint16_t dive_time_minutes, uint8_t *gasChangeListDepthGas20x2)
+{
+    uint8_t ptrGasChangeList = 0; // new hw 160704
+
+    for (int i = 0; i < 40; i++)
+    	gasChangeListDepthGas20x2[i] = 0;
+
+    SDiveState * pDiveState = &stateSim;
+    copyDiveSettingsToSim();
+
+    ptrGasChangeList = simulation_plan_start(intervall_time_minutes, gasChangeListDepthGas20x2);
+
+    //Going down / descent
+    simulation_set_aim_depth(depth_meter);
+    sim_aim_time_minutes = 0;
+    ptrGasChangeList = simulation_plan_bottom(60 * dive_time_minutes, gasChangeListDepthGas20x2, ptrGasChangeList);
+
+    simulation_plan_ascent_gases(gasChangeListDepthGas20x2, ptrGasChangeList);
 
     // deco and ascend calc
     if(pDiveState->diveSettings.deco_type.ub.standard == GF_MODE)
@@ -610,6 +661,178 @@ SDecoinfo* simulation_decoplaner(uint16_t depth_meter, uint16_t intervall_time_m
     }
 }
 
+/* cells which share the dive up to their bottom time */
+static _Bool simulation_sweep_same_prefix(const SSimPlanCell *pCellA, const SSimPlanCell *pCellB)
+{
+    return (pCellA->depthMeter == pCellB->depthMeter)
+    		&& (pCellA->intervallTimeMinutes == pCellB->intervallTimeMinutes)
+			&& (pCellA->gasMask == pCellB->gasMask);
+}
+
+/* the crushing pressures depend on the VPM conservatism, Buehlmann cells join every group */
+static _Bool simulation_sweep_is_member(const SSimPlanCell *pLeader, const SSimPlanCell *pCell, uint8_t vpmConservatism)
+{
+    return (!pCell->valid)
+    		&& simulation_sweep_same_prefix(pLeader, pCell)
+			&& ((pCell->decoModel != VPM_MODE) || (pCell->vpmConservatism == vpmConservatism));
+}
+
+/**
+  ******************************************************************************
+  * @brief  deco, gas consumption and summary of one sweep cell at the end of its bottom time
+  ******************************************************************************
+  * @note   lifeData and vpm of stateSim are the common prefix and are left unchanged
+  * @param  pCell : cell to calculate
+  * @param  pVpmPrefix : vpm of stateSim at the end of the bottom time
+  * @param  gasChangeListPrefix : gas changes up to the end of the bottom time
+  * @param  ptrGasChangeList : next free position in gasChangeListPrefix
+  * @return void
+  */
+static void simulation_sweep_calc_cell(SSimPlanCell *pCell, const SVpm *pVpmPrefix, const uint8_t *gasChangeListPrefix, uint8_t ptrGasChangeList, uint8_t gasConsumTravelInput, uint8_t gasConsumDecoInput)
+{
+    SDiveState * pDiveState = &stateSim;
+    uint8_t gasChangeListDepthGas20x2[40];
+
+    memcpy(gasChangeListDepthGas20x2, gasChangeListPrefix, sizeof(gasChangeListDepthGas20x2));
+
+    pDiveState->diveSettings.deco_type.ub.standard = pCell->decoModel;
+    pDiveState->diveSettings.gf_low = pCell->gfLow;
+    pDiveState->diveSettings.gf_high = pCell->gfHigh;
+    pDiveState->diveSettings.internal__pressure_first_stop_ambient_bar_as_upper_limit_for_gf_low_otherwise_zero = 0;
+    simulation_plan_ascent_gases(gasChangeListDepthGas20x2, ptrGasChangeList);
+
+    if(pCell->decoModel == GF_MODE)
+    {
+        buehlmann_calc_deco(&pDiveState->lifeData,&pDiveState->diveSettings,&pCell->decoInfo);
+        pCell->cns = pDiveState->lifeData.cns + buehlmann_get_gCNS();
+    }
+    else
+    {
+        /* vpm.c calculates the NDL only if its previous call ended in NDL, which may have been another cell */
+        if((vpm_calc(&pDiveState->lifeData,&pDiveState->diveSettings,&pDiveState->vpm,&pCell->decoInfo, DECOSTOPS) == CALC_NDL)
+        	&& (pCell->decoInfo.output_ndl_seconds == 0) && (pCell->decoInfo.output_time_to_surface_seconds == 0)
+			&& (pDiveState->lifeData.dive_time_seconds_without_surface_time >= 60))
+        {
+            memcpy(&pDiveState->vpm, pVpmPrefix, sizeof(SVpm));
+            vpm_calc(&pDiveState->lifeData,&pDiveState->diveSettings,&pDiveState->vpm,&pCell->decoInfo, DECOSTOPS);
+        }
+        pCell->cns = pDiveState->lifeData.cns + vpm_get_CNS();
+        memcpy(&pDiveState->vpm, pVpmPrefix, sizeof(SVpm));
+    }
+
+    simulation_gas_consumption(pCell->gasConsumption, pCell->depthMeter, pCell->diveTimeMinutes, &pCell->decoInfo, gasConsumTravelInput, gasConsumDecoInput, gasChangeListDepthGas20x2);
+    simulation_helper_change_points(&pCell->summary, pCell->depthMeter, pCell->diveTimeMinutes, &pCell->decoInfo, gasChangeListDepthGas20x2);
+    pCell->valid = 1;
+}
+
+/**
+  ******************************************************************************
+  * @brief  plans a grid of dives, e.g. for a deco table card
+  ******************************************************************************
+  * @note   cells with the same depth, intervall and gas mask form one group. The
+  *         dive of a group is simulated once, up to the longest bottom time, and
+  *         every cell is calculated when the dive passes its bottom time. Buehlmann
+  *         cells share the group with the VPM cells of one conservatism, other VPM
+  *         conservatisms start a new group as the crushing pressures differ.
+  *         The results equal those of simulation_decoplaner() for each cell,
+  *         checked by HostSim/planner_check. The dive settings of stateSim are
+  *         restored at the end.
+  * @param  pCell : cells to plan, input part set by caller
+  * @param  cellCount : number of cells
+  * @param  gasConsumTravelInput: how many l/min for all but deco stops
+  * @param  gasConsumDecoInput: how many l/min for deco stops only
+  * @return number of calculated cells
+  */
+uint16_t simulation_decoplaner_sweep(SSimPlanCell *pCell, uint16_t cellCount, uint8_t gasConsumTravelInput, uint8_t gasConsumDecoInput)
+{
+    static SVpm vpmPrefix;	/* too large for the stack */
+    static SDiveSettings diveSettingsSaved;
+    SDiveState * pDiveState = &stateSim;
+    uint8_t gasChangeListPrefix[40];
+    uint8_t ptrGasChangeList = 0;
+    uint8_t vpmConservatism = 0;
+    uint16_t leader = 0;
+    uint16_t index = 0;
+    uint16_t diveTimeMinutes = 0;
+    uint16_t nextDiveTimeMinutes = 0;
+    uint16_t cellsDone = 0;
+    _Bool pending = 0;
+
+    memcpy(&diveSettingsSaved, &pDiveState->diveSettings, sizeof(SDiveSettings));
+    for(index = 0; index < cellCount; index++)
+        pCell[index].valid = 0;
+
+    for(leader = 0; leader < cellCount; leader++)
+    {
+        if(pCell[leader].valid)
+            continue;
+
+        copyDiveSettingsToSim();
+
+        vpmConservatism = pDiveState->diveSettings.vpm_conservatism;
+        for(index = leader; index < cellCount; index++)
+        {
+            if((!pCell[index].valid) && (pCell[index].decoModel == VPM_MODE) && simulation_sweep_same_prefix(&pCell[leader], &pCell[index]))
+            {
+                vpmConservatism = pCell[index].vpmConservatism;
+                break;
+            }
+        }
+        pDiveState->diveSettings.vpm_conservatism = vpmConservatism;
+        pDiveState->diveSettings.vpm_tableMode = 0;		/* table mode follows one dive over time */
+        if(pCell[leader].gasMask)
+        {
+            for(index = 1; index < 1 + (2*NUM_GASES); index++)
+            {
+                if(!(pCell[leader].gasMask & (1 << index)))
+                {
+                    pDiveState->diveSettings.gas[index].note.ub.active = 0;
+                }
+            }
+        }
+
+        memset(gasChangeListPrefix, 0, sizeof(gasChangeListPrefix));
+        ptrGasChangeList = simulation_plan_start(pCell[leader].intervallTimeMinutes, gasChangeListPrefix);
+        simulation_set_aim_depth(pCell[leader].depthMeter);
+        sim_aim_time_minutes = 0;
+        diveTimeMinutes = 0;
+
+        do
+        {
+            /* shortest bottom time not yet planned */
+            pending = 0;
+            nextDiveTimeMinutes = 0;
+            for(index = leader; index < cellCount; index++)
+            {
+                if(simulation_sweep_is_member(&pCell[leader], &pCell[index], vpmConservatism)
+                	&& ((!pending) || (pCell[index].diveTimeMinutes < nextDiveTimeMinutes)))
+                {
+                    nextDiveTimeMinutes = pCell[index].diveTimeMinutes;
+                    pending = 1;
+                }
+            }
+            if(pending)
+            {
+                ptrGasChangeList = simulation_plan_bottom(60 * (uint32_t)(nextDiveTimeMinutes - diveTimeMinutes), gasChangeListPrefix, ptrGasChangeList);
+                diveTimeMinutes = nextDiveTimeMinutes;
+                memcpy(&vpmPrefix, &pDiveState->vpm, sizeof(SVpm));
+
+                for(index = leader; index < cellCount; index++)
+                {
+                    if(simulation_sweep_is_member(&pCell[leader], &pCell[index], vpmConservatism)
+                    	&& (pCell[index].diveTimeMinutes == diveTimeMinutes))
+                    {
+                        simulation_sweep_calc_cell(&pCell[index], &vpmPrefix, gasChangeListPrefix, ptrGasChangeList, gasConsumTravelInput, gasConsumDecoInput);
+                        cellsDone++;
+                    }
+                }
+            }
+        } while(pending);
+    }
+    memcpy(&pDiveState->diveSettings, &diveSettingsSaved, sizeof(SDiveSettings));
+    return cellsDone;
+}
+
 static float sGChelper_bar(uint16_t depth_meter)
 {
     SDiveState * pDiveState = &stateSim;
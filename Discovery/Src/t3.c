@@ -29,6 +29,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include <stdbool.h>
 #include <stdlib.h>
+#include <inttypes.h>
 
 #include "t3.h"
 
@@ -1330,7 +1331,7 @@ void t3_basics_refresh_customview(float depth, uint8_t tX_selection_customview,
                 {
                 	text[textpointer++] = '\025'; 	/* red */
                 }
-                snprintf(&text[textpointer],TEXTSIZE,"\001%5ld",stateUsed->lifeData.CO2_data.CO2_ppm);
+                snprintf(&text[textpointer],TEXTSIZE,"\001%5" PRIu32,stateUsed->lifeData.CO2_data.CO2_ppm);
                 GFX_write_string(&FontT105,tXc1,text,1);
             }
 
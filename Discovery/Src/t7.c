@@ -28,6 +28,7 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include <stdlib.h>
+#include <inttypes.h>
 
 #include "t7.h"
 #include "t3.h"
@@ -106,6 +107,13 @@ GFX_DrawCfgWindow	t7cH, t7cC, t7cW, t7cY0free;
 GFX_DrawCfgWindow	t7pCompass;
 GFX_DrawCfgWindow	t7surfaceL, t7surfaceR;
 
+/* dive mode: text fields kept from the previous frame while unchanged,
+ * the areas with graphs and the customview are cleared and drawn each time,
+ * t7volatileR is the part of the battery value reaching into t7r1
+ */
+static GFX_DrawCfgWindow * const t7retained[] = { &t7l2, &t7l3, &t7r1, &t7r2, &t7r3 };
+GFX_DrawCfgWindow	t7volatileL, t7volatileC, t7volatileR;
+
 uint8_t selection_customview = LLC_Temperature;
 
 uint8_t updateNecessary = 0;
@@ -351,6 +359,24 @@ void t7_init(void)
 		t7c2.WindowY0 = 0;
 		t7c2.WindowY1 = 69;
 
+		t7volatileL.Image = &t7screen;
+		t7volatileL.WindowX0 = 0;
+		t7volatileL.WindowX1 = CUSTOMBOX_LINE_LEFT - 1;
+		t7volatileL.WindowY0 = t7l2.WindowY1 + 1;
+		t7volatileL.WindowY1 = 479;
+
+		t7volatileC.Image = &t7screen;
+		t7volatileC.WindowX0 = CUSTOMBOX_LINE_LEFT;
+		t7volatileC.WindowX1 = CUSTOMBOX_LINE_RIGHT;
+		t7volatileC.WindowY0 = 0;
+		t7volatileC.WindowY1 = 479;
+
+		t7volatileR.Image = &t7screen;
+		t7volatileR.WindowX0 = CUSTOMBOX_LINE_RIGHT + 1;
+		t7volatileR.WindowX1 = t7voltage.WindowX1;
+		t7volatileR.WindowY0 = t7voltage.WindowY0;
+		t7volatileR.WindowY1 = 479;
+
 		t7pCompass.Image = &t7screenCompass;
 		t7pCompass.WindowNumberOfTextLines = 1;
 		t7pCompass.WindowLineSpacing = 100; // Abstand von Y0
@@ -1276,6 +1302,7 @@ void t7_refresh_surface_debugmode(void)
     SDataExchangeSlaveToMaster *dataIn = get_dataInPointer();
 
     SWindowGimpStyle windowGimp;
+    SFramePoolStatistics framePool;
 
     RTC_DateTypeDef Sdate;
     RTC_TimeTypeDef Stime;
@@ -1293,12 +1320,16 @@ void t7_refresh_surface_debugmode(void)
     else
     if(DataEX_lost_connection_count())
     {
-        snprintf(TextL1,TEXTSIZE,"\002%ld",DataEX_lost_connection_count());
+        snprintf(TextL1,TEXTSIZE,"\002%" PRIu32,DataEX_lost_connection_count());
         Gfx_write_label_var(&t7screen,  600,800, 45,&FontT48,CLUT_Font020,TextL1);
     }
 
-    snprintf(TextL1,TEXTSIZE,"\002%i",blockedFramesCount());
-    Gfx_write_label_var(&t7screen,  600,800, 0,&FontT48,CLUT_Font020,TextL1);
+    /* frame pool: clean / released / blocked frames with the high-water mark, getFrame() waits and failures */
+    GFX_getFramePoolStatistics(&framePool);
+    snprintf(TextL1,TEXTSIZE,"\002%u/%u/%u max %u",framePool.clean,framePool.released,framePool.blocked,framePool.blockedMax);
+    Gfx_write_label_var(&t7screen,  620,800, 0,&FontT24,CLUT_Font020,TextL1);
+    snprintf(TextL1,TEXTSIZE,"\002wait %u fail %u",framePool.waitCount,framePool.acquireFailed);
+    Gfx_write_label_var(&t7screen,  620,800,22,&FontT24,CLUT_Font020,TextL1);
 
     if(stateUsed->lifeData.compass_DX_f | stateUsed->lifeData.compass_DY_f | stateUsed->lifeData.compass_DZ_f)
     {
@@ -1358,7 +1389,7 @@ void t7_refresh_surface_debugmode(void)
 
 extern uint32_t base_tempLightLevel;
 
-    snprintf(TextL1,TEXTSIZE,"# %u (%ld)",stateUsed->lifeData.ambient_light_level, base_tempLightLevel);
+    snprintf(TextL1,TEXTSIZE,"# %u (%" PRIu32 ")",stateUsed->lifeData.ambient_light_level, base_tempLightLevel);
     Gfx_write_label_var(&t7screen,  401,600,310,&FontT42,CLUT_DiveMainLabel,"Light");
     Gfx_write_label_var(&t7screen,  401,800,355,&FontT48,CLUT_Font020,TextL1);
 
@@ -2768,6 +2799,15 @@ void t7_refresh_divemode(void)
 	SSettings* pSettings;
 	pSettings = settingsGetPointer();
 
+    /* partial redraw, not used for the flipped layout */
+    if(!pSettings->FlipDisplay && !SPI_SHOW_SYNC_STATS)
+    {
+        GFX_retained_begin(&t7screen, 22, t7retained, sizeof(t7retained) / sizeof(t7retained[0]));
+        GFX_retained_clear(&t7volatileL);
+        GFX_retained_clear(&t7volatileC);
+        GFX_retained_clear(&t7volatileR);
+    }
+
     Divetime.Total = stateUsed->lifeData.dive_time_seconds_without_surface_time;
     Divetime.Minutes = Divetime.Total / 60;
     Divetime.Seconds = Divetime.Total - ( Divetime.Minutes * 60 );
@@ -3156,6 +3196,27 @@ void t7_refresh_divemode(void)
             GFX_write_string(&FontT24,&t7c1,"\f\002\024" "Bailout",0);
         //  GFX_write_string(&FontT24,&t7c1,"\f\177\177\x80\024" "Bailout",0);
     }
+    /* customizable left lower corner */
+    t7_refresh_divemode_userselected_left_lower_corner();
+
+
+    /* customview - option 1
+     * warning - option 2 */
+    if(stateUsed->warnings.numWarnings)
+        customview_warnings = t7_test_customview_warnings();
+
+    background.pointer = 0;
+    if(customview_warnings && warning_count_high_time)
+        t7_show_customview_warnings();
+    else
+    {
+        t7_refresh_customview();
+        requestBuzzerActivation(0);
+    }
+
+    GFX_retained_end();
+
+    /* battery, drawn on top of t7r1 */
     TextC1[0] = '\020';
     TextC1[1] = '3';
     TextC1[2] = '1';
@@ -3212,24 +3273,6 @@ void t7_refresh_divemode(void)
         }
     }
 
-    /* customizable left lower corner */
-    t7_refresh_divemode_userselected_left_lower_corner();
-
-
-    /* customview - option 1
-     * warning - option 2 */
-    if(stateUsed->warnings.numWarnings)
-        customview_warnings = t7_test_customview_warnings();
-
-    background.pointer = 0;
-    if(customview_warnings && warning_count_high_time)
-        t7_show_customview_warnings();
-    else
-    {
-        t7_refresh_customview();
-        requestBuzzerActivation(0);
-    }
-
     /* the frame */
     draw_frame(1,1, CLUT_DIVE_pluginbox, CLUT_DIVE_FieldSeperatorLines);
 }
@@ -3428,7 +3471,7 @@ void t7_refresh_divemode_userselected_left_lower_corner(void)
         {
         	text[textpointer++] = '\025'; 	/* red */
         }
-        snprintf(&text[textpointer],TEXTSIZE,"\%5ldppm", stateUsed->lifeData.CO2_data.CO2_ppm);
+        snprintf(&text[textpointer],TEXTSIZE,"%5" PRIu32 "ppm", stateUsed->lifeData.CO2_data.CO2_ppm);
       break;
 #endif
     case LLC_Compass:
@@ -4642,7 +4685,7 @@ uint16_t LogDeltaCharge(float charge)
 	}
 	else
 	{
-		memcpy (&ChargerLog[0],&ChargerLog[1],sizeof(ChargerLog) - 1);
+		memmove (&ChargerLog[0],&ChargerLog[1],sizeof(ChargerLog) - 1);
 		ChargerLog[curIndex] = level;
 	}
 	if(curIndex > 1)	/* estimate time til charging is complete */
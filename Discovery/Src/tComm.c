@@ -113,6 +113,11 @@ uint8_t updateSettingsAndMenuOnExit = 0;
 
 #define UART_CMD_BUF_SIZE			(30u)		/* size of buffer for command exchange */
 
+#define UART_PROFILE_CHUNK_SIZE		(512u)		/* bytes per buffer of the profile download, one flash read and one transmission each */
+#define UART_PROFILE_BUFFER_COUNT	(2u)		/* one buffer is filled while the other one is transmitted */
+#define UART_PROFILE_TIMEOUT		(5000u)		/* Timeout (ms) for the transmission of one profile chunk */
+#define UART_RANGE_MAX_LENGTH		(0xFFFFFFu)	/* offset and length of a range download are 24 bit values */
+
 const uint8_t id_Region1_firmware = 0xFF;
 const uint8_t id_RTE = 0xFE;
 const uint8_t id_FONT = 0x10;
@@ -122,7 +127,11 @@ static BlueModTmpConfig_t BmTmpConfig = BM_CONFIG_OFF;	/* Config BlueMod without
 static uint8_t EvaluateBluetoothSignalStrength = 0;
 #ifndef BOOTLOADER_STANDALONE
 static uint8_t RequestDisconnection = 0; 				/* Disconnection from remote device requested */
+static uint8_t profileBuffer[UART_PROFILE_BUFFER_COUNT][UART_PROFILE_CHUNK_SIZE];
 static void tComm_Disconnect(void);
+static uint8_t tComm_SendProfile(void (*readProfilePart)(uint8_t *pTarget, uint16_t length), uint32_t profileLength, uint32_t* pCrc);
+static uint8_t tComm_SendProfileRange(uint8_t StepBackwards, uint32_t offset, uint32_t length);
+static uint8_t tComm_SendDivesSince(uint16_t diveNumber);
 #endif
 /* Private function prototypes -----------------------------------------------*/
 static void tComm_Error_Handler(void);
@@ -996,6 +1005,8 @@ uint8_t select_mode(uint8_t type)
     case 0x62: // set clock
     case 0x63: // set custom text
     case 0x66: // get dive profile
+    case 0x67: // get range of dive profile
+    case 0x68: // get all dives newer than a dive number
     case 0x69: // get serial, old version numbering, custom text
     case 0x6A: // get model
     case 0x6B: // get specific firmware version
@@ -1041,6 +1052,14 @@ uint8_t select_mode(uint8_t type)
         if(HAL_UART_Receive(&UartHandle, (uint8_t*)aRxBuffer,  1, 1000)!= HAL_OK)
             return 0;
         break;
+    case 0x67:
+        if(HAL_UART_Receive(&UartHandle, (uint8_t*)aRxBuffer,  7, 1000)!= HAL_OK)
+            return 0;
+        break;
+    case 0x68:
+        if(HAL_UART_Receive(&UartHandle, (uint8_t*)aRxBuffer,  2, 1000)!= HAL_OK)
+            return 0;
+        break;
     case 0x6B:
         if(HAL_UART_Receive(&UartHandle, (uint8_t*)aRxBuffer,  1, 1000)!= HAL_OK)
             return 0;
@@ -1188,6 +1207,7 @@ uint8_t select_mode(uint8_t type)
 #ifndef BOOTLOADER_STANDALONE
     // full headers (256 byte)
     case 0x61:
+        ext_flash_header_index_spot_check();
         for(int StepBackwards = 255; StepBackwards > -1; StepBackwards--)
         {
             logbook_getHeader(StepBackwards, &logbookHeader);
@@ -1200,6 +1220,7 @@ uint8_t select_mode(uint8_t type)
 
         // compact headers (16 byte)
     case 0x6D:
+        ext_flash_header_index_spot_check();
         for(int StepBackwards = 255; StepBackwards > -1; StepBackwards--)
         {
             logbook_getHeader(StepBackwards, &logbookHeader);
@@ -1253,45 +1274,39 @@ uint8_t select_mode(uint8_t type)
 
         OSTC3_profileLength = (plogbookHeaderOSTC3->profileLength[2] << 16) + (plogbookHeaderOSTC3->profileLength[1] << 8)
                 								    + plogbookHeaderOSTC3->profileLength[0] -3;
-        header_profileLength = (logbookHeader.profileLength[2] << 16) + (logbookHeader.profileLength[1] << 8) + logbookHeader.profileLength[0];
+        header_profileLength = logbook_getStandardProfileLength(&logbookHeader);
        
         if(OSTC3_profileLength != header_profileLength)			/* has headerdata been changed to dummy data? */
         {
         	sampleTotalLength = logbook_fillDummySampleBuffer(&logbookHeader);
-			while(sampleTotalLength >= 128)
-			{
-				logbook_readDummySamples(aTxBuffer,128);
-				sampleTotalLength -= 128;
-				if(HAL_UART_Transmit(&UartHandle, (uint8_t*)aTxBuffer, 128,5000)!= HAL_OK)
-					return 0;
-			}
-			if(sampleTotalLength)
-			{
-				logbook_readDummySamples(aTxBuffer,sampleTotalLength);
-				if(HAL_UART_Transmit(&UartHandle, (uint8_t*)aTxBuffer, sampleTotalLength,5000)!= HAL_OK)
-					return 0;
-			}
+			if(!tComm_SendProfile(logbook_readDummySamples, sampleTotalLength, NULL))
+				return 0;
         }
         else
         {
-			ext_flash_open_read_sample(255 - aRxBuffer[0], &sampleTotalLength);
-			while(sampleTotalLength >= 128)
-			{
-				ext_flash_read_next_sample_part(aTxBuffer,128);
-				sampleTotalLength -= 128;
-				if(HAL_UART_Transmit(&UartHandle, (uint8_t*)aTxBuffer, 128,5000)!= HAL_OK)
-					return 0;
-			}
-			if(sampleTotalLength)
-			{
-				ext_flash_read_next_sample_part(aTxBuffer,sampleTotalLength);
-				if(HAL_UART_Transmit(&UartHandle, (uint8_t*)aTxBuffer, sampleTotalLength,5000)!= HAL_OK)
-					return 0;
-			}
+			sampleTotalLength = logbook_openStandardProfile(255 - aRxBuffer[0], &logbookHeader);
+			if(!tComm_SendProfile(logbook_readStandardProfile, sampleTotalLength, NULL))
+				return 0;
         }
 		aTxBuffer[count++] = prompt4D4C(receiveStartByteUart);
         break;
 
+    // get range of dive profile: dive, offset (24 bit), length (24 bit), all little endian
+    case 0x67:
+        if(!tComm_SendProfileRange(255 - aRxBuffer[0],
+        						   aRxBuffer[1] + (aRxBuffer[2] << 8) + (aRxBuffer[3] << 16),
+        						   aRxBuffer[4] + (aRxBuffer[5] << 8) + (aRxBuffer[6] << 16)))
+            return 0;
+        aTxBuffer[count++] = prompt4D4C(receiveStartByteUart);
+        break;
+
+    // get headers and profiles of all dives newer than the dive number (16 bit, little endian)
+    case 0x68:
+        if(!tComm_SendDivesSince(aRxBuffer[0] + (aRxBuffer[1] << 8)))
+            return 0;
+        aTxBuffer[count++] = prompt4D4C(receiveStartByteUart);
+        break;
+
         // read min,default,max setting
     case 0x70:
     count += readDataLimits__8and16BitValues_4and7BytesOutput(aRxBuffer[0],&aTxBuffer[count]);
@@ -1345,6 +1360,17 @@ uint8_t select_mode(uint8_t type)
             return 0;
         aTxBuffer[count++] = prompt4D4C(receiveStartByteUart);
         break;
+    // get range of dive profile: empty range, CRC of no data
+    case 0x67:
+        memset(&aTxBuffer[count], 0, 10);
+        count += 10;
+        aTxBuffer[count++] = prompt4D4C(receiveStartByteUart);
+        break;
+    // get dives newer than: no dives
+    case 0x68:
+        aTxBuffer[count++] = 0;
+        aTxBuffer[count++] = prompt4D4C(receiveStartByteUart);
+        break;
     // read min,default,max setting
     // read settings
 
@@ -1371,6 +1397,186 @@ uint8_t select_mode(uint8_t type)
     return 0;
 }
 
+#ifndef BOOTLOADER_STANDALONE
+static uint8_t tComm_WaitTransmitDone(void)
+{
+    uint32_t tickstart = HAL_GetTick();
+
+    while(UartHandle.gState != HAL_UART_STATE_READY)
+    {
+        if((HAL_GetTick() - tickstart) > UART_PROFILE_TIMEOUT)
+        {
+            HAL_UART_AbortTransmit(&UartHandle);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* CRC-32 as used by zlib (reflected, polynomial 0xEDB88320), nibble wise to keep the table small.
+ * Start with crc = 0, the result of a previous call continues the calculation. */
+static uint32_t tComm_UpdateCrc32(uint32_t crc, const uint8_t* pData, uint32_t length)
+{
+    static const uint32_t crcTable[16] =
+    {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+
+    crc = ~crc;
+    while(length--)
+    {
+        crc ^= *pData++;
+        crc = (crc >> 4) ^ crcTable[crc & 0x0F];
+        crc = (crc >> 4) ^ crcTable[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+/* Streams a dive profile of profileLength bytes. The transmission of a chunk runs by interrupt
+ * while readProfilePart() fetches the next chunk into the other buffer.
+ * If pCrc is provided, the CRC-32 of the sent data is updated while the previous chunk is transmitted. */
+static uint8_t tComm_SendProfile(void (*readProfilePart)(uint8_t *pTarget, uint16_t length), uint32_t profileLength, uint32_t* pCrc)
+{
+    uint8_t bufferIndex = 0;
+    uint16_t length;
+    uint8_t result = 1;
+
+    while(result && profileLength)
+    {
+        length = (profileLength > UART_PROFILE_CHUNK_SIZE) ? UART_PROFILE_CHUNK_SIZE : profileLength;
+        readProfilePart(profileBuffer[bufferIndex], length);
+        profileLength -= length;
+        if(pCrc)
+        {
+            *pCrc = tComm_UpdateCrc32(*pCrc, profileBuffer[bufferIndex], length);
+        }
+
+        result = tComm_WaitTransmitDone();
+        if(result && (HAL_UART_Transmit_IT(&UartHandle, profileBuffer[bufferIndex], length) != HAL_OK))
+        {
+            result = 0;
+        }
+        bufferIndex = (bufferIndex + 1) % UART_PROFILE_BUFFER_COUNT;
+    }
+    if(!tComm_WaitTransmitDone())
+    {
+        result = 0;
+    }
+    UartReady = RESET;		/* set by HAL_UART_TxCpltCallback(), which is shared with the reception of the start byte */
+    return result;
+}
+
+/* Sends length bytes of the profile of a dive starting at offset, as they would be part of the 0x66 download.
+ * Answer: total profile length (3 byte), length of the range (3 byte), data, CRC-32 of the data (4 byte).
+ * The range is clipped to the end of the profile, so a host resuming a download learns the remaining size. */
+static uint8_t tComm_SendProfileRange(uint8_t StepBackwards, uint32_t offset, uint32_t length)
+{
+    SLogbookHeader logbookHeader;
+    SLogbookHeaderOSTC3 * plogbookHeaderOSTC3;
+    void (*readProfilePart)(uint8_t *pTarget, uint16_t length);
+    uint32_t totalLength;
+    uint32_t skip;
+    uint32_t crc = 0;
+    uint8_t rangeInfo[6];
+
+    logbook_getHeader(StepBackwards, &logbookHeader);
+    plogbookHeaderOSTC3 = logbook_build_ostc3header(&logbookHeader);
+
+    totalLength = (plogbookHeaderOSTC3->profileLength[2] << 16) + (plogbookHeaderOSTC3->profileLength[1] << 8)
+                								    + plogbookHeaderOSTC3->profileLength[0] - 3;
+    if(totalLength != logbook_getStandardProfileLength(&logbookHeader))		/* same dummy data handling as 0x66 */
+    {
+        totalLength = logbook_fillDummySampleBuffer(&logbookHeader);
+        readProfilePart = logbook_readDummySamples;
+    }
+    else
+    {
+        totalLength = logbook_openStandardProfile(StepBackwards, &logbookHeader);
+        readProfilePart = logbook_readStandardProfile;
+    }
+    totalLength &= UART_RANGE_MAX_LENGTH;
+
+    if(offset > totalLength)
+    {
+        offset = totalLength;
+    }
+    if(length > totalLength - offset)
+    {
+        length = totalLength - offset;
+    }
+
+    rangeInfo[0] = totalLength & 0xFF;
+    rangeInfo[1] = (totalLength >> 8) & 0xFF;
+    rangeInfo[2] = (totalLength >> 16) & 0xFF;
+    rangeInfo[3] = length & 0xFF;
+    rangeInfo[4] = (length >> 8) & 0xFF;
+    rangeInfo[5] = (length >> 16) & 0xFF;
+    if(HAL_UART_Transmit(&UartHandle, rangeInfo, sizeof(rangeInfo), UART_OPERATION_TIMEOUT) != HAL_OK)
+        return 0;
+
+    /* compact profiles are decoded sequentially, so the bytes in front of the range are read and dropped */
+    while(offset)
+    {
+        skip = (offset > UART_PROFILE_CHUNK_SIZE) ? UART_PROFILE_CHUNK_SIZE : offset;
+        readProfilePart(profileBuffer[0], skip);
+        offset -= skip;
+    }
+
+    if(!tComm_SendProfile(readProfilePart, length, &crc))
+        return 0;
+
+    rangeInfo[0] = crc & 0xFF;
+    rangeInfo[1] = (crc >> 8) & 0xFF;
+    rangeInfo[2] = (crc >> 16) & 0xFF;
+    rangeInfo[3] = (crc >> 24) & 0xFF;
+    if(HAL_UART_Transmit(&UartHandle, rangeInfo, 4, UART_OPERATION_TIMEOUT) != HAL_OK)
+        return 0;
+
+    return 1;
+}
+
+/* Sends the dives with a dive number above diveNumber, oldest first, as one stream:
+ * number of dives (1 byte), then for every dive the 256 byte header and the profile as 0x66 sends them.
+ * The header goes out by interrupt while the profile is opened and its first chunk is read. */
+static uint8_t tComm_SendDivesSince(uint16_t diveNumber)
+{
+    SLogbookHeader logbookHeader;
+    SLogbookHeaderOSTC3 * plogbookHeaderOSTC3;
+    uint32_t profileLength;
+    uint8_t diveCount;
+
+    ext_flash_header_index_spot_check();
+    diveCount = ext_flash_count_dives_since(diveNumber);
+    if(HAL_UART_Transmit(&UartHandle, &diveCount, 1, UART_OPERATION_TIMEOUT) != HAL_OK)
+        return 0;
+
+    while(diveCount--)
+    {
+        logbook_getHeader(diveCount, &logbookHeader);
+        plogbookHeaderOSTC3 = logbook_build_ostc3header(&logbookHeader);
+        if(HAL_UART_Transmit_IT(&UartHandle, (uint8_t*)plogbookHeaderOSTC3, 256) != HAL_OK)
+            return 0;
+
+        profileLength = (plogbookHeaderOSTC3->profileLength[2] << 16) + (plogbookHeaderOSTC3->profileLength[1] << 8)
+                								    + plogbookHeaderOSTC3->profileLength[0] - 3;
+        if(profileLength != logbook_getStandardProfileLength(&logbookHeader))
+        {
+            profileLength = logbook_fillDummySampleBuffer(&logbookHeader);
+            if(!tComm_SendProfile(logbook_readDummySamples, profileLength, NULL))
+                return 0;
+        }
+        else
+        {
+            profileLength = logbook_openStandardProfile(diveCount, &logbookHeader);
+            if(!tComm_SendProfile(logbook_readStandardProfile, profileLength, NULL))
+                return 0;
+        }
+    }
+    return 1;
+}
+#endif
+
 #define BLOCKSIZE 0x1000
 
 HAL_StatusTypeDef receive_uart_large_size(UART_HandleTypeDef *huart, uint8_t *pData, uint32_t Size)
@@ -27,6 +27,8 @@
 //////////////////////////////////////////////////////////////////////////////
 
 /* Includes ------------------------------------------------------------------*/
+#include <inttypes.h>
+
 #include "tHome.h"
 
 #include "data_exchange_main.h" // for dataOutGetPointer()
@@ -710,7 +712,7 @@ uint8_t tHome_show_lost_connection_count(GFX_DrawCfgScreen *ScreenToWriteOn)
     SDataExchangeSlaveToMaster* dataIn=get_dataInPointer();
     SDataReceiveFromMaster* pDataOut = dataOutGetPointer();
 
-    snprintf(text,32,"spi err:\002 %ld/%ld",DataEX_lost_connection_count(),get_num_SPI_CALLBACKS());
+    snprintf(text,32,"spi err:\002 %" PRIu32 "/%" PRIu32,DataEX_lost_connection_count(),get_num_SPI_CALLBACKS());
     Gfx_write_label_var(ScreenToWriteOn,  100,300, 0,&FontT24,CLUT_ButtonSymbols,text);
 
 //    snprintf(text,32,"header:\002%X%X%X%X",dataIn->header.checkCode[0],dataIn->header.checkCode[1],dataIn->header.checkCode[2],dataIn->header.checkCode[3]);
@@ -120,6 +120,7 @@ void openLog(_Bool recallKeepPage)
 
     infolog.modeFlipPages = 1;
     set_globalState_Log_Page(infolog.page);
+    ext_flash_header_index_spot_check();
     infolog.maxpages = (logbook_getNumberOfHeaders() + 5) / 6;
     tInfoLog_BuildAndShowNextPage();
 
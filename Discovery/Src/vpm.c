@@ -79,6 +79,7 @@
 
 #include "vpm.h"
 #include "decom.h"
+#include "calc_crush.h"
 
 #define GAS_N2 0
 #define GAS_HE 1
@@ -694,6 +695,7 @@ static int vpm_calc_critcal_volume(_Bool begin,
     int dp = 0;
     float tissue_He_saturation[16];
     float tissue_N2_saturation[16];
+    STissueTolerance tissue_tolerance;
     float vpm_buehlmann_safety_gradient = 1.0f - (((float)pDiveSettings->vpm_conservatism) / 40);
     /* =============================================================================== */
     /*     CALCULATE CURRENT DECO CEILING BASED ON ALLOWABLE SUPERSATURATION */
@@ -729,14 +731,15 @@ static int vpm_calc_critcal_volume(_Bool begin,
                 tissue_He_saturation[i] = helium_pressure[i] / 10.0;
                 tissue_N2_saturation[i] = nitrogen_pressure[i] / 10.0;
             }
+            decom_tissue_tolerance_load(&tissue_tolerance, tissue_N2_saturation, tissue_He_saturation);
 
-            if(!decom_tissue_test_tolerance(tissue_N2_saturation, tissue_He_saturation, vpm_buehlmann_safety_gradient, (deco_stop_depth / 10.0f) + pInput->pressure_surface_bar))
+            if(decom_tissue_tolerance_margin(&tissue_tolerance, vpm_buehlmann_safety_gradient, (deco_stop_depth / 10.0f) + pInput->pressure_surface_bar) > 0)
             {
 
                 vpm_violates_buehlmann = true;
                 do {
                     deco_stop_depth += 3.0;
-                } while (!decom_tissue_test_tolerance(tissue_N2_saturation, tissue_He_saturation, vpm_buehlmann_safety_gradient, (deco_stop_depth / 10.0f) + pInput->pressure_surface_bar));
+                } while (decom_tissue_tolerance_margin(&tissue_tolerance, vpm_buehlmann_safety_gradient, (deco_stop_depth / 10.0f) + pInput->pressure_surface_bar) > 0);
             }
         }
 
@@ -892,7 +895,7 @@ static int vpm_check_converged(_Bool calc_nulltime)
     {
         phase_volume_time[i - 1] =
         deco_phase_volume_time + surface_phase_volume_time[i - 1];
-        critical_volume_comparison = (r1 = phase_volume_time[i - 1] - last_phase_volume_time[i - 1], fabs(r1));
+        critical_volume_comparison = (r1 = phase_volume_time[i - 1] - last_phase_volume_time[i - 1], fabsf(r1));
 
         if (critical_volume_comparison <= 1.0f)
         {
@@ -985,6 +988,7 @@ static void vpm_calc_deco_ceiling(void)
     // _Bool first_stop = false;
     float tissue_He_saturation[16];
     float tissue_N2_saturation[16];
+    STissueTolerance tissue_tolerance;
     float vpm_buehlmann_safety_gradient = 1.0f - (((float)pDiveSettings->vpm_conservatism) / 40);
     //max_first_stop_depth = fmaxf(first_stop_depth,max_first_stop_depth);
 
@@ -1016,13 +1020,14 @@ static void vpm_calc_deco_ceiling(void)
                 tissue_He_saturation[i] = helium_pressure[i] / 10.0;
                 tissue_N2_saturation[i] = nitrogen_pressure[i] / 10.0;
             }
+            decom_tissue_tolerance_load(&tissue_tolerance, tissue_N2_saturation, tissue_He_saturation);
 
-            if(!decom_tissue_test_tolerance(tissue_N2_saturation, tissue_He_saturation, vpm_buehlmann_safety_gradient, (deco_ceiling_depth / 10.0f) + pInput->pressure_surface_bar))
+            if(decom_tissue_tolerance_margin(&tissue_tolerance, vpm_buehlmann_safety_gradient, (deco_ceiling_depth / 10.0f) + pInput->pressure_surface_bar) > 0)
             {
                 vpm_violates_buehlmann = true;
                 do {
                     deco_ceiling_depth += 0.1f;
-                } while (!decom_tissue_test_tolerance(tissue_N2_saturation, tissue_He_saturation, vpm_buehlmann_safety_gradient, (deco_ceiling_depth / 10.0f) + pInput->pressure_surface_bar));
+                } while (decom_tissue_tolerance_margin(&tissue_tolerance, vpm_buehlmann_safety_gradient, (deco_ceiling_depth / 10.0f) + pInput->pressure_surface_bar) > 0);
             }
         }
 
@@ -1053,13 +1058,14 @@ static void vpm_calc_deco_ceiling(void)
                 tissue_He_saturation[i] = helium_pressure[i] / 10.0;
                 tissue_N2_saturation[i] = nitrogen_pressure[i] / 10.0;
             }
+            decom_tissue_tolerance_load(&tissue_tolerance, tissue_N2_saturation, tissue_He_saturation);
 
-            if(!decom_tissue_test_tolerance(tissue_N2_saturation, tissue_He_saturation, vpm_buehlmann_safety_gradient, (deco_ceiling_depth / 10.0f) + pInput->pressure_surface_bar))
+            if(decom_tissue_tolerance_margin(&tissue_tolerance, vpm_buehlmann_safety_gradient, (deco_ceiling_depth / 10.0f) + pInput->pressure_surface_bar) > 0)
             {
                 vpm_violates_buehlmann = true;
                 do {
                     deco_ceiling_depth += 0.1f;
-                } while (!decom_tissue_test_tolerance(tissue_N2_saturation, tissue_He_saturation, vpm_buehlmann_safety_gradient, (deco_ceiling_depth / 10.0f) + pInput->pressure_surface_bar));
+                } while (decom_tissue_tolerance_margin(&tissue_tolerance, vpm_buehlmann_safety_gradient, (deco_ceiling_depth / 10.0f) + pInput->pressure_surface_bar) > 0);
             }
         }
         // output_ceiling_meter
@@ -1318,11 +1324,11 @@ static int nuclear_regeneration(float *dive_time)
         regenerated_radius_he[i - 1] =
         pVpm->adjusted_critical_radius_he[i - 1] +
         (ending_radius_he - pVpm->adjusted_critical_radius_he[i - 1]) *
-        expf(-(*dive_time) / REGENERATION_TIME_CONSTANT);
+        vpm_expf(-(*dive_time) / REGENERATION_TIME_CONSTANT);
         regenerated_radius_n2[i - 1] =
         pVpm->adjusted_critical_radius_n2[i - 1] +
         (ending_radius_n2 - pVpm->adjusted_critical_radius_n2[i - 1]) *
-        expf(-(*dive_time) / REGENERATION_TIME_CONSTANT);
+        vpm_expf(-(*dive_time) / REGENERATION_TIME_CONSTANT);
 
         /* =============================================================================== */
         /*     In order to preserve reference back to the initial critical radii after */
@@ -1638,16 +1644,16 @@ static int calc_surface_phase_volume_time()
         {
             decay_time_to_zero_gradient =
             1.0f / (NITROGEN_TIME_CONSTANT[i - 1] - HELIUM_TIME_CONSTANT[i - 1]) *
-            log((surface_inspired_n2_pressure - nitrogen_pressure[i - 1]) /
+            vpm_logf((surface_inspired_n2_pressure - nitrogen_pressure[i - 1]) /
             helium_pressure[i - 1]);
             integral_gradient_x_time =
             helium_pressure[i - 1] /
             HELIUM_TIME_CONSTANT[i - 1] *
-            (1.0f - expf(-HELIUM_TIME_CONSTANT[i - 1] *
+            (1.0f - vpm_expf(-HELIUM_TIME_CONSTANT[i - 1] *
             decay_time_to_zero_gradient)) +
             (nitrogen_pressure[i - 1] - surface_inspired_n2_pressure) /
             NITROGEN_TIME_CONSTANT[i - 1] *
-            (1.0f - expf(-NITROGEN_TIME_CONSTANT[i - 1] *
+            (1.0f - vpm_expf(-NITROGEN_TIME_CONSTANT[i - 1] *
             decay_time_to_zero_gradient));
             surface_phase_volume_time[i - 1] =
             integral_gradient_x_time /
@@ -1940,7 +1946,7 @@ static int calc_start_of_deco_zone(float *starting_depth,
             if (function_at_mid_range <= 0.0f) {
                 time_to_start_of_deco_zone = mid_range_time;
             }
-            if( fabs(differential_change) < 0.001f
+            if( fabsf(differential_change) < 0.001f
              || function_at_mid_range == 0.0f)
             {
                 goto L170;
@@ -2309,7 +2315,7 @@ static void BOYLES_LAW_COMPENSATION (float* First_Stop_Depth,
 
     Amb_Press_Next_Stop_Pascals =
             (Ambient_Pressure_Next_Stop/UNITS_FACTOR) * 101325.0f;
-    root_factor = powf(Amb_Press_First_Stop_Pascals/Amb_Press_Next_Stop_Pascals,1.0f / 3.0f);
+    root_factor = vpm_cbrtf(Amb_Press_First_Stop_Pascals/Amb_Press_Next_Stop_Pascals);
 
     for( i = 0; i < 16;i++)
     {
@@ -2521,4 +2527,8 @@ SvpmTableState vpm_get_TableState(void)
 {
 	return vpmTableState;
 }
+int vpm_get_critical_volume_iterations(void)
+{
+	return count_critical_volume_iteration;
+}
 
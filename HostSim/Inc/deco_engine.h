@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////////
+/// -*- coding: UTF-8 -*-
+///
+/// \file   HostSim/Inc/deco_engine.h
+/// \brief  Parallel host engine for the four deco_loop() calculations
+/// \author heinrichs weikamp gmbh
+/// \date   17-Oct-2026
+///
+/// $Id$
+///////////////////////////////////////////////////////////////////////////////
+///     This program is free software: you can redistribute it and/or modify
+///     it under the terms of the GNU General Public License as published by
+///     the Free Software Foundation, either version 3 of the License, or
+///     (at your option) any later version.
+///
+///     This program is distributed in the hope that it will be useful,
+///     but WITHOUT ANY WARRANTY; without even the implied warranty of
+///     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///     GNU General Public License for more details.
+///
+///     You should have received a copy of the GNU General Public License
+///     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef DECO_ENGINE_H
+#define DECO_ENGINE_H
+
+#include "data_central.h"
+
+/* the part of stateDeco the deco calculations read */
+typedef struct
+{
+	SLifeData lifeData;
+	SDiveSettings diveSettings;
+	SVpm vpm;
+} SDecoSnapshot;
+
+/* all four results of deco_loop() for one snapshot */
+typedef struct
+{
+	SDecoinfo vpm;
+	SDecoinfo vpmFuture;
+	SDecoinfo buehlmann;
+	SDecoinfo buehlmannFuture;
+	SVpm vpmState;			/* snapshot vpm after the DECOSTOPS calculation */
+	float vpmCNS;
+} SDecoResult;
+
+int  deco_engine_init(int workers);
+void deco_engine_exit(void);
+int  deco_engine_workers(void);
+int  deco_engine_run(const SDecoSnapshot *pSnapshot, SDecoResult *pResult, int count);
+
+#endif /* DECO_ENGINE_H */
@@ -0,0 +1,48 @@
+///////////////////////////////////////////////////////////////////////////////
+/// -*- coding: UTF-8 -*-
+///
+/// \file   HostSim/Inc/host_display.h
+/// \brief  Software LTDC / DMA2D of the host graphics build
+/// \author heinrichs weikamp gmbh
+/// \date   17-Oct-2026
+///
+/// $Id$
+///////////////////////////////////////////////////////////////////////////////
+///     This program is free software: you can redistribute it and/or modify
+///     it under the terms of the GNU General Public License as published by
+///     the Free Software Foundation, either version 3 of the License, or
+///     (at your option) any later version.
+///
+///     This program is distributed in the hope that it will be useful,
+///     but WITHOUT ANY WARRANTY; without even the implied warranty of
+///     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///     GNU General Public License for more details.
+///
+///     You should have received a copy of the GNU General Public License
+///     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef HOSTSIM_HOST_DISPLAY_H
+#define HOSTSIM_HOST_DISPLAY_H
+
+#include <stdint.h>
+
+/* the display as seen by the diver, landscape, 3 bytes RGB per pixel */
+#define HOST_DISPLAY_WIDTH		(800)
+#define HOST_DISPLAY_HEIGHT		(480)
+#define HOST_DISPLAY_BYTES		(HOST_DISPLAY_WIDTH * HOST_DISPLAY_HEIGHT * 3)
+
+/* SDRAM of the frame buffers, mapped at the target address by host_display_init() */
+#define HOST_SDRAM_START		(0xD0000000u)
+#define HOST_SDRAM_SIZE			(0x02000000u)
+
+int host_display_init(void);
+void host_display_snapshot(uint8_t *pRgb);
+
+int host_png_write(const char *pPath, const uint8_t *pRgb);
+int host_png_read(const char *pPath, uint8_t *pRgb);
+
+/* time base of HAL_GetTick() in the graphics build, HostSim/Src/host_gfx_stubs.c */
+void host_set_tick(uint32_t tick);
+
+#endif /* HOSTSIM_HOST_DISPLAY_H */
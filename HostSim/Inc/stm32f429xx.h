@@ -0,0 +1,2 @@
+/* device registers of the host build are provided by HostSim/Inc/stm32f4xx_hal.h */
+#include "stm32f4xx_hal.h"
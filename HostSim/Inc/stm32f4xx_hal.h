@@ -0,0 +1,314 @@
+///////////////////////////////////////////////////////////////////////////////
+/// -*- coding: UTF-8 -*-
+///
+/// \file   HostSim/Inc/stm32f4xx_hal.h
+/// \brief  Minimal stand-in for the STM32 HAL used by the host build
+/// \author heinrichs weikamp gmbh
+/// \date   17-Oct-2026
+///
+/// \details
+///	Only the types and functions that leak into Common/Inc/data_central.h and
+///	Common/Inc/settings.h are provided. Layouts match the ST HAL definitions
+///	in Common/Drivers/STM32F4xx_HAL_Driver/Inc/stm32f4xx_hal_rtc.h so that
+///	structures like SSettings and SDiveState have the same shape as on target.
+///
+///	The second part covers what the display code (gfx_engine.c, ostc.h)
+///	uses of DMA2D, LTDC, GPIO and the serial handles. DMA2D and LTDC are
+///	emulated in software by HostSim/Src/host_display.c, the rest only has
+///	to compile.
+///
+/// $Id$
+///////////////////////////////////////////////////////////////////////////////
+///     This program is free software: you can redistribute it and/or modify
+///     it under the terms of the GNU General Public License as published by
+///     the Free Software Foundation, either version 3 of the License, or
+///     (at your option) any later version.
+///
+///     This program is distributed in the hope that it will be useful,
+///     but WITHOUT ANY WARRANTY; without even the implied warranty of
+///     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///     GNU General Public License for more details.
+///
+///     You should have received a copy of the GNU General Public License
+///     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef HOSTSIM_STM32F4XX_HAL_H
+#define HOSTSIM_STM32F4XX_HAL_H
+
+#include <stdint.h>
+
+#define __IO volatile
+
+typedef enum
+{
+	HAL_OK       = 0x00U,
+	HAL_ERROR    = 0x01U,
+	HAL_BUSY     = 0x02U,
+	HAL_TIMEOUT  = 0x03U
+} HAL_StatusTypeDef;
+
+typedef struct
+{
+	uint8_t Hours;
+	uint8_t Minutes;
+	uint8_t Seconds;
+	uint8_t TimeFormat;
+	uint32_t SubSeconds;
+	uint32_t SecondFraction;
+	uint32_t DayLightSaving;
+	uint32_t StoreOperation;
+} RTC_TimeTypeDef;
+
+typedef struct
+{
+	uint8_t WeekDay;
+	uint8_t Month;
+	uint8_t Date;
+	uint8_t Year;
+} RTC_DateTypeDef;
+
+#define RTC_WEEKDAY_MONDAY		((uint8_t)0x01)
+#define RTC_WEEKDAY_TUESDAY		((uint8_t)0x02)
+#define RTC_WEEKDAY_WEDNESDAY	((uint8_t)0x03)
+#define RTC_WEEKDAY_THURSDAY	((uint8_t)0x04)
+#define RTC_WEEKDAY_FRIDAY		((uint8_t)0x05)
+#define RTC_WEEKDAY_SATURDAY	((uint8_t)0x06)
+#define RTC_WEEKDAY_SUNDAY		((uint8_t)0x07)
+
+#define RTC_TR_RESERVED_MASK	0x007F7F7FU
+#define RTC_DR_RESERVED_MASK	0x00FFFF3FU
+#define RTC_TR_PM				(0x1U << 22)
+#define RTC_TR_HT				(0x3U << 20)
+#define RTC_TR_HU				(0xFU << 16)
+#define RTC_TR_MNT				(0x7U << 12)
+#define RTC_TR_MNU				(0xFU << 8)
+#define RTC_TR_ST				(0x7U << 4)
+#define RTC_TR_SU				(0xFU << 0)
+#define RTC_DR_YT				(0xFU << 20)
+#define RTC_DR_YU				(0xFU << 16)
+#define RTC_DR_WDU				(0x7U << 13)
+#define RTC_DR_MT				(0x1U << 12)
+#define RTC_DR_MU				(0xFU << 8)
+#define RTC_DR_DT				(0x3U << 4)
+#define RTC_DR_DU				(0xFU << 0)
+
+uint8_t RTC_Bcd2ToByte(uint8_t Value);
+
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+
+/* display -----------------------------------------------------------------*/
+
+typedef enum { RESET = 0, SET = !RESET } FlagStatus, ITStatus;
+typedef enum { GPIO_PIN_RESET = 0, GPIO_PIN_SET } GPIO_PinState;
+typedef enum { EXTI0_IRQn = 6, EXTI1_IRQn, EXTI2_IRQn, EXTI3_IRQn, EXTI4_IRQn } IRQn_Type;
+
+typedef struct { uint32_t dummy; } GPIO_TypeDef;
+typedef struct { uint32_t dummy; } SPI_HandleTypeDef;
+typedef struct { uint32_t dummy; } UART_HandleTypeDef;
+
+typedef struct
+{
+	uint32_t Pin;
+	uint32_t Mode;
+	uint32_t Pull;
+	uint32_t Speed;
+	uint32_t Alternate;
+} GPIO_InitTypeDef;
+
+#define GPIO_PIN_0				((uint16_t)0x0001)
+#define GPIO_PIN_1				((uint16_t)0x0002)
+#define GPIO_PIN_2				((uint16_t)0x0004)
+#define GPIO_PIN_3				((uint16_t)0x0008)
+#define GPIO_PIN_4				((uint16_t)0x0010)
+#define GPIO_MODE_IT_FALLING	((uint32_t)0x10210000)
+#define GPIO_NOPULL				((uint32_t)0x00000000)
+#define GPIO_SPEED_LOW			((uint32_t)0x00000000)
+
+extern GPIO_TypeDef hostGpio;
+#define GPIOA	(&hostGpio)
+#define GPIOB	(&hostGpio)
+#define GPIOE	(&hostGpio)
+#define GPIOH	(&hostGpio)
+#define __GPIOA_CLK_ENABLE()
+#define __GPIOB_CLK_ENABLE()
+#define __GPIOE_CLK_ENABLE()
+#define __GPIOH_CLK_ENABLE()
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init);
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority);
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn);
+
+/* no interrupts on the host, the DMA2D completion is called synchronously */
+#define __get_PRIMASK()			(0u)
+#define __set_PRIMASK(priMask)	((void)(priMask))
+#define __disable_irq()
+
+typedef struct
+{
+	uint32_t PLLSAIN;
+	uint32_t PLLSAIQ;
+	uint32_t PLLSAIR;
+} RCC_PLLSAIInitTypeDef;
+
+typedef struct
+{
+	uint32_t PeriphClockSelection;
+	RCC_PLLSAIInitTypeDef PLLSAI;
+	uint32_t PLLSAIDivQ;
+	uint32_t PLLSAIDivR;
+	uint32_t RTCClockSelection;
+} RCC_PeriphCLKInitTypeDef;
+
+#define RCC_PERIPHCLK_LTDC		((uint32_t)0x00000008)
+#define RCC_PLLSAIDIVR_8		((uint32_t)0x00020000)
+
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef *PeriphClkInit);
+
+/* DMA2D, layouts as in stm32f4xx_hal_dma2d.h */
+
+typedef enum
+{
+	HAL_DMA2D_STATE_RESET   = 0x00U,
+	HAL_DMA2D_STATE_READY   = 0x01U,
+	HAL_DMA2D_STATE_BUSY    = 0x02U,
+	HAL_DMA2D_STATE_TIMEOUT = 0x03U,
+	HAL_DMA2D_STATE_ERROR   = 0x04U
+} HAL_DMA2D_StateTypeDef;
+
+typedef struct
+{
+	uint32_t Mode;
+	uint32_t ColorMode;
+	uint32_t OutputOffset;
+} DMA2D_InitTypeDef;
+
+typedef struct
+{
+	uint32_t InputOffset;
+	uint32_t InputColorMode;
+	uint32_t AlphaMode;
+	uint32_t InputAlpha;
+} DMA2D_LayerCfgTypeDef;
+
+typedef struct { uint32_t dummy; } DMA2D_TypeDef;
+
+typedef struct __DMA2D_HandleTypeDef
+{
+	DMA2D_TypeDef *Instance;
+	DMA2D_InitTypeDef Init;
+	void (* XferCpltCallback)(struct __DMA2D_HandleTypeDef * hdma2d);
+	void (* XferErrorCallback)(struct __DMA2D_HandleTypeDef * hdma2d);
+	DMA2D_LayerCfgTypeDef LayerCfg[2];
+	HAL_StatusTypeDef Lock;
+	__IO HAL_DMA2D_StateTypeDef State;
+	__IO uint32_t ErrorCode;
+} DMA2D_HandleTypeDef;
+
+#define DMA2D_M2M				((uint32_t)0x00000000)
+#define DMA2D_M2M_PFC			((uint32_t)0x00010000)
+#define DMA2D_M2M_BLEND			((uint32_t)0x00020000)
+#define DMA2D_R2M				((uint32_t)0x00030000)
+
+#define DMA2D_ARGB8888			((uint32_t)0x00000000)
+#define DMA2D_RGB888			((uint32_t)0x00000001)
+#define DMA2D_RGB565			((uint32_t)0x00000002)
+#define DMA2D_ARGB1555			((uint32_t)0x00000003)
+#define DMA2D_ARGB4444			((uint32_t)0x00000004)
+
+#define DMA2D_INPUT_ARGB8888	((uint32_t)0x00000000)
+#define DMA2D_INPUT_ARGB4444	((uint32_t)0x00000004)
+
+extern DMA2D_TypeDef hostDma2d;
+#define DMA2D	(&hostDma2d)
+
+HAL_StatusTypeDef HAL_DMA2D_Init(DMA2D_HandleTypeDef *hdma2d);
+HAL_StatusTypeDef HAL_DMA2D_ConfigLayer(DMA2D_HandleTypeDef *hdma2d, uint32_t LayerIdx);
+HAL_StatusTypeDef HAL_DMA2D_Start(DMA2D_HandleTypeDef *hdma2d, uint32_t pdata, uint32_t DstAddress, uint32_t Width, uint32_t Height);
+HAL_StatusTypeDef HAL_DMA2D_Start_IT(DMA2D_HandleTypeDef *hdma2d, uint32_t pdata, uint32_t DstAddress, uint32_t Width, uint32_t Height);
+HAL_StatusTypeDef HAL_DMA2D_PollForTransfer(DMA2D_HandleTypeDef *hdma2d, uint32_t Timeout);
+
+/* LTDC, layouts as in stm32f4xx_hal_ltdc.h */
+
+typedef struct
+{
+	uint8_t Blue;
+	uint8_t Green;
+	uint8_t Red;
+	uint8_t Reserved;
+} LTDC_ColorTypeDef;
+
+typedef struct
+{
+	uint32_t HSPolarity;
+	uint32_t VSPolarity;
+	uint32_t DEPolarity;
+	uint32_t PCPolarity;
+	uint32_t HorizontalSync;
+	uint32_t VerticalSync;
+	uint32_t AccumulatedHBP;
+	uint32_t AccumulatedVBP;
+	uint32_t AccumulatedActiveW;
+	uint32_t AccumulatedActiveH;
+	uint32_t TotalWidth;
+	uint32_t TotalHeigh;
+	LTDC_ColorTypeDef Backcolor;
+} LTDC_InitTypeDef;
+
+typedef struct
+{
+	uint32_t WindowX0;
+	uint32_t WindowX1;
+	uint32_t WindowY0;
+	uint32_t WindowY1;
+	uint32_t PixelFormat;
+	uint32_t Alpha;
+	uint32_t Alpha0;
+	uint32_t BlendingFactor1;
+	uint32_t BlendingFactor2;
+	uint32_t FBStartAdress;
+	uint32_t ImageWidth;
+	uint32_t ImageHeight;
+	LTDC_ColorTypeDef Backcolor;
+} LTDC_LayerCfgTypeDef;
+
+typedef struct
+{
+	__IO uint32_t CPSR;
+} LTDC_TypeDef;
+
+typedef struct
+{
+	LTDC_TypeDef *Instance;
+	LTDC_InitTypeDef Init;
+	LTDC_LayerCfgTypeDef LayerCfg[2];
+	HAL_StatusTypeDef Lock;
+	uint32_t State;
+	__IO uint32_t ErrorCode;
+} LTDC_HandleTypeDef;
+
+#define LTDC_HSPOLARITY_AL			((uint32_t)0x00000000)
+#define LTDC_VSPOLARITY_AL			((uint32_t)0x00000000)
+#define LTDC_DEPOLARITY_AL			((uint32_t)0x00000000)
+#define LTDC_PCPOLARITY_IPC			((uint32_t)0x00000000)
+#define LTDC_PCPOLARITY_IIPC		((uint32_t)0x10000000)
+#define LTDC_PIXEL_FORMAT_ARGB8888	((uint32_t)0x00000000)
+#define LTDC_PIXEL_FORMAT_AL88		((uint32_t)0x00000007)
+#define LTDC_BLENDING_FACTOR1_PAxCA	((uint32_t)0x00000600)
+#define LTDC_BLENDING_FACTOR2_PAxCA	((uint32_t)0x00000007)
+#define LTDC_CPSR_CYPOS				((uint32_t)0x0000FFFF)
+
+extern LTDC_TypeDef hostLtdc;
+#define LTDC	(&hostLtdc)
+
+HAL_StatusTypeDef HAL_LTDC_Init(LTDC_HandleTypeDef *hltdc);
+HAL_StatusTypeDef HAL_LTDC_ConfigLayer(LTDC_HandleTypeDef *hltdc, LTDC_LayerCfgTypeDef *pLayerCfg, uint32_t LayerIdx);
+HAL_StatusTypeDef HAL_LTDC_ConfigCLUT(LTDC_HandleTypeDef *hltdc, uint32_t *pCLUT, uint32_t CLUTSize, uint32_t LayerIdx);
+HAL_StatusTypeDef HAL_LTDC_EnableCLUT(LTDC_HandleTypeDef *hltdc, uint32_t LayerIdx);
+HAL_StatusTypeDef HAL_LTDC_SetAddress(LTDC_HandleTypeDef *hltdc, uint32_t Address, uint32_t LayerIdx);
+HAL_StatusTypeDef HAL_LTDC_SetAlpha(LTDC_HandleTypeDef *hltdc, uint32_t Alpha, uint32_t LayerIdx);
+HAL_StatusTypeDef HAL_LTDC_SetWindowSize(LTDC_HandleTypeDef *hltdc, uint32_t XSize, uint32_t YSize, uint32_t LayerIdx);
+HAL_StatusTypeDef HAL_LTDC_SetWindowPosition(LTDC_HandleTypeDef *hltdc, uint32_t X0, uint32_t Y0, uint32_t LayerIdx);
+
+#endif /* HOSTSIM_STM32F4XX_HAL_H */
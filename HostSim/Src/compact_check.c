@@ -0,0 +1,327 @@
+///////////////////////////////////////////////////////////////////////////////
+/// -*- coding: UTF-8 -*-
+///
+/// \file   HostSim/Src/compact_check.c
+/// \brief  Round trip check of the compact logbook sample encoding
+/// \author heinrichs weikamp gmbh
+/// \date   17-Oct-2026
+///
+/// \details
+///	Builds standard samples as logbook_writeSample() lays them out, with
+///	random walks and jumps to the limits of every field and random events,
+///	encodes them with compact_encodeSample() of logbook_compact.c and decodes
+///	the stream again with compact_decodeSample(). Every decoded sample has to
+///	equal the standard sample byte by byte. This is done for the divisors of
+///	the firmware, with and without bottle sensor, and for random divisors.
+///	Returns non zero on a difference.
+///
+/// $Id$
+///////////////////////////////////////////////////////////////////////////////
+///     This program is free software: you can redistribute it and/or modify
+///     it under the terms of the GNU General Public License as published by
+///     the Free Software Foundation, either version 3 of the License, or
+///     (at your option) any later version.
+///
+///     This program is distributed in the hope that it will be useful,
+///     but WITHOUT ANY WARRANTY; without even the implied warranty of
+///     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///     GNU General Public License for more details.
+///
+///     You should have received a copy of the GNU General Public License
+///     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+
+#include "logbook_compact.h"
+
+#define CHECK_SAMPLES		(5000)
+#define CHECK_MAX_EVENTS	(127 - 32)	/* 7 bit length of a standard sample minus all fields */
+
+typedef struct
+{
+	const uint8_t *pData;
+	uint32_t index;
+	uint32_t size;
+	_Bool overrun;
+} SCheckStream;
+
+static uint8_t compactStream[CHECK_SAMPLES * COMPACT_SAMPLE_SIZE];
+static uint8_t standardSamples[CHECK_SAMPLES][COMPACT_SAMPLE_SIZE];
+static uint16_t standardLength[CHECK_SAMPLES];
+static uint32_t randomState = 0x4F535443;
+
+static uint32_t check_random(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+/* mostly small steps, sometimes a jump anywhere in the range of the field */
+static int32_t check_walk(int32_t value, int32_t min, int32_t max, int32_t step)
+{
+	switch(check_random() % 64)
+	{
+		case 0:		return min;
+		case 1:		return max;
+		case 2:		return min + (int32_t)(check_random() % (uint32_t)(max - min + 1));
+		default:	break;
+	}
+	value += (int32_t)(check_random() % (uint32_t)(2 * step + 1)) - step;
+	if(value < min)
+		value = min;
+	if(value > max)
+		value = max;
+	return value;
+}
+
+static void check_u16(uint8_t *pos, int32_t value)
+{
+	pos[0] = value & 0xFF;
+	pos[1] = (value >> 8) & 0xFF;
+}
+
+static void check_read(void *pContext, uint8_t *pTarget, uint16_t length)
+{
+	SCheckStream *pStream = pContext;
+
+	while(length--)
+	{
+		if(pStream->index < pStream->size)
+			*pTarget++ = pStream->pData[pStream->index++];
+		else
+		{
+			*pTarget++ = 0xFF;
+			pStream->overrun = 1;
+		}
+	}
+}
+
+/* standard samples in the order of logbook_writeSample(), returns the length of the compact stream */
+static uint32_t check_encode(const SSmallHeader *pSmallHeader, uint32_t *pStandardBytes)
+{
+	SDivisor divisor;
+	SCompactState last;
+	SSampleLayout layout;
+	int32_t depth = 0, temperature = 200, ppo2[3] = { 21, 21, 21 }, voltage[3] = { 900, 900, 900 }, cns = 0, tank = 200;
+	uint8_t decoNdl[2] = { 0, 99 };
+	uint8_t decoplan[15] = { 0 };
+	uint8_t eventLength;
+	uint8_t fields;
+	uint32_t compactBytes = 0;
+	uint8_t *pSample;
+	uint16_t length;
+
+	compact_setDivisor(&divisor, pSmallHeader);
+	memset(&last, 0, sizeof(last));
+	*pStandardBytes = 0;
+
+	for(int n = 0; n < CHECK_SAMPLES; n++)
+	{
+		pSample = standardSamples[n];
+		memset(&layout, 0, sizeof(layout));
+		fields = compact_nextSampleFields(&divisor, pSmallHeader);
+
+		depth = check_walk(depth, 0, 0xFFFF, 30);
+		check_u16(&pSample[0], depth);
+		length = 3;
+
+		eventLength = 0;
+		if((check_random() % 5) == 0)
+			eventLength = 1 + ((check_random() % 8) ? (check_random() % 12) : (check_random() % CHECK_MAX_EVENTS));
+		for(int i = 0; i < eventLength; i++)
+			pSample[length++] = check_random();
+		layout.eventEnd = length;
+
+		if(fields & SAMPLE_TEMPERATURE)
+		{
+			temperature = check_walk(temperature, -32768, 32767, 3);
+			layout.temperature = length;
+			check_u16(&pSample[length], temperature);
+			length += 2;
+		}
+		if(fields & SAMPLE_DECO_NDL)
+		{
+			if((check_random() % 4) == 0)
+			{
+				decoNdl[0] = check_random();
+				decoNdl[1] = check_random();
+			}
+			layout.decoNdl = length;
+			memcpy(&pSample[length], decoNdl, 2);
+			length += 2;
+		}
+		if(fields & SAMPLE_PPO2)
+		{
+			layout.ppo2 = length;
+			for(int i = 0; i < 3; i++)
+			{
+				ppo2[i] = check_walk(ppo2[i], 0, 0xFF, 4);
+				voltage[i] = check_walk(voltage[i], 0, 0xFFFF, 20);
+				pSample[length++] = ppo2[i];
+				check_u16(&pSample[length], voltage[i]);
+				length += 2;
+			}
+		}
+		if(fields & SAMPLE_DECOPLAN)
+		{
+			if((check_random() % 3) == 0)
+				decoplan[check_random() % 15] = check_random();
+			layout.decoplan = length;
+			memcpy(&pSample[length], decoplan, 15);
+			length += 15;
+		}
+		if(fields & SAMPLE_CNS)
+		{
+			cns = check_walk(cns, 0, 0xFFFF, 2);
+			layout.cns = length;
+			check_u16(&pSample[length], cns);
+			length += 2;
+		}
+		if(fields & SAMPLE_TANK)
+		{
+			tank = check_walk(tank, -32768, 32767, 5);
+			layout.tank = length;
+			check_u16(&pSample[length], tank);
+			length += pSmallHeader->tankLength;
+		}
+		pSample[2] = length - 3;
+		if(eventLength)
+			pSample[2] |= 0x80;
+
+		standardLength[n] = length;
+		*pStandardBytes += length;
+		compactBytes += compact_encodeSample(pSample, &layout, &last, &compactStream[compactBytes]);
+	}
+	compactStream[compactBytes++] = COMPACT_END_MARKER;
+	compactStream[compactBytes++] = COMPACT_END_MARKER;
+	return compactBytes;
+}
+
+/* decodes the stream as logbook_decodeCompactSample() does, returns the number of differences */
+static int check_decode(const SSmallHeader *pSmallHeader, uint32_t compactBytes)
+{
+	SCheckStream stream = { compactStream, 0, compactBytes, 0 };
+	SDivisor divisor;
+	SCompactState last;
+	uint8_t sample[COMPACT_SAMPLE_SIZE];
+	uint8_t control;
+	uint8_t fields;
+	uint16_t length;
+	int differences = 0;
+
+	compact_setDivisor(&divisor, pSmallHeader);
+	memset(&last, 0, sizeof(last));
+
+	for(int n = 0; n < CHECK_SAMPLES; n++)
+	{
+		check_read(&stream, &control, 1);
+		if(control == COMPACT_END_MARKER)
+		{
+			printf("  end marker at sample %d\n", n);
+			return differences + 1;
+		}
+		fields = compact_nextSampleFields(&divisor, pSmallHeader);
+		length = compact_decodeSample(control, fields, pSmallHeader, &last, check_read, &stream, sample);
+		if((length != standardLength[n]) || memcmp(sample, standardSamples[n], length))
+		{
+			if(differences < 10)
+				printf("  sample %d: length %u, expected %u\n", n, length, standardLength[n]);
+			differences++;
+		}
+	}
+
+	check_read(&stream, &control, 1);
+	if((control != COMPACT_END_MARKER) || stream.overrun || (stream.index + 1 != compactBytes))
+	{
+		printf("  stream not consumed exactly: %u of %u bytes\n", stream.index, compactBytes);
+		differences++;
+	}
+	return differences;
+}
+
+static int check_profile(const char *pName, const SSmallHeader *pSmallHeader)
+{
+	uint32_t standardBytes;
+	uint32_t compactBytes = check_encode(pSmallHeader, &standardBytes);
+	int differences = check_decode(pSmallHeader, compactBytes);
+
+	printf("%-16s %u samples, %u standard bytes, %u compact bytes (%.1f%%), %d differences\n", pName, CHECK_SAMPLES,
+			standardBytes, compactBytes, 100.0 * compactBytes / standardBytes, differences);
+	return differences;
+}
+
+/* the divisors of logbook_initNewdiveProfile() */
+static void check_firmware_header(SSmallHeader *pSmallHeader, _Bool bottleSensor)
+{
+	memset(pSmallHeader, 0, sizeof(SSmallHeader));
+	pSmallHeader->samplingRate_seconds = 2;
+	pSmallHeader->numDivisors = 7;
+	pSmallHeader->tempLength = 2;
+	pSmallHeader->tempDivisor = 6;
+	pSmallHeader->deco_ndlLength = 2;
+	pSmallHeader->deco_ndlDivisor = 6;
+	pSmallHeader->gfLength = 1;
+	pSmallHeader->ppo2Length = 9;
+	pSmallHeader->ppo2Divisor = 2;
+	pSmallHeader->decoplanLength = 15;
+	pSmallHeader->decoplanDivisor = 12;
+	pSmallHeader->cnsLength = 2;
+	pSmallHeader->cnsDivisor = 12;
+	if(bottleSensor)
+	{
+		pSmallHeader->tankLength = 2;
+		pSmallHeader->tankDivisor = 30;
+	}
+}
+
+int main(void)
+{
+	SSmallHeader smallHeader;
+	int differences = 0;
+
+	check_firmware_header(&smallHeader, 0);
+	differences += check_profile("firmware", &smallHeader);
+
+	check_firmware_header(&smallHeader, 1);
+	differences += check_profile("bottle sensor", &smallHeader);
+
+	/* every field in every sample */
+	check_firmware_header(&smallHeader, 1);
+	smallHeader.tempDivisor = smallHeader.deco_ndlDivisor = smallHeader.ppo2Divisor = 1;
+	smallHeader.decoplanDivisor = smallHeader.cnsDivisor = smallHeader.tankDivisor = 1;
+	differences += check_profile("all fields", &smallHeader);
+
+	/* random divisors, the optional fields may be switched off */
+	for(int i = 0; i < 4; i++)
+	{
+		check_firmware_header(&smallHeader, 1);
+		smallHeader.tempDivisor = 1 + check_random() % 10;
+		smallHeader.deco_ndlDivisor = check_random() % 10;
+		smallHeader.ppo2Divisor = check_random() % 10;
+		smallHeader.decoplanDivisor = check_random() % 20;
+		smallHeader.cnsDivisor = 1 + check_random() % 20;
+		smallHeader.tankDivisor = check_random() % 40;
+		differences += check_profile("random divisors", &smallHeader);
+	}
+
+	/* erased flash and an unknown control byte end the profile */
+	{
+		SCheckStream stream = { compactStream, 0, sizeof(compactStream), 0 };
+		SCompactState last;
+		uint8_t sample[COMPACT_SAMPLE_SIZE];
+
+		memset(&last, 0, sizeof(last));
+		if((compact_decodeSample(0xFF, 0x3F, &smallHeader, &last, check_read, &stream, sample) != 0)
+			|| (compact_decodeSample(COMPACT_CONTROL_MASK + 1, 0x3F, &smallHeader, &last, check_read, &stream, sample) != 0))
+		{
+			printf("broken control byte accepted\n");
+			differences++;
+		}
+	}
+
+	return differences ? 1 : 0;
+}
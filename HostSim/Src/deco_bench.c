@@ -0,0 +1,509 @@
+///////////////////////////////////////////////////////////////////////////////
+/// -*- coding: UTF-8 -*-
+///
+/// \file   HostSim/Src/deco_bench.c
+/// \brief  Host benchmark for buehlmann_calc_deco() and vpm_calc()
+/// \author heinrichs weikamp gmbh
+/// \date   17-Oct-2026
+///
+/// \details
+///	Builds tissue states for a small corpus of canned dive profiles and times
+///	the deco calculations that deco_loop() in base.c runs on the target.
+///	Every line of the report holds the result of the calculation (TTS, NDL,
+///	number of stops, VPM critical volume iterations) next to the time per
+///	call, so a change in timing and a change in the schedule are both visible
+///	when the output of two commits is compared.
+///
+/// $Id$
+///////////////////////////////////////////////////////////////////////////////
+///     This program is free software: you can redistribute it and/or modify
+///     it under the terms of the GNU General Public License as published by
+///     the Free Software Foundation, either version 3 of the License, or
+///     (at your option) any later version.
+///
+///     This program is distributed in the hope that it will be useful,
+///     but WITHOUT ANY WARRANTY; without even the implied warranty of
+///     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///     GNU General Public License for more details.
+///
+///     You should have received a copy of the GNU General Public License
+///     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "data_central.h"
+#include "decom.h"
+#include "calc_crush.h"
+#include "buehlmann.h"
+#include "vpm.h"
+#include "deco_engine.h"
+
+#define BENCH_DEFAULT_LOOPS			(200)
+#define BENCH_DESCENT_RATE_METER	(20)
+#define BENCH_MAX_DECO_GASES		(3)
+
+typedef struct
+{
+	uint8_t oxygen_percentage;
+	uint8_t helium_percentage;
+	uint8_t depth_meter;
+} SBenchGas;
+
+typedef struct
+{
+	const char *name;
+	uint8_t diveMode;
+	uint8_t depth_meter;
+	uint16_t bottom_minutes;				/* run time at the end of the bottom phase */
+	SBenchGas bottom;						/* bottom gas (OC) or diluent (CCR) */
+	uint8_t setpoint_cbar;
+	SBenchGas deco[BENCH_MAX_DECO_GASES];	/* depth_meter == 0 => unused */
+	uint16_t surface_interval_minutes;		/* > 0 => same dive is repeated after this interval */
+	float residual_helium_bar;				/* He left in all compartments by an earlier trimix dive */
+} SBenchProfile;
+
+typedef struct
+{
+	SLifeData lifeData;
+	SDiveSettings diveSettings;
+	SVpm vpm;
+} SBenchState;
+
+static const SBenchProfile benchProfiles[] =
+{
+	{ "ndl_18m_air",	DIVEMODE_OC,	18,	40,	{21, 0, 0},	0,		{{0}},										0 },
+	{ "ndl_30m_ean32",	DIVEMODE_OC,	30,	20,	{32, 0, 0},	0,		{{0}},										0 },
+	{ "deco_45m_air",	DIVEMODE_OC,	45,	30,	{21, 0, 0},	0,		{{50, 0, 21}},								0 },
+	{ "tmx_70m",		DIVEMODE_OC,	70,	25,	{18, 45, 0},	0,		{{35, 25, 36}, {50, 0, 21}, {100, 0, 6}},	0 },
+	{ "ccr_100m",		DIVEMODE_CCR,	100,	30,	{10, 70, 0},	130,	{{0}},										0 },
+	{ "rep_40m_air",	DIVEMODE_OC,	40,	25,	{21, 0, 0},	0,		{{50, 0, 21}},								60 },
+	{ "ndl_12m_he1mbar",	DIVEMODE_OC,	12,	20,	{21, 0, 0},	0,		{{0}},										0,	0.001f },
+	{ "ndl_18m_he1mbar",	DIVEMODE_OC,	18,	20,	{21, 0, 0},	0,		{{0}},										0,	0.001f },
+	{ "ndl_12m_he50mbar",	DIVEMODE_OC,	12,	20,	{21, 0, 0},	0,		{{0}},										0,	0.05f },
+};
+
+static uint32_t benchLoops = BENCH_DEFAULT_LOOPS;
+static _Bool benchVerbose = false;
+static int benchWorkers = 0;
+
+static uint64_t bench_now_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static void bench_set_gas_line(SGasLine *pGas, const SBenchGas *pInput, _Bool first)
+{
+	memset(pGas, 0, sizeof(SGasLine));
+	pGas->oxygen_percentage = pInput->oxygen_percentage;
+	pGas->helium_percentage = pInput->helium_percentage;
+	pGas->depth_meter = pInput->depth_meter;
+	pGas->note.ub.active = 1;
+	pGas->note.ub.first = first;
+	pGas->note.ub.deco = !first;
+#ifdef ENABLE_DECOCALC_OPTION
+	pGas->note.ub.decocalc = 1;
+#endif
+}
+
+static void bench_init_state(const SBenchProfile *pProfile, SBenchState *pState)
+{
+	uint8_t gasStart = (pProfile->diveMode == DIVEMODE_OC) ? 1 : 1 + NUM_OFFSET_DILUENT;
+	SDiveSettings *pSettings = &pState->diveSettings;
+	SLifeData *pLife = &pState->lifeData;
+
+	memset(pState, 0, sizeof(SBenchState));
+
+	pSettings->diveMode = pProfile->diveMode;
+	pSettings->CCR_Mode = CCRMODE_FixedSetpoint;
+	pSettings->ascentRate_meterperminute = 10;
+	pSettings->last_stop_depth_bar = 0.3f;
+	pSettings->input_next_stop_increment_depth_bar = 0.3f;
+	pSettings->input_second_to_last_stop_depth_bar = 0.6f;
+	pSettings->gf_low = 30;
+	pSettings->gf_high = 85;
+	pSettings->vpm_conservatism = 1;
+	pSettings->future_TTS_minutes = 5;
+
+	bench_set_gas_line(&pSettings->gas[gasStart], &pProfile->bottom, true);
+	for(int i = 0; i < BENCH_MAX_DECO_GASES; i++)
+	{
+		if(pProfile->deco[i].depth_meter)
+			bench_set_gas_line(&pSettings->gas[gasStart + 1 + i], &pProfile->deco[i], false);
+	}
+	pSettings->setpoint[1].setpoint_cbar = pProfile->setpoint_cbar;
+
+	pLife->pressure_surface_bar = 1.0f;
+	pLife->pressure_ambient_bar = 1.0f;
+	decom_reset_with_1000mbar(pLife);
+	for(int i = 0; i < 16; i++)
+		pLife->tissue_helium_bar[i] = pProfile->residual_helium_bar;
+
+	vpm_init(&pState->vpm, pSettings->vpm_conservatism, 0, 0);
+}
+
+static void bench_set_actual_gas(const SBenchProfile *pProfile, SBenchState *pState)
+{
+	SGas *pGas = &pState->lifeData.actualGas;
+
+	pGas->nitrogen_percentage = 100 - pProfile->bottom.oxygen_percentage - pProfile->bottom.helium_percentage;
+	pGas->helium_percentage = pProfile->bottom.helium_percentage;
+	pGas->setPoint_cbar = pProfile->setpoint_cbar;
+	pGas->change_during_ascent_depth_meter_otherwise_zero = 0;
+	pGas->GasIdInSettings = (pProfile->diveMode == DIVEMODE_OC) ? 1 : 1 + NUM_OFFSET_DILUENT;
+	pGas->AppliedDiveMode = pProfile->diveMode;
+}
+
+/* descent and bottom phase; crushing pressure is sampled like vpm_crush() in data_central.c */
+static void bench_dive(const SBenchProfile *pProfile, SBenchState *pState)
+{
+	SLifeData *pLife = &pState->lifeData;
+	float initial_helium_pressure[16];
+	float initial_nitrogen_pressure[16];
+	float starting_ambient_pressure = 0;
+	int32_t crush_window_start = 0;
+	int32_t bottom_seconds = pProfile->bottom_minutes * 60;
+	float target_bar = pLife->pressure_surface_bar + pProfile->depth_meter / 10.0f;
+
+	bench_set_actual_gas(pProfile, pState);
+	pLife->dive_time_seconds = 0;
+	pLife->max_depth_meter = 0;
+
+	while((pLife->pressure_ambient_bar < target_bar) && (pLife->dive_time_seconds < bottom_seconds))
+	{
+		if(crush_window_start == pLife->dive_time_seconds)
+		{
+			starting_ambient_pressure = pLife->pressure_ambient_bar * 10;
+			memcpy(initial_helium_pressure, pLife->tissue_helium_bar, sizeof(initial_helium_pressure));
+			memcpy(initial_nitrogen_pressure, pLife->tissue_nitrogen_bar, sizeof(initial_nitrogen_pressure));
+			for(int i = 0; i < 16; i++)
+			{
+				initial_helium_pressure[i] *= 10;
+				initial_nitrogen_pressure[i] *= 10;
+			}
+		}
+		pLife->dive_time_seconds++;
+		pLife->pressure_ambient_bar += BENCH_DESCENT_RATE_METER / 600.0f;
+		if(pLife->pressure_ambient_bar > target_bar)
+			pLife->pressure_ambient_bar = target_bar;
+		decom_tissues_exposure(1, pLife);
+
+		if(pLife->dive_time_seconds - crush_window_start >= 4)
+		{
+			float rate = (pLife->pressure_ambient_bar * 10 - starting_ambient_pressure) * 60 / 4;
+			calc_crushing_pressure(pLife, &pState->vpm, initial_helium_pressure, initial_nitrogen_pressure, starting_ambient_pressure, rate);
+			crush_window_start = pLife->dive_time_seconds;
+		}
+	}
+	decom_tissues_exposure(bottom_seconds - pLife->dive_time_seconds, pLife);
+	pLife->dive_time_seconds = bottom_seconds;
+	pLife->dive_time_seconds_without_surface_time = bottom_seconds;
+	pLife->depth_meter = (pLife->pressure_ambient_bar - pLife->pressure_surface_bar) * 10.0f;
+	pLife->max_depth_meter = pLife->depth_meter;
+
+	decom_CreateGasChangeList(&pState->diveSettings, pLife);
+}
+
+static void bench_build(const SBenchProfile *pProfile, SBenchState *pState)
+{
+	SDecoinfo decoInfo;
+
+	bench_init_state(pProfile, pState);
+	bench_dive(pProfile, pState);
+
+	if(pProfile->surface_interval_minutes)
+	{
+		/* finish the first dive with a VPM ascent, then off-gas on air at the surface */
+		vpm_calc(&pState->lifeData, &pState->diveSettings, &pState->vpm, &decoInfo, DECOSTOPS);
+		vpm_saturation_after_ascent(&pState->lifeData);
+		pState->lifeData.actualGas.nitrogen_percentage = 79;
+		pState->lifeData.actualGas.helium_percentage = 0;
+		pState->lifeData.actualGas.AppliedDiveMode = DIVEMODE_OC;
+		decom_tissues_exposure(pProfile->surface_interval_minutes * 60, &pState->lifeData);
+		vpm_init(&pState->vpm, pState->diveSettings.vpm_conservatism, 1, pProfile->surface_interval_minutes * 60);
+		bench_dive(pProfile, pState);
+	}
+}
+
+static int bench_count_stops(const SDecoinfo *pDecoInfo)
+{
+	int stops = 0;
+
+	for(int i = 0; i < DECOINFO_STRUCT_MAX_STOPS; i++)
+	{
+		if(pDecoInfo->output_stop_length_seconds[i])
+			stops++;
+	}
+	return stops;
+}
+
+static void bench_print_stops(const SDiveSettings *pSettings, const SDecoinfo *pDecoInfo)
+{
+	printf("    stops:");
+	for(int i = DECOINFO_STRUCT_MAX_STOPS - 1; i >= 0; i--)
+	{
+		float depth;
+
+		if(!pDecoInfo->output_stop_length_seconds[i])
+			continue;
+		if(i == 0)
+			depth = pSettings->last_stop_depth_bar;
+		else
+			depth = pSettings->input_second_to_last_stop_depth_bar + (i - 1) * pSettings->input_next_stop_increment_depth_bar;
+		printf(" %dm:%us", (int)(depth * 10.0f + 0.5f), pDecoInfo->output_stop_length_seconds[i]);
+	}
+	printf("\n");
+}
+
+static void bench_report(const char *pName, const char *pModel, const SBenchState *pState, const SDecoinfo *pDecoInfo, int iterations, uint64_t elapsed_ns)
+{
+	char iterationText[12] = "-";
+
+	if(iterations >= 0)
+		snprintf(iterationText, sizeof(iterationText), "%d", iterations);
+
+	printf("%-16s %-10s %-5s %8.1f %8.1f %6d %5s %12.0f\n",
+			pName, pModel,
+			(pDecoInfo->output_time_to_surface_seconds) ? "deco" : "ndl",
+			pDecoInfo->output_time_to_surface_seconds / 60.0f,
+			pDecoInfo->output_ndl_seconds / 60.0f,
+			bench_count_stops(pDecoInfo),
+			iterationText,
+			(double)elapsed_ns / benchLoops);
+
+	if(benchVerbose)
+		bench_print_stops(&pState->diveSettings, pDecoInfo);
+}
+
+static void bench_buehlmann(const SBenchProfile *pProfile, const SBenchState *pTemplate, _Bool future)
+{
+	SBenchState state;
+	SDecoinfo decoInfo;
+	uint64_t start;
+	uint64_t elapsed = 0;
+
+	for(uint32_t loop = 0; loop < benchLoops; loop++)
+	{
+		memcpy(&state, pTemplate, sizeof(SBenchState));
+		start = bench_now_ns();
+		if(future)
+			decom_tissues_exposure(state.diveSettings.future_TTS_minutes * 60, &state.lifeData);
+		buehlmann_init();	/* full calculation, no warm start from the previous loop */
+		buehlmann_calc_deco(&state.lifeData, &state.diveSettings, &decoInfo);
+		elapsed += bench_now_ns() - start;
+	}
+	bench_report(pProfile->name, future ? "gf_future" : "gf", &state, &decoInfo, -1, elapsed);
+}
+
+/* consecutive deco_loop() cycles: the dive continues for one second between two calculations.
+ * The sequence is run with full calculations first, then with warm start, and the results are compared. */
+static void bench_buehlmann_sequence(const SBenchProfile *pProfile, const SBenchState *pTemplate)
+{
+	SBenchState state;
+	SDecoinfo decoInfo;
+	SDecoinfo *pResultCold;
+	uint64_t start;
+	uint64_t elapsed;
+	uint32_t mismatch = 0;
+
+	pResultCold = calloc(benchLoops, sizeof(SDecoinfo));
+	if(pResultCold == NULL)
+		return;
+
+	memcpy(&state, pTemplate, sizeof(SBenchState));
+	elapsed = 0;
+	for(uint32_t loop = 0; loop < benchLoops; loop++)
+	{
+		decom_tissues_exposure(1, &state.lifeData);
+		state.lifeData.dive_time_seconds_without_surface_time++;
+		start = bench_now_ns();
+		buehlmann_init();
+		buehlmann_calc_deco(&state.lifeData, &state.diveSettings, &pResultCold[loop]);
+		elapsed += bench_now_ns() - start;
+	}
+	bench_report(pProfile->name, "gf_cold", &state, &pResultCold[benchLoops - 1], -1, elapsed);
+
+	memcpy(&state, pTemplate, sizeof(SBenchState));
+	memset(&decoInfo, 0, sizeof(SDecoinfo));
+	buehlmann_init();
+	elapsed = 0;
+	for(uint32_t loop = 0; loop < benchLoops; loop++)
+	{
+		decom_tissues_exposure(1, &state.lifeData);
+		state.lifeData.dive_time_seconds_without_surface_time++;
+		start = bench_now_ns();
+		buehlmann_calc_deco(&state.lifeData, &state.diveSettings, &decoInfo);
+		elapsed += bench_now_ns() - start;
+
+		if((decoInfo.output_time_to_surface_seconds != pResultCold[loop].output_time_to_surface_seconds)
+			|| (decoInfo.output_ndl_seconds != pResultCold[loop].output_ndl_seconds)
+			|| memcmp(decoInfo.output_stop_length_seconds, pResultCold[loop].output_stop_length_seconds, sizeof(decoInfo.output_stop_length_seconds)))
+		{
+			mismatch++;
+		}
+	}
+	bench_report(pProfile->name, "gf_warm", &state, &decoInfo, -1, elapsed);
+	if(mismatch)
+		printf("    warm start differs from full calculation in %u of %u cycles\n", mismatch, benchLoops);
+
+	free(pResultCold);
+}
+
+static void bench_vpm(const SBenchProfile *pProfile, const SBenchState *pTemplate, _Bool future)
+{
+	SBenchState state;
+	SDecoinfo decoInfo;
+	uint64_t start;
+	uint64_t elapsed = 0;
+	int iterations = 0;
+
+	/* vpm.c keeps the result of the previous call (NDL or deco) in a static, prime it for this profile */
+	memcpy(&state, pTemplate, sizeof(SBenchState));
+	vpm_calc(&state.lifeData, &state.diveSettings, &state.vpm, &decoInfo, future ? FUTURESTOPS : DECOSTOPS);
+
+	for(uint32_t loop = 0; loop < benchLoops; loop++)
+	{
+		memcpy(&state, pTemplate, sizeof(SBenchState));
+		start = bench_now_ns();
+		if(future)
+			decom_tissues_exposure(state.diveSettings.future_TTS_minutes * 60, &state.lifeData);
+		vpm_calc(&state.lifeData, &state.diveSettings, &state.vpm, &decoInfo, future ? FUTURESTOPS : DECOSTOPS);
+		elapsed += bench_now_ns() - start;
+		iterations = vpm_get_critical_volume_iterations();
+	}
+	bench_report(pProfile->name, future ? "vpm_future" : "vpm", &state, &decoInfo, iterations, elapsed);
+}
+
+/* the 1 s sequence of bench_buehlmann_sequence() as one batch through deco_engine, first in this
+ * process, then on the worker pool. Both runs have to return identical results. */
+static void bench_engine(const SBenchProfile *pProfile, const SBenchState *pTemplate)
+{
+	SDecoSnapshot *pSnapshot;
+	SDecoResult *pResultSerial;
+	SDecoResult *pResultPool;
+	char model[16];
+	uint64_t start;
+	uint64_t elapsed;
+	uint32_t mismatch = 0;
+
+	pSnapshot = calloc(benchLoops, sizeof(SDecoSnapshot));
+	pResultSerial = calloc(benchLoops, sizeof(SDecoResult));
+	pResultPool = calloc(benchLoops, sizeof(SDecoResult));
+	if((pSnapshot == NULL) || (pResultSerial == NULL) || (pResultPool == NULL))
+	{
+		free(pSnapshot);
+		free(pResultSerial);
+		free(pResultPool);
+		return;
+	}
+
+	for(uint32_t loop = 0; loop < benchLoops; loop++)
+	{
+		SDecoSnapshot *pState = &pSnapshot[loop];
+
+		if(loop == 0)
+		{
+			memcpy(&pState->lifeData, &pTemplate->lifeData, sizeof(SLifeData));
+			memcpy(&pState->diveSettings, &pTemplate->diveSettings, sizeof(SDiveSettings));
+			memcpy(&pState->vpm, &pTemplate->vpm, sizeof(SVpm));
+		}
+		else
+		{
+			memcpy(pState, &pSnapshot[loop - 1], sizeof(SDecoSnapshot));
+		}
+		decom_tissues_exposure(1, &pState->lifeData);
+		pState->lifeData.dive_time_seconds_without_surface_time++;
+		pState->lifeData.dive_time_seconds++;
+	}
+
+	deco_engine_init(0);
+	start = bench_now_ns();
+	deco_engine_run(pSnapshot, pResultSerial, benchLoops);
+	elapsed = bench_now_ns() - start;
+	bench_report(pProfile->name, "engine_1", pTemplate, &pResultSerial[benchLoops - 1].buehlmann, -1, elapsed);
+
+	if(deco_engine_init(benchWorkers) > 0)
+	{
+		start = bench_now_ns();
+		if(deco_engine_run(pSnapshot, pResultPool, benchLoops))
+			printf("    deco engine failed\n");
+		elapsed = bench_now_ns() - start;
+		snprintf(model, sizeof(model), "engine_j%d", deco_engine_workers());
+		bench_report(pProfile->name, model, pTemplate, &pResultPool[benchLoops - 1].buehlmann, -1, elapsed);
+		deco_engine_exit();
+
+		for(uint32_t loop = 0; loop < benchLoops; loop++)
+		{
+			if(memcmp(&pResultSerial[loop], &pResultPool[loop], sizeof(SDecoResult)))
+				mismatch++;
+		}
+		if(mismatch)
+			printf("    worker pool differs from serial calculation in %u of %u snapshots\n", mismatch, benchLoops);
+	}
+
+	free(pSnapshot);
+	free(pResultSerial);
+	free(pResultPool);
+}
+
+static void bench_usage(const char *pProgram)
+{
+	fprintf(stderr, "usage: %s [-n loops] [-p profile] [-v] [-j workers]\n", pProgram);
+	fprintf(stderr, "  -j  also run the sequence through deco_engine with this many worker processes (-1: one per CPU)\n");
+	fprintf(stderr, "profiles:");
+	for(size_t i = 0; i < sizeof(benchProfiles) / sizeof(benchProfiles[0]); i++)
+		fprintf(stderr, " %s", benchProfiles[i].name);
+	fprintf(stderr, "\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const char *pFilter = NULL;
+	SBenchState template;
+	int option;
+
+	while((option = getopt(argc, argv, "n:p:vj:h")) != -1)
+	{
+		switch(option)
+		{
+			case 'n':	benchLoops = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'p':	pFilter = optarg;
+				break;
+			case 'v':	benchVerbose = true;
+				break;
+			case 'j':	benchWorkers = (int)strtol(optarg, NULL, 0);
+				break;
+			default:	bench_usage(argv[0]);
+				return 1;
+		}
+	}
+	if(benchLoops == 0)
+		benchLoops = 1;
+
+	printf("%-16s %-10s %-5s %8s %8s %6s %5s %12s\n", "profile", "model", "state", "tts_min", "ndl_min", "stops", "iter", "ns/call");
+	for(size_t i = 0; i < sizeof(benchProfiles) / sizeof(benchProfiles[0]); i++)
+	{
+		const SBenchProfile *pProfile = &benchProfiles[i];
+
+		if(pFilter && strcmp(pFilter, pProfile->name))
+			continue;
+
+		bench_build(pProfile, &template);
+		bench_buehlmann(pProfile, &template, false);
+		bench_buehlmann(pProfile, &template, true);
+		bench_buehlmann_sequence(pProfile, &template);
+		bench_vpm(pProfile, &template, false);
+		bench_vpm(pProfile, &template, true);
+		if(benchWorkers)
+			bench_engine(pProfile, &template);
+	}
+	return 0;
+}
@@ -0,0 +1,375 @@
+///////////////////////////////////////////////////////////////////////////////
+/// -*- coding: UTF-8 -*-
+///
+/// \file   HostSim/Src/deco_engine.c
+/// \brief  Parallel host engine for the four deco_loop() calculations
+/// \author heinrichs weikamp gmbh
+/// \date   17-Oct-2026
+///
+/// \details
+///	On the target deco_loop() in base.c runs one of CALC_VPM, CALC_VPM_FUTURE,
+///	CALC_BUEHLMANN and CALC_BUEHLMANN_FUTURE per pass, so the four results
+///	belong to different seconds of the dive. This engine computes all four
+///	for one snapshot of stateDeco and returns them together.
+///
+///	buehlmann.c, vpm.c and decom.c keep their working state in file scope
+///	variables and cannot run twice at the same time in one address space.
+///	The pool therefore consists of forked worker processes, each with its own
+///	copy of that state, fed through pipes. A snapshot is split into two jobs
+///	which keep the order of deco_loop(): VPM followed by VPM future, and
+///	Buehlmann followed by Buehlmann future. A batch of snapshots is spread
+///	over all workers, so planner sweeps scale with the number of cores.
+///
+///	Results do not depend on which worker runs a job: the Buehlmann warm
+///	start is reset per job, a VPM result that depends on the NDL state of the
+///	previous call is recalculated, and the VPM table mode (which follows one
+///	dive over time) is not applied. deco_engine_init(0) runs the same jobs in
+///	the calling process.
+///
+/// $Id$
+///////////////////////////////////////////////////////////////////////////////
+///     This program is free software: you can redistribute it and/or modify
+///     it under the terms of the GNU General Public License as published by
+///     the Free Software Foundation, either version 3 of the License, or
+///     (at your option) any later version.
+///
+///     This program is distributed in the hope that it will be useful,
+///     but WITHOUT ANY WARRANTY; without even the implied warranty of
+///     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///     GNU General Public License for more details.
+///
+///     You should have received a copy of the GNU General Public License
+///     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "deco_engine.h"
+#include "decom.h"
+#include "buehlmann.h"
+#include "vpm.h"
+
+#define ENGINE_MAX_WORKERS	(64)
+
+typedef enum
+{
+	ENGINE_LANE_VPM = 0,
+	ENGINE_LANE_BUEHLMANN,
+	ENGINE_LANE_COUNT
+} EEngineLane;
+
+typedef struct
+{
+	int32_t index;
+	int32_t lane;
+	SDecoSnapshot snapshot;
+} SEngineRequest;
+
+typedef struct
+{
+	int32_t index;
+	int32_t lane;
+	SDecoResult result;
+} SEngineReply;
+
+typedef struct
+{
+	pid_t pid;
+	int requestFd;
+	int replyFd;
+	_Bool busy;
+} SEngineWorker;
+
+static SEngineWorker engineWorker[ENGINE_MAX_WORKERS];
+static int engineWorkers = 0;
+
+/* same sequence as deco_loop() in base.c, on private copies of the snapshot */
+static void engine_calc_lane(const SDecoSnapshot *pSnapshot, EEngineLane lane, SDecoResult *pResult)
+{
+	SDecoSnapshot state;
+
+	memcpy(&state, pSnapshot, sizeof(SDecoSnapshot));
+	state.diveSettings.vpm_tableMode = 0;
+	decom_CreateGasChangeList(&state.diveSettings, &state.lifeData);
+
+	if(lane == ENGINE_LANE_VPM)
+	{
+		/* vpm.c calculates the NDL only if its previous call ended in NDL, repeat once if that state was stale */
+		if((vpm_calc(&state.lifeData, &state.diveSettings, &state.vpm, &pResult->vpm, DECOSTOPS) == CALC_NDL)
+			&& (pResult->vpm.output_ndl_seconds == 0) && (pResult->vpm.output_time_to_surface_seconds == 0)
+			&& (state.lifeData.dive_time_seconds_without_surface_time >= 60))
+		{
+			memcpy(&state.vpm, &pSnapshot->vpm, sizeof(SVpm));
+			vpm_calc(&state.lifeData, &state.diveSettings, &state.vpm, &pResult->vpm, DECOSTOPS);
+		}
+		pResult->vpmCNS = vpm_get_CNS();
+		memcpy(&pResult->vpmState, &state.vpm, sizeof(SVpm));
+
+		memcpy(&state.lifeData, &pSnapshot->lifeData, sizeof(SLifeData));
+		decom_tissues_exposure(state.diveSettings.future_TTS_minutes * 60, &state.lifeData);
+		vpm_calc(&state.lifeData, &state.diveSettings, &state.vpm, &pResult->vpmFuture, FUTURESTOPS);
+	}
+	else
+	{
+		buehlmann_init();
+		buehlmann_calc_deco(&state.lifeData, &state.diveSettings, &pResult->buehlmann);
+		buehlmann_ceiling_calculator(&state.lifeData, &pResult->buehlmann);
+		buehlmann_super_saturation_calculator(&state.lifeData, &pResult->buehlmann);
+
+		memcpy(&state.lifeData, &pSnapshot->lifeData, sizeof(SLifeData));
+		decom_tissues_exposure(state.diveSettings.future_TTS_minutes * 60, &state.lifeData);
+		buehlmann_calc_deco(&state.lifeData, &state.diveSettings, &pResult->buehlmannFuture);
+	}
+}
+
+static void engine_merge_lane(SDecoResult *pTarget, const SDecoResult *pSource, EEngineLane lane)
+{
+	if(lane == ENGINE_LANE_VPM)
+	{
+		memcpy(&pTarget->vpm, &pSource->vpm, sizeof(SDecoinfo));
+		memcpy(&pTarget->vpmFuture, &pSource->vpmFuture, sizeof(SDecoinfo));
+		memcpy(&pTarget->vpmState, &pSource->vpmState, sizeof(SVpm));
+		pTarget->vpmCNS = pSource->vpmCNS;
+	}
+	else
+	{
+		memcpy(&pTarget->buehlmann, &pSource->buehlmann, sizeof(SDecoinfo));
+		memcpy(&pTarget->buehlmannFuture, &pSource->buehlmannFuture, sizeof(SDecoinfo));
+	}
+}
+
+static int engine_write(int fd, const void *pData, size_t length)
+{
+	const uint8_t *pByte = pData;
+
+	while(length)
+	{
+		ssize_t done = write(fd, pByte, length);
+
+		if(done < 0)
+		{
+			if(errno == EINTR)
+				continue;
+			return -1;
+		}
+		pByte += done;
+		length -= done;
+	}
+	return 0;
+}
+
+/* 1 on success, 0 on end of file, -1 on error */
+static int engine_read(int fd, void *pData, size_t length)
+{
+	uint8_t *pByte = pData;
+
+	while(length)
+	{
+		ssize_t done = read(fd, pByte, length);
+
+		if(done < 0)
+		{
+			if(errno == EINTR)
+				continue;
+			return -1;
+		}
+		if(done == 0)
+			return 0;
+		pByte += done;
+		length -= done;
+	}
+	return 1;
+}
+
+static void engine_worker_main(int requestFd, int replyFd)
+{
+	static SEngineRequest request;
+	static SEngineReply reply;
+
+	while(engine_read(requestFd, &request, sizeof(request)) == 1)
+	{
+		memset(&reply, 0, sizeof(reply));
+		reply.index = request.index;
+		reply.lane = request.lane;
+		engine_calc_lane(&request.snapshot, (EEngineLane)request.lane, &reply.result);
+		if(engine_write(replyFd, &reply, sizeof(reply)))
+			break;
+	}
+	_exit(0);
+}
+
+int deco_engine_workers(void)
+{
+	return engineWorkers;
+}
+
+void deco_engine_exit(void)
+{
+	for(int i = 0; i < engineWorkers; i++)
+	{
+		close(engineWorker[i].requestFd);
+		close(engineWorker[i].replyFd);
+	}
+	for(int i = 0; i < engineWorkers; i++)
+	{
+		waitpid(engineWorker[i].pid, NULL, 0);
+	}
+	engineWorkers = 0;
+}
+
+/* workers < 0: one per online CPU, 0: calculate in the calling process */
+int deco_engine_init(int workers)
+{
+	deco_engine_exit();
+
+	if(workers < 0)
+	{
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+		workers = (cpus > 0) ? (int)cpus : 1;
+	}
+	if(workers > ENGINE_MAX_WORKERS)
+		workers = ENGINE_MAX_WORKERS;
+
+	signal(SIGPIPE, SIG_IGN);
+	fflush(NULL);
+	for(int i = 0; i < workers; i++)
+	{
+		int requestPipe[2];
+		int replyPipe[2];
+		pid_t pid;
+
+		if(pipe(requestPipe))
+			break;
+		if(pipe(replyPipe))
+		{
+			close(requestPipe[0]);
+			close(requestPipe[1]);
+			break;
+		}
+		pid = fork();
+		if(pid == 0)
+		{
+			/* drop the parent side of all pipes, EOF on the request pipe ends the worker */
+			for(int j = 0; j < engineWorkers; j++)
+			{
+				close(engineWorker[j].requestFd);
+				close(engineWorker[j].replyFd);
+			}
+			close(requestPipe[1]);
+			close(replyPipe[0]);
+			engine_worker_main(requestPipe[0], replyPipe[1]);
+		}
+		close(requestPipe[0]);
+		close(replyPipe[1]);
+		if(pid < 0)
+		{
+			close(requestPipe[1]);
+			close(replyPipe[0]);
+			break;
+		}
+		engineWorker[engineWorkers].pid = pid;
+		engineWorker[engineWorkers].requestFd = requestPipe[1];
+		engineWorker[engineWorkers].replyFd = replyPipe[0];
+		engineWorker[engineWorkers].busy = false;
+		engineWorkers++;
+	}
+	return engineWorkers;
+}
+
+/* Error in deco_engine_run(): wait for the jobs already sent, their replies must not end up in the next
+ * run. A worker which does not answer any more leaves the pool out of step, it is shut down then. */
+static int engine_abort(_Bool broken)
+{
+	static SEngineReply reply;
+
+	for(int i = 0; i < engineWorkers; i++)
+	{
+		if(!engineWorker[i].busy)
+			continue;
+		if(engine_read(engineWorker[i].replyFd, &reply, sizeof(reply)) != 1)
+			broken = true;
+		engineWorker[i].busy = false;
+	}
+	if(broken)
+		deco_engine_exit();
+	return -1;
+}
+
+/* calculate all four results for count snapshots, returns 0 on success. On error no reply is left
+ * pending, deco_engine_workers() is 0 if the pool had to be shut down. */
+int deco_engine_run(const SDecoSnapshot *pSnapshot, SDecoResult *pResult, int count)
+{
+	static SEngineRequest request;
+	static SEngineReply reply;
+	struct pollfd pollList[ENGINE_MAX_WORKERS];
+	int workerOfPoll[ENGINE_MAX_WORKERS];
+	int jobs = count * ENGINE_LANE_COUNT;
+	int nextJob = 0;
+	int doneJobs = 0;
+
+	if(engineWorkers == 0)
+	{
+		for(int i = 0; i < count; i++)
+		{
+			engine_calc_lane(&pSnapshot[i], ENGINE_LANE_VPM, &pResult[i]);
+			engine_calc_lane(&pSnapshot[i], ENGINE_LANE_BUEHLMANN, &pResult[i]);
+		}
+		return 0;
+	}
+
+	while(doneJobs < jobs)
+	{
+		int polled = 0;
+
+		for(int i = 0; (i < engineWorkers) && (nextJob < jobs); i++)
+		{
+			if(engineWorker[i].busy)
+				continue;
+			request.index = nextJob / ENGINE_LANE_COUNT;
+			request.lane = nextJob % ENGINE_LANE_COUNT;
+			memcpy(&request.snapshot, &pSnapshot[request.index], sizeof(SDecoSnapshot));
+			if(engine_write(engineWorker[i].requestFd, &request, sizeof(request)))
+				return engine_abort(true);
+			engineWorker[i].busy = true;
+			nextJob++;
+		}
+
+		for(int i = 0; i < engineWorkers; i++)
+		{
+			if(!engineWorker[i].busy)
+				continue;
+			pollList[polled].fd = engineWorker[i].replyFd;
+			pollList[polled].events = POLLIN;
+			pollList[polled].revents = 0;
+			workerOfPoll[polled] = i;
+			polled++;
+		}
+		if(poll(pollList, polled, -1) < 0)
+		{
+			if(errno == EINTR)
+				continue;
+			return engine_abort(false);
+		}
+		for(int p = 0; p < polled; p++)
+		{
+			if(!pollList[p].revents)
+				continue;
+			if(engine_read(pollList[p].fd, &reply, sizeof(reply)) != 1)
+				return engine_abort(true);
+			engineWorker[workerOfPoll[p]].busy = false;
+			if((reply.index < 0) || (reply.index >= count) || (reply.lane < 0) || (reply.lane >= ENGINE_LANE_COUNT))
+				return engine_abort(true);
+			engine_merge_lane(&pResult[reply.index], &reply.result, (EEngineLane)reply.lane);
+			doneJobs++;
+		}
+	}
+	return 0;
+}
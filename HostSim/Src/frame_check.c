@@ -0,0 +1,305 @@
+///////////////////////////////////////////////////////////////////////////////
+/// -*- coding: UTF-8 -*-
+///
+/// \file   HostSim/Src/frame_check.c
+/// \brief  Random getFrame() / release / housekeepingFrame() cycles on the frame pool
+/// \author heinrichs weikamp gmbh
+/// \date   17-Oct-2026
+///
+/// \details
+///	gfx_engine.c runs on the software LTDC / DMA2D of host_display.c like in
+///	gfx_render. A few callers get frames, release them, release them for a
+///	wrong caller, release all but one or all of them, put one on the display
+///	and call housekeepingFrame() in random order. The frames owned by the
+///	callers are kept in a model. After every step the pool statistics have
+///	to match it: clean + released + blocked = total, blocked and the frames
+///	per caller as in the model, no frame handed out twice, every frame handed
+///	out cleared and the frame on the display never cleared. At the end all
+///	frames are released, cleaned and requested again to find lost ones.
+///	Returns non zero on a difference.
+///
+/// $Id$
+///////////////////////////////////////////////////////////////////////////////
+///     This program is free software: you can redistribute it and/or modify
+///     it under the terms of the GNU General Public License as published by
+///     the Free Software Foundation, either version 3 of the License, or
+///     (at your option) any later version.
+///
+///     This program is distributed in the hope that it will be useful,
+///     but WITHOUT ANY WARRANTY; without even the implied warranty of
+///     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///     GNU General Public License for more details.
+///
+///     You should have received a copy of the GNU General Public License
+///     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+
+#include "base.h"
+#include "gfx_engine.h"
+#include "host_display.h"
+
+#define CHECK_CYCLES		(20000)
+#define CHECK_PHASE			(1000)		/* cycles alternating between mixed steps and filling the pool */
+#define CHECK_CALLERS		(5)
+#define CHECK_CALLER_FIRST	(200)		/* not used by the firmware */
+#define CHECK_MAX_FRAMES	(256)
+#define CHECK_MARKER		(0xA5A5)
+
+typedef struct
+{
+	uint32_t address;
+	uint8_t callerId;
+} SCheckFrame;
+
+static SCheckFrame owned[CHECK_MAX_FRAMES];
+static uint16_t ownedCount = 0;
+static uint32_t shownFrame = 0;			/* frame of a check caller on the top layer */
+static uint8_t reserved = 0;			/* frames blocked by GFX_init() */
+static uint32_t randomState = 0x46524D45;
+static int failures = 0;
+
+static uint32_t check_random(void)
+{
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+static volatile uint16_t *check_pixel(uint32_t address)
+{
+	return (volatile uint16_t *)(uintptr_t)address;
+}
+
+static void check_fail(uint32_t cycle, const char *pText, uint32_t value)
+{
+	if(failures < 10)
+		printf("  cycle %u: %s (%u)\n", cycle, pText, value);
+	failures++;
+}
+
+static uint16_t check_owned_by(uint8_t callerId)
+{
+	uint16_t count = 0;
+
+	for(uint16_t i = 0; i < ownedCount; i++)
+	{
+		if(owned[i].callerId == callerId)
+			count++;
+	}
+	return count;
+}
+
+static void check_remove(uint16_t index)
+{
+	owned[index] = owned[--ownedCount];
+}
+
+/* removes the frames of a caller from the model except keep, returns the number removed */
+static uint16_t check_remove_caller(uint8_t callerId, uint32_t keep)
+{
+	uint16_t removed = 0;
+	uint16_t i = 0;
+
+	while(i < ownedCount)
+	{
+		if((owned[i].callerId == callerId) && (owned[i].address != keep))
+		{
+			check_remove(i);
+			removed++;
+		}
+		else
+			i++;
+	}
+	return removed;
+}
+
+static void check_get(uint32_t cycle, uint8_t callerId, const SFramePoolStatistics *pBefore)
+{
+	uint32_t address = getFrame(callerId);
+
+	if(address == 0)
+	{
+		if(pBefore->blocked != pBefore->total)
+			check_fail(cycle, "getFrame() failed with frames left", pBefore->total - pBefore->blocked);
+		return;
+	}
+
+	for(uint16_t i = 0; i < ownedCount; i++)
+	{
+		if(owned[i].address == address)
+		{
+			check_fail(cycle, "frame handed out twice", address);
+			return;
+		}
+	}
+	if(*check_pixel(address) != 0)
+		check_fail(cycle, "frame handed out without clear", address);
+
+	*check_pixel(address) = CHECK_MARKER;
+	owned[ownedCount].address = address;
+	owned[ownedCount].callerId = callerId;
+	ownedCount++;
+}
+
+static void check_step(uint32_t cycle)
+{
+	SFramePoolStatistics before;
+	uint8_t callerId = CHECK_CALLER_FIRST + check_random() % CHECK_CALLERS;
+	uint16_t index = ownedCount ? check_random() % ownedCount : 0;
+	uint16_t foreign;
+	uint8_t action = check_random() % 16;
+
+	if(((cycle / CHECK_PHASE) & 1) && (action < 10))
+		action = 0;
+
+	GFX_getFramePoolStatistics(&before);
+
+	switch(action)
+	{
+		case 0: case 1: case 2: case 3: case 4:
+			check_get(cycle, callerId, &before);
+			break;
+
+		case 5: case 6: case 7:
+			if(ownedCount)
+			{
+				if(releaseFrame(owned[index].callerId, owned[index].address) != 1)
+					check_fail(cycle, "releaseFrame() of the owner refused", owned[index].address);
+				check_remove(index);
+			}
+			break;
+
+		case 8:
+			if(ownedCount)
+			{
+				foreign = owned[index].callerId + 1;
+				if(releaseFrame(foreign, owned[index].address) != 0)
+					check_fail(cycle, "releaseFrame() of a foreign caller accepted", owned[index].address);
+			}
+			break;
+
+		case 9:
+			if(ownedCount)
+			{
+				callerId = owned[index].callerId;
+				releaseAllFramesExcept(callerId, owned[index].address);
+				check_remove_caller(callerId, owned[index].address);
+			}
+			break;
+
+		case 10:
+			GFX_forceReleaseFramesWithId(callerId);
+			check_remove_caller(callerId, 0);
+			break;
+
+		case 11:
+			if(ownedCount)
+			{
+				shownFrame = owned[index].address;
+				GFX_SetFrameTop(shownFrame);
+				GFX_change_LTDC();
+			}
+			break;
+
+		case 12: case 13:
+			housekeepingFrame();
+			break;
+
+		default:
+			while(housekeepingFrame())
+				;
+			break;
+	}
+}
+
+static void check_consistency(uint32_t cycle)
+{
+	SFramePoolStatistics statistics;
+	uint8_t callerId;
+
+	GFX_getFramePoolStatistics(&statistics);
+
+	if(statistics.clean + statistics.released + statistics.blocked != statistics.total)
+		check_fail(cycle, "clean + released + blocked differs from total", statistics.clean + statistics.released + statistics.blocked);
+	if(statistics.blocked != reserved + ownedCount)
+		check_fail(cycle, "blocked frames differ from the frames owned", statistics.blocked);
+	if(statistics.blockedMax < statistics.blocked)
+		check_fail(cycle, "high-water mark below blocked frames", statistics.blockedMax);
+	if(blockedFramesCount() != statistics.total - statistics.blocked)
+		check_fail(cycle, "blockedFramesCount() differs", blockedFramesCount());
+
+	for(callerId = CHECK_CALLER_FIRST; callerId < CHECK_CALLER_FIRST + CHECK_CALLERS; callerId++)
+	{
+		if(GFX_getFramesOfCaller(callerId) != check_owned_by(callerId))
+			check_fail(cycle, "frames of caller differ", callerId);
+	}
+
+	/* released or not, the frame on the display keeps its content, a frame handed out again gets the marker again */
+	if(shownFrame && (*check_pixel(shownFrame) != CHECK_MARKER))
+	{
+		check_fail(cycle, "frame on the display cleared", shownFrame);
+		shownFrame = 0;
+	}
+}
+
+/* every frame not reserved by GFX_init() has to come back */
+static void check_final(void)
+{
+	SFramePoolStatistics statistics;
+	uint16_t obtained = 0;
+
+	for(uint8_t callerId = CHECK_CALLER_FIRST; callerId < CHECK_CALLER_FIRST + CHECK_CALLERS; callerId++)
+		GFX_forceReleaseFramesWithId(callerId);
+	ownedCount = 0;
+	while(housekeepingFrame())
+		;
+
+	GFX_getFramePoolStatistics(&statistics);
+	if(statistics.released > 1)			/* only the frame on the display may wait */
+		check_fail(CHECK_CYCLES, "released frames left after housekeeping", statistics.released);
+
+	while(getFrame(CHECK_CALLER_FIRST) != 0)
+		obtained++;
+	if(obtained != statistics.total - reserved)
+		check_fail(CHECK_CYCLES, "frames lost", statistics.total - reserved - obtained);
+	GFX_forceReleaseFramesWithId(CHECK_CALLER_FIRST);
+
+	printf("frame pool: %u cycles, %u frames, %u reserved, %u handed out at the end, max blocked %u, %u waits, %u failed, %u foreign releases, %d differences\n",
+			CHECK_CYCLES, statistics.total, reserved, obtained, statistics.blockedMax, statistics.waitCount,
+			statistics.acquireFailed, statistics.releaseForeign, failures);
+}
+
+int main(void)
+{
+	SFramePoolStatistics statistics;
+	uint32_t pLayerInvisible;
+
+	if(host_display_init() != 0)
+		return 2;
+
+	host_set_tick(1000000);
+	GFX_init(&pLayerInvisible);
+	GFX_LTDC_Init();
+	GFX_LTDC_LayerDefaultInit(TOP_LAYER, pLayerInvisible);
+	GFX_LTDC_LayerDefaultInit(BACKGRD_LAYER, pLayerInvisible);
+	GFX_SetFramesTopBottom(pLayerInvisible, pLayerInvisible, 480);
+	GFX_change_LTDC();
+
+	GFX_getFramePoolStatistics(&statistics);
+	reserved = statistics.blocked;
+	if(statistics.total > CHECK_MAX_FRAMES)
+		return 2;
+
+	for(uint32_t cycle = 0; cycle < CHECK_CYCLES; cycle++)
+	{
+		check_step(cycle);
+		check_consistency(cycle);
+	}
+	check_final();
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,652 @@
+///////////////////////////////////////////////////////////////////////////////
+/// -*- coding: UTF-8 -*-
+///
+/// \file   HostSim/Src/gfx_render.c
+/// \brief  Renders the home screens and the logbook pages on the host
+/// \author heinrichs weikamp gmbh
+/// \date   17-Oct-2026
+///
+/// \details
+///	gfx_engine.c, gfx_fonts.c, t7.c, t3.c and show_logbook.c are linked
+///	unmodified against the software LTDC / DMA2D of host_display.c. For a
+///	few canned SDiveState snapshots every enabled custom view of t7 and t3
+///	and the four pages of the logbook dive are drawn like the refresh
+///	interrupt and housekeepingFrame() do it on target, the displayed result
+///	is compared with a golden image and the time per refresh is reported.
+///
+///	The firmware keeps addresses in uint32_t, including addresses of
+///	variables on the stack. The build is not position independent, which
+///	puts code, data and heap below 4 GB, and the screens are rendered on a
+///	stack mapped below 4 GB as well.
+///
+/// $Id$
+///////////////////////////////////////////////////////////////////////////////
+///     This program is free software: you can redistribute it and/or modify
+///     it under the terms of the GNU General Public License as published by
+///     the Free Software Foundation, either version 3 of the License, or
+///     (at your option) any later version.
+///
+///     This program is distributed in the hope that it will be useful,
+///     but WITHOUT ANY WARRANTY; without even the implied warranty of
+///     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///     GNU General Public License for more details.
+///
+///     You should have received a copy of the GNU General Public License
+///     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "base.h"
+#include "data_central.h"
+#include "decom.h"
+#include "calc_crush.h"
+#include "buehlmann.h"
+#include "vpm.h"
+#include "settings.h"
+#include "check_warning.h"
+#include "gfx_engine.h"
+#include "tHome.h"
+#include "t7.h"
+#include "t3.h"
+#include "show_logbook.h"
+#include "logbook_miniLive.h"
+#include "firmwareEraseProgram.h"
+#include "host_display.h"
+
+#define RENDER_DEFAULT_LOOPS	(20)
+#define RENDER_STACK_SIZE		(4 * 1024 * 1024)
+#define RENDER_MAX_GASES		(3)
+#define RENDER_NAME_SIZE		(48)
+#define RENDER_SETTLE_REFRESHES	(10)
+#define RENDER_LOG_PAGES		(4)
+#define RENDER_RETAINED_STEPS	(24)
+
+typedef struct
+{
+	uint8_t oxygen_percentage;
+	uint8_t helium_percentage;
+	uint8_t depth_meter;
+} SRenderGas;
+
+typedef struct
+{
+	const char *name;
+	uint8_t mode;							/* MODE_DIVE or MODE_SURFACE after the dive */
+	uint8_t diveMode;
+	uint8_t depth_meter;
+	uint16_t dive_minutes;
+	SRenderGas gas[RENDER_MAX_GASES];		/* first entry: bottom gas (OC) or diluent (CCR) */
+	uint8_t setpoint_cbar;
+	uint16_t surface_minutes;
+	float temperature_celsius;
+	_Bool allViews;							/* otherwise only the primary custom view */
+} SRenderSnapshot;
+
+static const SRenderSnapshot renderSnapshots[] =
+{
+	{ "surface",		MODE_SURFACE,	DIVEMODE_OC,	40,	35,	{{21, 0, 0}, {50, 0, 21}},					0,		47,	21.5f,	true },
+	{ "ndl_18m_air",	MODE_DIVE,		DIVEMODE_OC,	18,	21,	{{21, 0, 0}},								0,		0,	14.2f,	false },
+	{ "deco_45m_air",	MODE_DIVE,		DIVEMODE_OC,	45,	32,	{{21, 0, 0}, {50, 0, 21}},					0,		0,	9.8f,	true },
+	{ "tmx_70m",		MODE_DIVE,		DIVEMODE_OC,	70,	24,	{{18, 45, 0}, {35, 25, 36}, {50, 0, 21}},	0,		0,	7.1f,	false },
+	{ "ccr_60m",		MODE_DIVE,		DIVEMODE_CCR,	60,	40,	{{10, 50, 0}},								130,	0,	8.3f,	true },
+};
+
+typedef struct
+{
+	uint64_t first_ns;						/* first refresh of the screen */
+	uint64_t total_ns;						/* the repeated refreshes */
+	uint64_t min_ns;
+	uint32_t count;
+} SRenderTime;
+
+static uint32_t renderLoops = RENDER_DEFAULT_LOOPS;
+static const char *pGoldenDir = "Golden";
+static const char *pOutputDir = "build/gfx";
+static const char *pFilter = NULL;
+static _Bool updateGolden = false;
+static int renderFailures = 0;
+static uint8_t renderImage[HOST_DISPLAY_BYTES];
+static uint8_t goldenImage[HOST_DISPLAY_BYTES];
+
+static ucontext_t mainContext;
+static ucontext_t renderContext;
+
+
+/* erased flash page of the hardware data (serial numbers) read by settings.c */
+static int render_map_hardware_data(void)
+{
+	uint32_t page = HARDWAREDATA_ADDRESS & ~0xFFFu;
+	void *pPage = mmap((void *)(uintptr_t)page, 0x1000, PROT_READ | PROT_WRITE,
+						MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+	if(pPage != (void *)(uintptr_t)page)
+	{
+		perror("mmap hardware data");
+		return -1;
+	}
+	memset(pPage, 0xFF, 0x1000);
+	return 0;
+}
+
+static uint64_t render_now_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+
+/* snapshots ---------------------------------------------------------------*/
+
+static void render_set_gas(SGasLine *pGas, const SRenderGas *pInput, _Bool first)
+{
+	memset(pGas, 0, sizeof(SGasLine));
+	pGas->oxygen_percentage = pInput->oxygen_percentage;
+	pGas->helium_percentage = pInput->helium_percentage;
+	pGas->depth_meter = pInput->depth_meter;
+	pGas->note.ub.active = 1;
+	pGas->note.ub.first = first;
+	pGas->note.ub.deco = !first;
+}
+
+static void render_settings(const SRenderSnapshot *pSnapshot)
+{
+	SSettings *pSettings = settingsGetPointer();
+	uint8_t gasStart = (pSnapshot->diveMode == DIVEMODE_OC) ? 1 : 1 + NUM_OFFSET_DILUENT;
+
+	set_settings_to_Standard();
+
+	pSettings->dive_mode = pSnapshot->diveMode;
+	pSettings->CCR_Mode = CCRMODE_FixedSetpoint;
+	memset(&pSettings->gas[gasStart], 0, NUM_GASES * sizeof(SGasLine));
+	for(int i = 0; i < RENDER_MAX_GASES; i++)
+	{
+		if(pSnapshot->gas[i].oxygen_percentage)
+			render_set_gas(&pSettings->gas[gasStart + i], &pSnapshot->gas[i], i == 0);
+	}
+	if(pSnapshot->setpoint_cbar)
+		pSettings->setpoint[1].setpoint_cbar = pSnapshot->setpoint_cbar;
+	pSettings->logbookOffset = 412;
+	pSettings->personalDiveCount = 412;
+
+	createDiveSettings();
+}
+
+/* square profile with a descent of 20 m/min, second by second as the mini live logbook of the profile view is recorded */
+static void render_dive(const SRenderSnapshot *pSnapshot, SDiveState *pState)
+{
+	SLifeData *pLife = &pState->lifeData;
+	float bottom_bar = pLife->pressure_surface_bar + pSnapshot->depth_meter / 10.0f;
+	int32_t descent_seconds = pSnapshot->depth_meter * 3;
+
+	/* closes the profile of the previous snapshot */
+	pState->mode = MODE_SURFACE;
+	updateMiniLiveLogbook(0);
+
+	pState->mode = MODE_DIVE;
+	for(int32_t second = 1; second <= pSnapshot->dive_minutes * 60; second++)
+	{
+		if(second < descent_seconds)
+			pLife->pressure_ambient_bar = pLife->pressure_surface_bar + (bottom_bar - pLife->pressure_surface_bar) * second / descent_seconds;
+		else
+			pLife->pressure_ambient_bar = bottom_bar;
+		decom_tissues_exposure(1, pLife);
+
+		pLife->dive_time_seconds = second;
+		pLife->depth_meter = (pLife->pressure_ambient_bar - pLife->pressure_surface_bar) * 10.0f;
+		updateMiniLiveLogbook(0);
+	}
+
+	pLife->dive_time_seconds_without_surface_time = pLife->dive_time_seconds;
+	pLife->max_depth_meter = pLife->depth_meter + 1.3f;
+	pLife->average_depth_meter = pLife->depth_meter * 0.8f;
+	pLife->cns = pSnapshot->dive_minutes * 0.6f;
+	pLife->otu = pSnapshot->dive_minutes * 0.9f;
+}
+
+static void render_deco(SDiveState *pState)
+{
+	SLifeData future;
+
+	buehlmann_init();
+	buehlmann_calc_deco(&pState->lifeData, &pState->diveSettings, &pState->decolistBuehlmann);
+	vpm_init(&pState->vpm, pState->diveSettings.vpm_conservatism, 0, 0);
+	vpm_calc(&pState->lifeData, &pState->diveSettings, &pState->vpm, &pState->decolistVPM, DECOSTOPS);
+
+	memcpy(&future, &pState->lifeData, sizeof(SLifeData));
+	decom_tissues_exposure(pState->diveSettings.future_TTS_minutes * 60, &future);
+	buehlmann_calc_deco(&future, &pState->diveSettings, &pState->decolistFutureBuehlmann);
+	vpm_calc(&future, &pState->diveSettings, &pState->vpm, &pState->decolistFutureVPM, FUTURESTOPS);
+}
+
+static void render_build_snapshot(const SRenderSnapshot *pSnapshot)
+{
+	SDiveState *pState = stateRealGetPointerWrite();
+
+	set_stateUsedToReal();
+	memset(&pState->lifeData, 0, sizeof(SLifeData));
+	memset(&pState->warnings, 0, sizeof(SWarnings));
+	memset(&pState->events, 0, sizeof(SEvents));
+	render_settings(pSnapshot);
+
+	pState->lifeData.pressure_surface_bar = 1.013f;
+	pState->lifeData.pressure_ambient_bar = 1.013f;
+	decom_reset_with_1000mbar(&pState->lifeData);
+	setActualGasFirst(&pState->lifeData);
+
+	render_dive(pSnapshot, pState);
+	if(pSnapshot->mode == MODE_SURFACE)
+	{
+		pState->lifeData.actualGas.nitrogen_percentage = 79;
+		pState->lifeData.actualGas.helium_percentage = 0;
+		pState->lifeData.actualGas.AppliedDiveMode = DIVEMODE_OC;
+		pState->lifeData.pressure_ambient_bar = pState->lifeData.pressure_surface_bar;
+		decom_tissues_exposure(pSnapshot->surface_minutes * 60, &pState->lifeData);
+		pState->lifeData.depth_meter = 0;
+		pState->lifeData.surface_time_seconds = pSnapshot->surface_minutes * 60;
+		pState->lifeData.desaturation_time_minutes = 14 * 60 + 25;
+		pState->lifeData.no_fly_time_minutes = 11 * 60 + 10;
+	}
+
+	pState->mode = pSnapshot->mode;
+	pState->lifeData.temperature_celsius = pSnapshot->temperature_celsius;
+	pState->lifeData.battery_voltage = 3.92f;
+	pState->lifeData.battery_charge = 78.0f;
+	pState->lifeData.compass_heading = 212.0f;
+	pState->lifeData.ascent_rate_meter_per_min = 0;
+	pState->lifeData.timeBinaryFormat = (0x10u << 16) | (0x24u << 8) | 0x37u;						/* 10:24:37 as RTC_TR */
+	pState->lifeData.dateBinaryFormat = (0x26u << 16) | (6u << 13) | (0x10u << 8) | 0x17u;		/* Sat 2026-10-17 as RTC_DR */
+	pState->lifeData.ppO2 = decom_calc_ppO2(pState->lifeData.pressure_ambient_bar, &pState->lifeData.actualGas);
+	pState->lastKnownBatteryPercentage = 78;
+
+	if(pSnapshot->mode == MODE_DIVE)
+		render_deco(pState);
+	check_warning();
+
+	set_globalState((pSnapshot->mode == MODE_DIVE) ? StD : StS);
+}
+
+
+/* rendering ---------------------------------------------------------------*/
+
+/* what happens on target between two refreshes: VSYNC switch of the layers and the frame clean up */
+static void render_present(void)
+{
+	GFX_change_LTDC();
+	while(housekeepingFrame())
+		;
+}
+
+static void render_time_add(SRenderTime *pTime, uint64_t elapsed_ns)
+{
+	if(pTime->count == 0)
+	{
+		pTime->first_ns = elapsed_ns;
+		pTime->min_ns = elapsed_ns;
+	}
+	else
+	{
+		pTime->total_ns += elapsed_ns;
+		if(elapsed_ns < pTime->min_ns)
+			pTime->min_ns = elapsed_ns;
+	}
+	pTime->count++;
+}
+
+static void render_check(const char *pName, const SRenderTime *pTime)
+{
+	char path[512];
+	const char *pResult = "ok";
+	char resultText[32];
+	uint32_t differences = 0;
+	uint32_t repeated = (pTime->count > 1) ? pTime->count - 1 : 1;
+	int golden;
+
+	host_display_snapshot(renderImage);
+
+	snprintf(path, sizeof(path), "%s/%s.png", pOutputDir, pName);
+	host_png_write(path, renderImage);
+
+	snprintf(path, sizeof(path), "%s/%s.png", pGoldenDir, pName);
+	if(updateGolden)
+	{
+		pResult = (host_png_write(path, renderImage) == 0) ? "updated" : "error";
+	}
+	else if((golden = host_png_read(path, goldenImage)) != 0)
+	{
+		pResult = (golden > 0) ? "missing" : "error";
+		renderFailures++;
+	}
+	else
+	{
+		for(uint32_t i = 0; i < HOST_DISPLAY_BYTES; i += 3)
+		{
+			if(memcmp(&renderImage[i], &goldenImage[i], 3))
+				differences++;
+		}
+		if(differences)
+		{
+			snprintf(resultText, sizeof(resultText), "%u px", differences);
+			pResult = resultText;
+			renderFailures++;
+		}
+	}
+
+	printf("%-28s %-10s %10.1f %10.1f %10.1f\n", pName, pResult, pTime->first_ns / 1000.0,
+			(pTime->count > 1) ? (double)pTime->total_ns / repeated / 1000.0 : pTime->first_ns / 1000.0, pTime->min_ns / 1000.0);
+}
+
+/* -s only limits what is compared and reported, every screen is still drawn to keep the state of
+ * the display code (e.g. the damped compass heading of t7) independent of the selection */
+static _Bool render_selected(const char *pName)
+{
+	return (pFilter == NULL) || (strstr(pName, pFilter) != NULL);
+}
+
+/* One screen: the first refresh after the view change, RENDER_SETTLE_REFRESHES to let damped
+ * values settle and renderLoops refreshes of unchanged data. The image is taken after the last
+ * one and does not depend on the number of loops.
+ */
+static void render_screen(const char *pName, void (*pRefresh)(void))
+{
+	SRenderTime time = { 0 };
+
+	for(uint32_t loop = 0; loop < RENDER_SETTLE_REFRESHES + renderLoops; loop++)
+	{
+		uint64_t start = render_now_ns();
+		uint64_t elapsed;
+
+		pRefresh();
+		elapsed = render_now_ns() - start;
+		if((loop == 0) || (loop >= RENDER_SETTLE_REFRESHES))
+			render_time_add(&time, elapsed);
+		render_present();
+	}
+	if(render_selected(pName))
+		render_check(pName, &time);
+}
+
+static void render_home(const SRenderSnapshot *pSnapshot, const char *pDesign, void (*pRefresh)(void), uint8_t (*pChangeView)(uint8_t action))
+{
+	uint8_t visited[256] = { 0 };
+	char name[RENDER_NAME_SIZE];
+	uint8_t view;
+
+	/* the first refresh of a mode selects the primary view */
+	pRefresh();
+	render_present();
+
+	view = pChangeView(ACTION_END);
+	while(!visited[view])
+	{
+		visited[view] = 1;
+		snprintf(name, sizeof(name), "%s_%s_cv%02u", pSnapshot->name, pDesign, view);
+		render_screen(name, pRefresh);
+		if(!pSnapshot->allViews)
+			break;
+		view = pChangeView(ACTION_BUTTON_ENTER);
+	}
+}
+
+/* the logbook pages are built once per call, the first page starts the sequence again */
+static void render_logbook(void)
+{
+	char name[RENDER_NAME_SIZE];
+	SRenderTime time[RENDER_LOG_PAGES];
+
+	memset(time, 0, sizeof(time));
+	for(uint32_t loop = 0; loop <= renderLoops; loop++)
+	{
+		for(int page = 0; page < RENDER_LOG_PAGES; page++)
+		{
+			uint64_t start = render_now_ns();
+
+			show_logbook_test(page == 0, 0);
+			render_time_add(&time[page], render_now_ns() - start);
+			render_present();
+
+			snprintf(name, sizeof(name), "logbook_page%d", page + 1);
+			if((loop == renderLoops) && render_selected(name))
+				render_check(name, &time[page]);
+		}
+	}
+	show_logbook_exit();
+	render_present();
+}
+
+/* t7 draws the text fields of a dive into a copy of its previous frame and renders only the changed
+ * ones. After every refresh with changed values the same state is drawn again without the previous
+ * frame, both images have to be identical.
+ */
+static uint32_t render_retained_step(SRenderTime *pRetained, SRenderTime *pFull)
+{
+	uint32_t differences = 0;
+	uint64_t start;
+
+	start = render_now_ns();
+	t7_refresh();
+	render_time_add(pRetained, render_now_ns() - start);
+	render_present();
+	host_display_snapshot(renderImage);
+
+	GFX_retained_invalidate();
+	start = render_now_ns();
+	t7_refresh();
+	render_time_add(pFull, render_now_ns() - start);
+	render_present();
+	host_display_snapshot(goldenImage);
+
+	for(uint32_t i = 0; i < HOST_DISPLAY_BYTES; i += 3)
+	{
+		if(memcmp(&renderImage[i], &goldenImage[i], 3))
+			differences++;
+	}
+	return differences;
+}
+
+static double render_average_us(const SRenderTime *pTime)
+{
+	return pTime->count ? (double)(pTime->first_ns + pTime->total_ns) / pTime->count / 1000.0 : 0.0;
+}
+
+static void render_retained_report(const char *pName, uint32_t differences, const SRenderTime *pRetained, const SRenderTime *pFull)
+{
+	char resultText[32];
+	const char *pResult = "ok";
+
+	if(differences)
+	{
+		snprintf(resultText, sizeof(resultText), "%u px", differences);
+		pResult = resultText;
+		renderFailures++;
+	}
+	printf("%-28s %-10s %10.1f %10.1f\n", pName, pResult, render_average_us(pRetained), render_average_us(pFull));
+}
+
+/* depth, time, temperature, ascent rate, CNS and every fourth step the deco plan change */
+static void render_retained_dive(const SRenderSnapshot *pSnapshot)
+{
+	SDiveState *pState = stateRealGetPointerWrite();
+	SLifeData *pLife = &pState->lifeData;
+	SRenderTime retained = { 0 }, full = { 0 };
+	char name[RENDER_NAME_SIZE];
+	uint32_t differences = 0;
+	float bottom_meter = pLife->depth_meter;
+
+	snprintf(name, sizeof(name), "retained_%s", pSnapshot->name);
+	for(uint32_t step = 0; step < RENDER_RETAINED_STEPS; step++)
+	{
+		pLife->depth_meter = bottom_meter + (float)((int32_t)((step * 7) % 11) - 5) * 0.3f;
+		pLife->pressure_ambient_bar = pLife->pressure_surface_bar + pLife->depth_meter / 10.0f;
+		pLife->dive_time_seconds += 7;
+		pLife->dive_time_seconds_without_surface_time = pLife->dive_time_seconds;
+		pLife->ascent_rate_meter_per_min = (float)(step % 5) * 2.5f;
+		pLife->temperature_celsius = pSnapshot->temperature_celsius - (float)(step / 3) * 0.1f;
+		pLife->cns += 0.4f;
+		pLife->ppO2 = decom_calc_ppO2(pLife->pressure_ambient_bar, &pLife->actualGas);
+		if((step % 4) == 3)
+		{
+			decom_tissues_exposure(7 * 4, pLife);
+			render_deco(pState);
+		}
+		check_warning();
+
+		host_set_tick(HAL_GetTick() + 1100);
+		differences += render_retained_step(&retained, &full);
+	}
+	if(render_selected(name))
+		render_retained_report(name, differences, &retained, &full);
+}
+
+/* ascent from the no deco dive through the last stop depth with the slow exit graph, its thick lines
+ * end close to the retained t7l2 window
+ */
+static void render_retained_slow_exit(void)
+{
+	SDiveState *pState = stateRealGetPointerWrite();
+	SLifeData *pLife = &pState->lifeData;
+	SSettings *pSettings = settingsGetPointer();
+	SRenderTime retained = { 0 }, full = { 0 };
+	const char *pName = "retained_slow_exit";
+	uint32_t differences = 0;
+	float max_depth_meter = pLife->max_depth_meter;
+
+	pSettings->slowExitTime = 1;
+
+	/* start of the dive as seen by calculateSlowExit() */
+	pLife->max_depth_meter = 0.5f;
+	pLife->depth_meter = 0.5f;
+	differences += render_retained_step(&retained, &full);
+	pLife->max_depth_meter = max_depth_meter;
+
+	for(uint32_t step = 0; step < RENDER_RETAINED_STEPS; step++)
+	{
+		/* down to the surface, every sixth step back just below the last stop */
+		pLife->depth_meter = pSettings->last_stop_depth_meter - 0.01f - (float)step * 0.12f;
+		if((step % 6) == 5)
+			pLife->depth_meter = pSettings->last_stop_depth_meter - 0.01f;
+		pLife->pressure_ambient_bar = pLife->pressure_surface_bar + pLife->depth_meter / 10.0f;
+		pLife->dive_time_seconds += 1;
+		pLife->dive_time_seconds_without_surface_time = pLife->dive_time_seconds;
+		pLife->ascent_rate_meter_per_min = (float)(step % 3) * 1.01f;
+		pLife->ppO2 = decom_calc_ppO2(pLife->pressure_ambient_bar, &pLife->actualGas);
+		check_warning();
+
+		host_set_tick(HAL_GetTick() + 1100);
+		differences += render_retained_step(&retained, &full);
+	}
+	if(render_selected(pName))
+		render_retained_report(pName, differences, &retained, &full);
+}
+
+static void render_all(void)
+{
+	uint32_t pLayerInvisible;
+
+	host_set_tick(1000000);
+
+	set_settings_to_Standard();
+	createDiveSettings();
+	GFX_init(&pLayerInvisible);
+	GFX_LTDC_Init();
+	GFX_LTDC_LayerDefaultInit(TOP_LAYER, pLayerInvisible);
+	GFX_LTDC_LayerDefaultInit(BACKGRD_LAYER, pLayerInvisible);
+	GFX_SetFramesTopBottom(pLayerInvisible, pLayerInvisible, 480);
+	GFX_use_colorscheme(settingsGetPointer()->tX_colorscheme);
+	tHome_init();
+	render_present();
+
+	printf("%-28s %-10s %10s %10s %10s\n", "screen", "result", "first_us", "avg_us", "min_us");
+	for(size_t i = 0; i < sizeof(renderSnapshots) / sizeof(renderSnapshots[0]); i++)
+	{
+		const SRenderSnapshot *pSnapshot = &renderSnapshots[i];
+
+		render_build_snapshot(pSnapshot);
+		render_home(pSnapshot, "t7", t7_refresh, t7_change_customview);
+		if(pSnapshot->mode == MODE_DIVE)
+			render_home(pSnapshot, "t3", t3_refresh, t3_change_customview);
+		else
+			render_logbook();
+	}
+
+	/* after the golden screens, the changed values and settings don't reach them */
+	printf("%-28s %-10s %10s %10s\n", "retained frame", "result", "retain_us", "full_us");
+	for(size_t i = 0; i < sizeof(renderSnapshots) / sizeof(renderSnapshots[0]); i++)
+	{
+		const SRenderSnapshot *pSnapshot = &renderSnapshots[i];
+
+		if(pSnapshot->mode != MODE_DIVE)
+			continue;
+		render_build_snapshot(pSnapshot);
+		render_retained_dive(pSnapshot);
+		if(pSnapshot->depth_meter < 30)
+			render_retained_slow_exit();
+	}
+}
+
+
+static void render_usage(const char *pProgram)
+{
+	fprintf(stderr, "usage: %s [-n loops] [-s screen] [-g golden_dir] [-o output_dir] [-u]\n", pProgram);
+	fprintf(stderr, "  -s  only screens whose name contains this text\n");
+	fprintf(stderr, "  -u  write the renders as new golden images instead of comparing\n");
+}
+
+int main(int argc, char *argv[])
+{
+	void *pStack;
+	int option;
+
+	while((option = getopt(argc, argv, "n:s:g:o:uh")) != -1)
+	{
+		switch(option)
+		{
+			case 'n':	renderLoops = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 's':	pFilter = optarg;
+				break;
+			case 'g':	pGoldenDir = optarg;
+				break;
+			case 'o':	pOutputDir = optarg;
+				break;
+			case 'u':	updateGolden = true;
+				break;
+			default:	render_usage(argv[0]);
+				return 2;
+		}
+	}
+	if(renderLoops == 0)
+		renderLoops = 1;
+
+	mkdir(pOutputDir, 0777);
+	if(updateGolden)
+		mkdir(pGoldenDir, 0777);
+
+	if((host_display_init() != 0) || (render_map_hardware_data() != 0))
+		return 2;
+
+	pStack = mmap(NULL, RENDER_STACK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT | MAP_STACK, -1, 0);
+	if(pStack == MAP_FAILED)
+	{
+		perror("mmap stack");
+		return 2;
+	}
+
+	getcontext(&renderContext);
+	renderContext.uc_stack.ss_sp = pStack;
+	renderContext.uc_stack.ss_size = RENDER_STACK_SIZE;
+	renderContext.uc_link = &mainContext;
+	makecontext(&renderContext, render_all, 0);
+	swapcontext(&mainContext, &renderContext);
+
+	return renderFailures ? 1 : 0;
+}
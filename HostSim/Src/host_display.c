@@ -0,0 +1,439 @@
+///////////////////////////////////////////////////////////////////////////////
+/// -*- coding: UTF-8 -*-
+///
+/// \file   HostSim/Src/host_display.c
+/// \brief  Software LTDC / DMA2D for rendering the display code on a PC
+/// \author heinrichs weikamp gmbh
+/// \date   17-Oct-2026
+///
+/// \details
+///	The frame buffers live in a mapping of the SDRAM at its target address,
+///	so the uint32_t frame addresses used all over gfx_engine.c can be
+///	dereferenced unchanged. DMA2D transfers are done synchronously in the
+///	calling context, HAL_DMA2D_Start_IT() calls the transfer complete
+///	callback before it returns.
+///
+///	The LTDC part only records what the HAL calls configure. Like the
+///	hardware, host_display_snapshot() reads the AL88 frame of each layer
+///	through its CLUT and blends layer 1 over layer 0 with pixel alpha times
+///	constant alpha. The LTDC scans the panel in lines of 480 pixels, one
+///	line being one column of the landscape display with pixel 0 at its
+///	bottom, so the snapshot is turned into the orientation the diver sees.
+///
+/// $Id$
+///////////////////////////////////////////////////////////////////////////////
+///     This program is free software: you can redistribute it and/or modify
+///     it under the terms of the GNU General Public License as published by
+///     the Free Software Foundation, either version 3 of the License, or
+///     (at your option) any later version.
+///
+///     This program is distributed in the hope that it will be useful,
+///     but WITHOUT ANY WARRANTY; without even the implied warranty of
+///     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///     GNU General Public License for more details.
+///
+///     You should have received a copy of the GNU General Public License
+///     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <png.h>
+
+#include "stm32f4xx_hal.h"
+#include "host_display.h"
+
+#define LTDC_LAYERS			(2)
+#define LTDC_LINE_PIXELS	(HOST_DISPLAY_HEIGHT)
+#define LTDC_LINES			(HOST_DISPLAY_WIDTH)
+
+GPIO_TypeDef hostGpio;
+DMA2D_TypeDef hostDma2d;
+LTDC_TypeDef hostLtdc;
+
+static LTDC_HandleTypeDef *pLtdcHandle;
+static uint32_t ltdcClut[LTDC_LAYERS][256];
+
+
+int host_display_init(void)
+{
+	void *pSdram = mmap((void *)(uintptr_t)HOST_SDRAM_START, HOST_SDRAM_SIZE, PROT_READ | PROT_WRITE,
+						MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+	if(pSdram != (void *)(uintptr_t)HOST_SDRAM_START)
+	{
+		perror("mmap SDRAM");
+		return -1;
+	}
+	return 0;
+}
+
+
+static _Bool host_in_sdram(uint32_t address, uint32_t bytes)
+{
+	return (address >= HOST_SDRAM_START) && (bytes <= HOST_SDRAM_SIZE)
+		&& (address - HOST_SDRAM_START <= HOST_SDRAM_SIZE - bytes);
+}
+
+
+/* GPIO, NVIC, RCC ---------------------------------------------------------*/
+
+void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init)
+{
+	(void)GPIOx;
+	(void)GPIO_Init;
+}
+
+void HAL_NVIC_SetPriority(IRQn_Type IRQn, uint32_t PreemptPriority, uint32_t SubPriority)
+{
+	(void)IRQn;
+	(void)PreemptPriority;
+	(void)SubPriority;
+}
+
+void HAL_NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+	(void)IRQn;
+}
+
+HAL_StatusTypeDef HAL_RCCEx_PeriphCLKConfig(RCC_PeriphCLKInitTypeDef *PeriphClkInit)
+{
+	(void)PeriphClkInit;
+	return HAL_OK;
+}
+
+
+/* DMA2D -------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_DMA2D_Init(DMA2D_HandleTypeDef *hdma2d)
+{
+	if(hdma2d == NULL)
+		return HAL_ERROR;
+
+	hdma2d->ErrorCode = 0;
+	hdma2d->State = HAL_DMA2D_STATE_READY;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA2D_ConfigLayer(DMA2D_HandleTypeDef *hdma2d, uint32_t LayerIdx)
+{
+	if((hdma2d == NULL) || (LayerIdx > 1))
+		return HAL_ERROR;
+
+	return HAL_OK;
+}
+
+/* register to memory takes the colour as ARGB8888 and converts it like DMA2D_SetConfig() */
+static uint16_t host_dma2d_r2m_color(uint32_t colorMode, uint32_t argb)
+{
+	uint32_t alpha = (argb >> 24) & 0xFF;
+	uint32_t red = (argb >> 16) & 0xFF;
+	uint32_t green = (argb >> 8) & 0xFF;
+	uint32_t blue = argb & 0xFF;
+
+	switch(colorMode)
+	{
+		case DMA2D_RGB565:		return (uint16_t)(((red >> 3) << 11) | ((green >> 2) << 5) | (blue >> 3));
+		case DMA2D_ARGB1555:	return (uint16_t)(((alpha >> 7) << 15) | ((red >> 3) << 10) | ((green >> 3) << 5) | (blue >> 3));
+		default:				return (uint16_t)(((alpha >> 4) << 12) | ((red >> 4) << 8) | ((green >> 4) << 4) | (blue >> 4));
+	}
+}
+
+static HAL_StatusTypeDef host_dma2d_transfer(DMA2D_HandleTypeDef *hdma2d, uint32_t pdata, uint32_t DstAddress, uint32_t Width, uint32_t Height)
+{
+	uint32_t outputOffset = hdma2d->Init.OutputOffset;
+	uint32_t inputOffset = hdma2d->LayerCfg[1].InputOffset;
+	uint16_t *pDestination = (uint16_t *)(uintptr_t)DstAddress;
+	const uint16_t *pSource = (const uint16_t *)(uintptr_t)pdata;
+	uint16_t color;
+
+	/* only the 16 bit formats used for the AL88 frames */
+	if((hdma2d->Init.ColorMode != DMA2D_ARGB4444) && (hdma2d->Init.ColorMode != DMA2D_RGB565) && (hdma2d->Init.ColorMode != DMA2D_ARGB1555))
+		return HAL_ERROR;
+	if((Width == 0) || (Height == 0) || !host_in_sdram(DstAddress, 2 * ((Width + outputOffset) * Height - outputOffset)))
+		return HAL_ERROR;
+
+	switch(hdma2d->Init.Mode)
+	{
+		case DMA2D_R2M:
+			color = host_dma2d_r2m_color(hdma2d->Init.ColorMode, pdata);
+			for(uint32_t line = 0; line < Height; line++)
+			{
+				for(uint32_t pixel = 0; pixel < Width; pixel++)
+					*pDestination++ = color;
+				pDestination += outputOffset;
+			}
+			break;
+
+		case DMA2D_M2M:
+			if(!host_in_sdram(pdata, 2 * ((Width + inputOffset) * Height - inputOffset)))
+				return HAL_ERROR;
+			for(uint32_t line = 0; line < Height; line++)
+			{
+				memmove(pDestination, pSource, Width * 2);
+				pDestination += Width + outputOffset;
+				pSource += Width + inputOffset;
+			}
+			break;
+
+		default:
+			return HAL_ERROR;
+	}
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA2D_Start(DMA2D_HandleTypeDef *hdma2d, uint32_t pdata, uint32_t DstAddress, uint32_t Width, uint32_t Height)
+{
+	if(hdma2d->State == HAL_DMA2D_STATE_BUSY)
+		return HAL_BUSY;
+
+	hdma2d->State = HAL_DMA2D_STATE_BUSY;
+	if(host_dma2d_transfer(hdma2d, pdata, DstAddress, Width, Height) != HAL_OK)
+	{
+		hdma2d->State = HAL_DMA2D_STATE_ERROR;
+		return HAL_ERROR;
+	}
+	/* stays busy until HAL_DMA2D_PollForTransfer() like on target */
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA2D_Start_IT(DMA2D_HandleTypeDef *hdma2d, uint32_t pdata, uint32_t DstAddress, uint32_t Width, uint32_t Height)
+{
+	if(hdma2d->State == HAL_DMA2D_STATE_BUSY)
+		return HAL_BUSY;
+
+	hdma2d->State = HAL_DMA2D_STATE_BUSY;
+	if(host_dma2d_transfer(hdma2d, pdata, DstAddress, Width, Height) != HAL_OK)
+	{
+		hdma2d->State = HAL_DMA2D_STATE_ERROR;
+		if(hdma2d->XferErrorCallback)
+			hdma2d->XferErrorCallback(hdma2d);
+		return HAL_ERROR;
+	}
+	/* transfer complete interrupt */
+	hdma2d->State = HAL_DMA2D_STATE_READY;
+	if(hdma2d->XferCpltCallback)
+		hdma2d->XferCpltCallback(hdma2d);
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA2D_PollForTransfer(DMA2D_HandleTypeDef *hdma2d, uint32_t Timeout)
+{
+	(void)Timeout;
+
+	if(hdma2d->State == HAL_DMA2D_STATE_ERROR)
+		return HAL_ERROR;
+
+	hdma2d->State = HAL_DMA2D_STATE_READY;
+	return HAL_OK;
+}
+
+
+/* LTDC, window handling as in stm32f4xx_hal_ltdc.c ------------------------*/
+
+HAL_StatusTypeDef HAL_LTDC_Init(LTDC_HandleTypeDef *hltdc)
+{
+	if(hltdc == NULL)
+		return HAL_ERROR;
+
+	pLtdcHandle = hltdc;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_LTDC_ConfigLayer(LTDC_HandleTypeDef *hltdc, LTDC_LayerCfgTypeDef *pLayerCfg, uint32_t LayerIdx)
+{
+	if(LayerIdx >= LTDC_LAYERS)
+		return HAL_ERROR;
+
+	pLtdcHandle = hltdc;
+	hltdc->LayerCfg[LayerIdx] = *pLayerCfg;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_LTDC_ConfigCLUT(LTDC_HandleTypeDef *hltdc, uint32_t *pCLUT, uint32_t CLUTSize, uint32_t LayerIdx)
+{
+	(void)hltdc;
+
+	if((LayerIdx >= LTDC_LAYERS) || (CLUTSize > 256))
+		return HAL_ERROR;
+
+	/* the CLUT of the LTDC holds RGB888, the alpha comes from the pixel */
+	for(uint32_t i = 0; i < CLUTSize; i++)
+		ltdcClut[LayerIdx][i] = pCLUT[i] & 0x00FFFFFF;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_LTDC_EnableCLUT(LTDC_HandleTypeDef *hltdc, uint32_t LayerIdx)
+{
+	(void)hltdc;
+	return (LayerIdx < LTDC_LAYERS) ? HAL_OK : HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_LTDC_SetAddress(LTDC_HandleTypeDef *hltdc, uint32_t Address, uint32_t LayerIdx)
+{
+	if(LayerIdx >= LTDC_LAYERS)
+		return HAL_ERROR;
+
+	hltdc->LayerCfg[LayerIdx].FBStartAdress = Address;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_LTDC_SetAlpha(LTDC_HandleTypeDef *hltdc, uint32_t Alpha, uint32_t LayerIdx)
+{
+	if(LayerIdx >= LTDC_LAYERS)
+		return HAL_ERROR;
+
+	hltdc->LayerCfg[LayerIdx].Alpha = Alpha;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_LTDC_SetWindowSize(LTDC_HandleTypeDef *hltdc, uint32_t XSize, uint32_t YSize, uint32_t LayerIdx)
+{
+	LTDC_LayerCfgTypeDef *pLayerCfg;
+
+	if(LayerIdx >= LTDC_LAYERS)
+		return HAL_ERROR;
+
+	pLayerCfg = &hltdc->LayerCfg[LayerIdx];
+	pLayerCfg->WindowX1 = XSize + pLayerCfg->WindowX0;
+	pLayerCfg->WindowY1 = YSize + pLayerCfg->WindowY0;
+	pLayerCfg->ImageWidth = XSize;		/* also the pitch of the frame buffer */
+	pLayerCfg->ImageHeight = YSize;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_LTDC_SetWindowPosition(LTDC_HandleTypeDef *hltdc, uint32_t X0, uint32_t Y0, uint32_t LayerIdx)
+{
+	LTDC_LayerCfgTypeDef *pLayerCfg;
+
+	if(LayerIdx >= LTDC_LAYERS)
+		return HAL_ERROR;
+
+	pLayerCfg = &hltdc->LayerCfg[LayerIdx];
+	pLayerCfg->WindowX0 = X0;
+	pLayerCfg->WindowX1 = X0 + pLayerCfg->ImageWidth;
+	pLayerCfg->WindowY0 = Y0;
+	pLayerCfg->WindowY1 = Y0 + pLayerCfg->ImageHeight;
+	return HAL_OK;
+}
+
+
+/* snapshot ----------------------------------------------------------------*/
+
+static void host_display_blend_layer(uint32_t LayerIdx, uint32_t *pScreen)
+{
+	const LTDC_LayerCfgTypeDef *pLayerCfg = &pLtdcHandle->LayerCfg[LayerIdx];
+	uint32_t x1 = (pLayerCfg->WindowX1 < LTDC_LINE_PIXELS) ? pLayerCfg->WindowX1 : LTDC_LINE_PIXELS;
+	uint32_t y1 = (pLayerCfg->WindowY1 < LTDC_LINES) ? pLayerCfg->WindowY1 : LTDC_LINES;
+	const uint16_t *pFrame;
+
+	if((pLayerCfg->WindowX0 >= x1) || (pLayerCfg->WindowY0 >= y1)
+	|| !host_in_sdram(pLayerCfg->FBStartAdress, 2 * pLayerCfg->ImageWidth * (y1 - pLayerCfg->WindowY0)))
+		return;
+
+	pFrame = (const uint16_t *)(uintptr_t)pLayerCfg->FBStartAdress;
+	for(uint32_t y = pLayerCfg->WindowY0; y < y1; y++)
+	{
+		const uint16_t *pLine = pFrame + (y - pLayerCfg->WindowY0) * pLayerCfg->ImageWidth;
+
+		for(uint32_t x = pLayerCfg->WindowX0; x < x1; x++)
+		{
+			uint16_t pixel = pLine[x - pLayerCfg->WindowX0];
+			uint32_t alpha = (pixel >> 8) * pLayerCfg->Alpha / 255;
+			uint32_t color = ltdcClut[LayerIdx][pixel & 0xFF];
+			uint32_t below = pScreen[y * LTDC_LINE_PIXELS + x];
+			uint32_t blended = 0;
+
+			for(int shift = 0; shift < 24; shift += 8)
+			{
+				uint32_t top = (color >> shift) & 0xFF;
+				uint32_t bottom = (below >> shift) & 0xFF;
+
+				blended |= ((top * alpha + bottom * (255 - alpha) + 127) / 255) << shift;
+			}
+			pScreen[y * LTDC_LINE_PIXELS + x] = blended;
+		}
+	}
+}
+
+void host_display_snapshot(uint8_t *pRgb)
+{
+	static uint32_t screen[LTDC_LINES * LTDC_LINE_PIXELS];
+
+	memset(screen, 0, sizeof(screen));
+	if(pLtdcHandle)
+	{
+		host_display_blend_layer(0, screen);
+		host_display_blend_layer(1, screen);
+	}
+
+	/* LTDC line y is display column y, pixel x of the line is counted from the bottom */
+	for(uint32_t row = 0; row < HOST_DISPLAY_HEIGHT; row++)
+	{
+		for(uint32_t column = 0; column < HOST_DISPLAY_WIDTH; column++)
+		{
+			uint32_t color = screen[column * LTDC_LINE_PIXELS + (LTDC_LINE_PIXELS - 1 - row)];
+
+			*pRgb++ = (uint8_t)(color >> 16);
+			*pRgb++ = (uint8_t)(color >> 8);
+			*pRgb++ = (uint8_t)color;
+		}
+	}
+}
+
+
+/* PNG ---------------------------------------------------------------------*/
+
+int host_png_write(const char *pPath, const uint8_t *pRgb)
+{
+	png_image image;
+
+	memset(&image, 0, sizeof(image));
+	image.version = PNG_IMAGE_VERSION;
+	image.width = HOST_DISPLAY_WIDTH;
+	image.height = HOST_DISPLAY_HEIGHT;
+	image.format = PNG_FORMAT_RGB;
+
+	if(!png_image_write_to_file(&image, pPath, 0, pRgb, 0, NULL))
+	{
+		fprintf(stderr, "%s: %s\n", pPath, image.message);
+		return -1;
+	}
+	return 0;
+}
+
+/* returns 1 if there is no such file, -1 if it is not a display sized PNG */
+int host_png_read(const char *pPath, uint8_t *pRgb)
+{
+	png_image image;
+	FILE *pFile = fopen(pPath, "rb");
+
+	if(pFile == NULL)
+		return 1;
+
+	memset(&image, 0, sizeof(image));
+	image.version = PNG_IMAGE_VERSION;
+	if(!png_image_begin_read_from_stdio(&image, pFile))
+	{
+		fprintf(stderr, "%s: %s\n", pPath, image.message);
+		fclose(pFile);
+		return -1;
+	}
+	if((image.width != HOST_DISPLAY_WIDTH) || (image.height != HOST_DISPLAY_HEIGHT))
+	{
+		fprintf(stderr, "%s: %ux%u instead of %ux%u\n", pPath, image.width, image.height, HOST_DISPLAY_WIDTH, HOST_DISPLAY_HEIGHT);
+		png_image_free(&image);
+		fclose(pFile);
+		return -1;
+	}
+	image.format = PNG_FORMAT_RGB;
+	if(!png_image_finish_read(&image, NULL, pRgb, 0, NULL))
+	{
+		fprintf(stderr, "%s: %s\n", pPath, image.message);
+		fclose(pFile);
+		return -1;
+	}
+	fclose(pFile);
+	return 0;
+}
@@ -0,0 +1,437 @@
+///////////////////////////////////////////////////////////////////////////////
+/// -*- coding: UTF-8 -*-
+///
+/// \file   HostSim/Src/host_gfx_stubs.c
+/// \brief  Firmware symbols the display code expects from the rest of CPU1
+/// \author heinrichs weikamp gmbh
+/// \date   17-Oct-2026
+///
+/// \details
+///	Stands in for base.c, data_exchange_main.c, tCCR.c, the menus and the
+///	other home screen designs when t7.c, t3.c and show_logbook.c are built
+///	for the host. Everything answers like an idle unit without CCR sensors,
+///	pending gas or setpoint changes or open menus. write_gas() and
+///	printSetpointName() are copies of the firmware functions, their text is
+///	part of the rendered screens. The logbook returns one canned dive.
+///
+///	HAL_GetTick() runs on the time set by host_set_tick() so that renders
+///	are repeatable.
+///
+/// $Id$
+///////////////////////////////////////////////////////////////////////////////
+///     This program is free software: you can redistribute it and/or modify
+///     it under the terms of the GNU General Public License as published by
+///     the Free Software Foundation, either version 3 of the License, or
+///     (at your option) any later version.
+///
+///     This program is distributed in the hope that it will be useful,
+///     but WITHOUT ANY WARRANTY; without even the implied warranty of
+///     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///     GNU General Public License for more details.
+///
+///     You should have received a copy of the GNU General Public License
+///     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+
+#include "base.h"
+#include "data_exchange_main.h"
+#include "logbook.h"
+#include "ostc.h"
+#include "tCCR.h"
+#include "tMenu.h"
+#include "tMenuEditGasOC.h"
+#include "tMenuEditSetpoint.h"
+#include "t4_tetris.h"
+#include "t5_gauge.h"
+#include "t6_apnea.h"
+#include "text_multilanguage.h"
+#include "host_display.h"
+
+#define LOG_SAMPLING_SECONDS	(2)
+#define LOG_DIVE_SECONDS		(52 * 60)
+#define LOG_MAX_DEPTH_CM		(4230)
+
+static uint32_t hostTick;
+static uint32_t hostGlobalState;
+static SDataReceiveFromMaster hostDataOut;
+static SDataExchangeSlaveToMaster hostDataIn;
+
+uint32_t base_tempLightLevel = 0;
+
+
+/* time --------------------------------------------------------------------*/
+
+void host_set_tick(uint32_t tick)
+{
+	hostTick = tick;
+}
+
+uint32_t HAL_GetTick(void)
+{
+	return hostTick;
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+	hostTick += Delay;
+}
+
+uint8_t RTC_Bcd2ToByte(uint8_t Value)
+{
+	return (uint8_t)(((Value >> 4) * 10) + (Value & 0x0F));
+}
+
+
+/* base.c ------------------------------------------------------------------*/
+
+uint32_t get_globalState(void)
+{
+	return hostGlobalState;
+}
+
+void set_globalState(uint32_t newID)
+{
+	hostGlobalState = newID;
+}
+
+void get_globalStateList(SStateList *output)
+{
+	output->base  = (uint8_t)((hostGlobalState >> 28) & 0x0F);
+	output->page  = (uint8_t)((hostGlobalState >> 24) & 0x0F);
+	output->line  = (uint8_t)((hostGlobalState >> 16) & 0xFF);
+	output->field = (uint8_t)((hostGlobalState >> 8) & 0xFF);
+	output->mode  = (uint8_t)((hostGlobalState     ) & 0xFF);
+}
+
+SButtonLock get_ButtonLock(void)
+{
+	return LOCK_OFF;
+}
+
+uint8_t font_update_required(void)
+{
+	return 0;
+}
+
+void StoreButtonAction(uint8_t action)
+{
+	(void)action;
+}
+
+void set_Backlight_Boost(uint8_t level)
+{
+	(void)level;
+}
+
+
+/* data_exchange_main.c ----------------------------------------------------*/
+
+SDataReceiveFromMaster * dataOutGetPointer(void)
+{
+	return &hostDataOut;
+}
+
+SDataExchangeSlaveToMaster* get_dataInPointer(void)
+{
+	return &hostDataIn;
+}
+
+uint8_t DataEX_check_RTE_version__needs_update(void)
+{
+	return 0;
+}
+
+uint32_t DataEX_lost_connection_count(void)
+{
+	return 0;
+}
+
+uint8_t DataEX_was_power_on(void)
+{
+	return 0;
+}
+
+void setAvgDepth(SDiveState *pStateReal)
+{
+	(void)pStateReal;
+}
+
+
+/* ostc.c, tCCR.c ----------------------------------------------------------*/
+
+uint8_t isNewDisplay(void)
+{
+	return 0;
+}
+
+float get_HUD_battery_voltage_V(void)
+{
+	return 0;
+}
+
+uint8_t get_ppO2SensorWeightedResult_cbar(void)
+{
+	return 0;
+}
+
+void test_O2_sensor_values_outOfBounds(int8_t * outOfBouds1, int8_t * outOfBouds2, int8_t * outOfBouds3)
+{
+	*outOfBouds1 = 0;
+	*outOfBouds2 = 0;
+	*outOfBouds3 = 0;
+}
+
+
+/* menus -------------------------------------------------------------------*/
+
+void clearDisabledMenuLines(void)
+{
+}
+
+void openMenu_first_page_with_OC_gas_update(void)
+{
+}
+
+void openEdit_DiveSelectBetterGas(bool doBailout)
+{
+	(void)doBailout;
+}
+
+void tMEGas_check_switch_to_bailout(void)
+{
+}
+
+void openEdit_DiveSelectBetterSetpoint(bool useLastDiluent)
+{
+	(void)useLastDiluent;
+}
+
+void checkSwitchSetpoint(void)
+{
+}
+
+void checkSwitchToLoop(void)
+{
+}
+
+bool findSwitchToSetpoint(void)
+{
+	return false;
+}
+
+uint8_t getSwitchToSetpointCbar(void)
+{
+	return 0;
+}
+
+/* copy of tMenuEditSetpoint.c */
+int printSetpointName(char *text, uint8_t setpointId, SSettings *settings, bool useSmallFont)
+{
+    int charsPrinted = 0;
+    if (setpointId == 0) {
+        charsPrinted = snprintf(text, 10, "%s%c%c%s", useSmallFont ? "\016\016" : "", TXT_2BYTE, TXT2BYTE_Custom, useSmallFont ? "\017" : "");
+    } else if (settings->autoSetpoint) {
+        switch (setpointId) {
+        case SETPOINT_INDEX_AUTO_LOW:
+            charsPrinted = snprintf(text, 10, "%s%c%c%s", useSmallFont ? "\016\016" : "", TXT_2BYTE, TXT2BYTE_SetpointLow, useSmallFont ? "\017" : "");
+            break;
+        case SETPOINT_INDEX_AUTO_HIGH:
+            charsPrinted = snprintf(text, 10, "%s%c%c%s", useSmallFont ? "\016\016" : "", TXT_2BYTE, TXT2BYTE_SetpointHigh, useSmallFont ? "\017" : "");
+            break;
+        case SETPOINT_INDEX_AUTO_DECO:
+            charsPrinted = snprintf(text, 10, "%s%c%c%s", useSmallFont ? "\016\016" : "", TXT_2BYTE, TXT2BYTE_SetpointDeco, useSmallFont ? "\017" : "");
+            break;
+        default:
+            break;
+        }
+    } else {
+        charsPrinted = snprintf(text, 10, "%d", setpointId);
+    }
+
+    return charsPrinted;
+}
+
+/* copy of tMenuGas.c */
+uint8_t write_gas(char *text, uint8_t oxygen, uint8_t helium)
+{
+    uint8_t length;
+
+    if((oxygen == 21) && (helium == 0))
+    {
+        strcpy(text,"Air");
+        length = 3;
+    }
+    else if(oxygen == 100)
+    {
+        strcpy(text,"Oxy");
+        length = 3;
+    }
+    else if(helium == 0)
+    {
+        length = snprintf(text, 7,"NX%u",oxygen);
+    }
+    else if((oxygen + helium) == 100)
+    {
+        length = snprintf(text, 7,"HX%u",oxygen);
+    }
+    else
+    {
+        length = snprintf(text, 7,"%u/%u",oxygen,helium);
+    }
+
+    if(length > 6)
+    {
+        strcpy(text,"error");
+        length = 5;
+    }
+
+    return length;
+}
+
+
+/* t4_tetris.c, t5_gauge.c, t6_apnea.c -------------------------------------*/
+
+void t4_init(void)
+{
+}
+
+void t4_refresh(void)
+{
+}
+
+void t5_init(void)
+{
+}
+
+void t5_refresh(void)
+{
+}
+
+void t5_change_customview(uint8_t action)
+{
+	(void)action;
+}
+
+uint8_t t5_getCustomView(void)
+{
+	return 0;
+}
+
+void t6_init(void)
+{
+}
+
+void t6_refresh(void)
+{
+}
+
+void t6_change_customview(uint8_t action)
+{
+	(void)action;
+}
+
+
+/* logbook.c: one 52 min dive to 42.3 m with a switch to EAN50 at 21 m -----*/
+
+uint8_t logbook_getHeader(uint8_t StepBackwards,SLogbookHeader* pLogbookHeader)
+{
+	uint32_t samples = LOG_DIVE_SECONDS / LOG_SAMPLING_SECONDS;
+
+	(void)StepBackwards;
+
+	memset(pLogbookHeader, 0, sizeof(SLogbookHeader));
+	pLogbookHeader->diveHeaderStart = 0xFAFA;
+	pLogbookHeader->diveHeaderEnd = 0xFBFB;
+	pLogbookHeader->logbookProfileVersion = 0x24;
+	pLogbookHeader->dateYear = 26;
+	pLogbookHeader->dateMonth = 10;
+	pLogbookHeader->dateDay = 17;
+	pLogbookHeader->timeHour = 10;
+	pLogbookHeader->timeMinute = 24;
+	pLogbookHeader->maxDepth = LOG_MAX_DEPTH_CM;
+	pLogbookHeader->diveTimeMinutes = LOG_DIVE_SECONDS / 60;
+	pLogbookHeader->diveTimeSeconds = LOG_DIVE_SECONDS % 60;
+	pLogbookHeader->total_diveTime_seconds = LOG_DIVE_SECONDS;
+	pLogbookHeader->samplingRate = LOG_SAMPLING_SECONDS;
+	pLogbookHeader->profileLength[0] = (uint8_t)(samples * 3);
+	pLogbookHeader->profileLength[1] = (uint8_t)((samples * 3) >> 8);
+	pLogbookHeader->minTemp = 118;
+	pLogbookHeader->surfacePressure_mbar = 1013;
+	pLogbookHeader->desaturationTime = 14 * 60;
+	pLogbookHeader->gasordil[0].oxygen_percentage = 21;
+	pLogbookHeader->gasordil[0].note.ub.active = 1;
+	pLogbookHeader->gasordil[0].note.ub.first = 1;
+	pLogbookHeader->gasordil[1].oxygen_percentage = 50;
+	pLogbookHeader->gasordil[1].depth_meter = 21;
+	pLogbookHeader->gasordil[1].note.ub.active = 1;
+	pLogbookHeader->gasordil[1].note.ub.deco = 1;
+	pLogbookHeader->batteryVoltage = 3900;
+	pLogbookHeader->batteryCharge = 78;
+	pLogbookHeader->gfAtBeginning = 30;
+	pLogbookHeader->gfAtEnd = 85;
+	pLogbookHeader->gfLow_or_Vpm_conservatism = 30;
+	pLogbookHeader->gfHigh = 85;
+	pLogbookHeader->decoModel = GF_MODE;
+	pLogbookHeader->maxCNS = 19;
+	pLogbookHeader->averageDepth_mbar = 2410;
+	pLogbookHeader->salinity = 1;
+	pLogbookHeader->personalDiveCount = 412;
+	pLogbookHeader->diveNumber = 412;
+	pLogbookHeader->lastDecostop_m = 3;
+	pLogbookHeader->diveMode = DIVEMODE_OC;
+	return 1;
+}
+
+/* depth in cm, temperature in 0.1 deg C, deco stop depth in cm as logbook_readSampleData() */
+uint16_t logbook_readSampleData(uint8_t StepBackwards, uint16_t length,uint16_t* depth, uint8_t*  gasid, int16_t* temperature, uint16_t* ppo2,
+							    uint16_t* setpoint, uint16_t* sensor1, uint16_t* sensor2, uint16_t* sensor3, uint16_t* cns, uint8_t* bailout,
+								uint16_t* decostopDepth, uint16_t* tank, SGnssCoord* pPosition, uint8_t* event)
+{
+	uint32_t samples = LOG_DIVE_SECONDS / LOG_SAMPLING_SECONDS;
+	uint32_t compression = (samples + length - 1) / length;
+	uint16_t count = (uint16_t)(samples / compression);
+
+	(void)StepBackwards;
+
+	for(uint16_t i = 0; i < count; i++)
+	{
+		uint32_t seconds = (uint32_t)i * compression * LOG_SAMPLING_SECONDS;
+		uint32_t cm;
+		uint16_t stop = 0;
+
+		if(seconds < 150)											/* descent */
+			cm = seconds * LOG_MAX_DEPTH_CM / 150;
+		else if(seconds < 25 * 60)									/* bottom */
+			cm = LOG_MAX_DEPTH_CM - (seconds - 150) * 600 / (25 * 60 - 150);
+		else if(seconds < 29 * 60)									/* ascent to the first stop */
+			cm = 3630 - (seconds - 25 * 60) * (3630 - 900) / (4 * 60);
+		else														/* stops at 9, 6 and 3 m */
+		{
+			cm = (seconds < 33 * 60) ? 900 : (seconds < 38 * 60) ? 600 : (seconds < 50 * 60) ? 300 : 300 - (seconds - 50 * 60) * 300 / 120;
+			stop = (cm >= 300) ? (uint16_t)(cm / 300 * 300) : 0;
+		}
+
+		if(depth)			depth[i] = (uint16_t)cm;
+		if(gasid)			gasid[i] = (cm <= 2100 && seconds > 25 * 60) ? 2 : 1;
+		if(temperature)		temperature[i] = (int16_t)(190 - cm * 72 / LOG_MAX_DEPTH_CM);
+		if(ppo2)			ppo2[i] = 0;
+		if(setpoint)		setpoint[i] = 0;
+		if(sensor1)			sensor1[i] = 0;
+		if(sensor2)			sensor2[i] = 0;
+		if(sensor3)			sensor3[i] = 0;
+		if(cns)				cns[i] = (uint16_t)(seconds * 19 / LOG_DIVE_SECONDS);
+		if(bailout)			bailout[i] = 0;
+		if(decostopDepth)	decostopDepth[i] = stop;
+		if(tank)			tank[i] = 0;
+		if(event)			event[i] = 0;
+	}
+	if(pPosition)
+	{
+		pPosition->fLat = 0.0;
+		pPosition->fLon = 0.0;
+	}
+	return count;
+}
@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////
+/// -*- coding: UTF-8 -*-
+///
+/// \file   HostSim/Src/host_stubs.c
+/// \brief  Firmware symbols the deco core expects from the rest of CPU1
+/// \author heinrichs weikamp gmbh
+/// \date   17-Oct-2026
+///
+/// $Id$
+///////////////////////////////////////////////////////////////////////////////
+///     This program is free software: you can redistribute it and/or modify
+///     it under the terms of the GNU General Public License as published by
+///     the Free Software Foundation, either version 3 of the License, or
+///     (at your option) any later version.
+///
+///     This program is distributed in the hope that it will be useful,
+///     but WITHOUT ANY WARRANTY; without even the implied warranty of
+///     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///     GNU General Public License for more details.
+///
+///     You should have received a copy of the GNU General Public License
+///     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <time.h>
+#include <unistd.h>
+
+#include "data_central.h"
+
+static SDiveState hostState;
+
+const SDiveState *stateUsed = &hostState;
+SDiveState *stateUsedWrite = &hostState;
+
+/* only reached for PSCR first gas handling in decom_CreateGasChangeList() */
+uint8_t calc_MOD(uint8_t gasId)
+{
+	(void)gasId;
+	return 0;
+}
+
+uint32_t HAL_GetTick(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)(now.tv_sec * 1000u + now.tv_nsec / 1000000u);
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+	usleep(Delay * 1000u);
+}
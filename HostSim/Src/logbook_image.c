@@ -0,0 +1,856 @@
+///////////////////////////////////////////////////////////////////////////////
+/// -*- coding: UTF-8 -*-
+///
+/// \file   HostSim/Src/logbook_image.c
+/// \brief  Decoder and checker for dumps of the logbook in the external flash
+/// \author heinrichs weikamp gmbh
+/// \date   17-Oct-2026
+///
+/// \details
+///	Reads the header memory (tComm command 0x85) and the sample memory
+///	(command 0x88) of a device, or a raw image of the whole flash, and walks
+///	the header and sample rings with the layout of externLogbookFlash.c.
+///	Every dive is decoded to CSV or JSON, compact encoded profiles included,
+///	and the checks of ext_dive_log_consistent() and ext_flash_repair_dive_log()
+///	are applied to all slots. With -b the decoding is timed.
+///
+///	The sample format follows logbook_writeSample() and readSample() in
+///	logbook.c; a change there has to be repeated here. Compact samples are
+///	decoded with logbook_compact.c of the firmware.
+///
+/// $Id$
+///////////////////////////////////////////////////////////////////////////////
+///     This program is free software: you can redistribute it and/or modify
+///     it under the terms of the GNU General Public License as published by
+///     the Free Software Foundation, either version 3 of the License, or
+///     (at your option) any later version.
+///
+///     This program is distributed in the hope that it will be useful,
+///     but WITHOUT ANY WARRANTY; without even the implied warranty of
+///     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///     GNU General Public License for more details.
+///
+///     You should have received a copy of the GNU General Public License
+///     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "externLogbookFlash.h"
+#include "logbook_compact.h"
+
+#define IMAGE_SLOT_SIZE			(0x800)
+#define IMAGE_HEADER2_OFFSET	(0x400)		/* HEADER2OFFSET of externLogbookFlash.c */
+#define IMAGE_HEADER_RING		(HEADERSTOP + 1 - HEADERSTART)
+#define IMAGE_SAMPLE_RING		(SAMPLESTOP + 1 - SAMPLESTART)
+#define IMAGE_SLOTS				(IMAGE_HEADER_RING / IMAGE_SLOT_SIZE)
+#define IMAGE_HEADER_DUMP		(0x40000)	/* command 0x85 sends the first 8 x 32k of the header ring */
+#define IMAGE_OVERRUN_CHECK		(20)		/* bytes checked by ext_flash_SampleOverrunValid() */
+#define IMAGE_END_MARKER		(0xFD)
+
+_Static_assert(sizeof(SLogbookHeader) == 256, "SLogbookHeader must match the firmware layout");
+_Static_assert(sizeof(SSmallHeader) == 26, "SSmallHeader must match the firmware layout");
+
+typedef enum
+{
+	OUTPUT_NONE = 0,
+	OUTPUT_CSV,
+	OUTPUT_JSON
+} EImageOutput;
+
+typedef struct
+{
+	const char *pName;
+	uint8_t *pHeader;
+	uint32_t headerSize;		/* bytes of the header ring present in the dump */
+	uint8_t *pSample;
+	uint32_t sampleSize;		/* bytes of the sample ring present in the dump */
+	int32_t lastDiveLogId;		/* -1 if the dump does not include it */
+	int64_t nextSampleStart;	/* -1 if the dump does not include it */
+} SImageDump;
+
+typedef struct
+{
+	const SImageDump *pDump;
+	uint32_t address;
+	uint32_t remaining;			/* bytes left up to the end of the profile */
+	_Bool overrun;
+} SImageStream;
+
+typedef struct
+{
+	uint32_t seconds;
+	uint16_t depth_cm;
+	uint8_t fields;				/* SAMPLE_xxx present in this sample */
+	int16_t temperature_dC;
+	uint8_t decoNdl[2];			/* stop depth (m) and stop time (min), or 0 and NDL (min) */
+	uint8_t ppo2_cbar[3];
+	uint16_t voltage_dmV[3];
+	uint16_t cns;
+	int16_t tank_bar;
+	char events[128];
+} SImageSample;
+
+typedef struct
+{
+	uint16_t slot;
+	_Bool open;					/* no post-dive header */
+	SLogbookHeader header;
+	uint32_t begin;
+	uint32_t end;
+	uint32_t length;
+	uint32_t samples;
+	uint32_t standardLength;
+	uint32_t issues;
+} SImageDive;
+
+typedef void (*SampleHandler)(const SImageDump *pDump, const SImageDive *pDive, const SImageSample *pSample);
+
+static EImageOutput imageOutput = OUTPUT_NONE;
+static _Bool imageProfiles = 0;
+static _Bool imageQuiet = 0;
+static _Bool imageFullFlash = 0;
+static uint32_t imageBenchLoops = 0;
+static uint32_t imageIssues = 0;
+static _Bool imageFirstJson = 1;
+
+static uint64_t image_now_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static void image_issue(const SImageDump *pDump, SImageDive *pDive, const char *pFormat, ...)
+{
+	va_list args;
+
+	imageIssues++;
+	if(pDive)
+		pDive->issues++;
+	if(imageQuiet)
+		return;
+
+	if(pDive)
+		fprintf(stderr, "%s: slot %u dive %u: ", pDump->pName, pDive->slot, pDive->header.diveNumber);
+	else
+		fprintf(stderr, "%s: ", pDump->pName);
+	va_start(args, pFormat);
+	vfprintf(stderr, pFormat, args);
+	va_end(args);
+	fprintf(stderr, "\n");
+}
+
+static uint32_t image_u24(const uint8_t *pData)
+{
+	return pData[0] | (pData[1] << 8) | (pData[2] << 16);
+}
+
+static uint8_t image_sample_byte(const SImageDump *pDump, uint32_t address)
+{
+	if((address < SAMPLESTART) || (address - SAMPLESTART >= pDump->sampleSize))
+		return 0xFF;
+	return pDump->pSample[address - SAMPLESTART];
+}
+
+static const uint8_t *image_slot(const SImageDump *pDump, uint16_t slot, uint32_t offset)
+{
+	uint32_t position = (slot * IMAGE_SLOT_SIZE) + offset;
+
+	if(position + sizeof(SLogbookHeader) > pDump->headerSize)
+		return NULL;
+	return &pDump->pHeader[position];
+}
+
+/* ext_flash_SampleOverrunValid(): a profile may only wrap if the end of the ring was written */
+static _Bool image_overrun_valid(const SImageDump *pDump)
+{
+	for(uint32_t address = SAMPLESTOP - IMAGE_OVERRUN_CHECK; address < SAMPLESTOP; address++)
+	{
+		if(image_sample_byte(pDump, address) != 0xFF)
+			return 1;
+	}
+	return 0;
+}
+
+/* profile length as calculated by ext_flash_close_new_dive_log() */
+static uint32_t image_profile_length(uint32_t begin, uint32_t end)
+{
+	if(begin < end)
+		return 1 + end - begin;
+	return 2 + (end - SAMPLESTART) + (SAMPLESTOP - begin);
+}
+
+static uint8_t image_read_byte(SImageStream *pStream)
+{
+	uint8_t data;
+
+	if(pStream->remaining == 0)
+	{
+		pStream->overrun = 1;
+		return 0xFF;
+	}
+	data = image_sample_byte(pStream->pDump, pStream->address);
+	pStream->remaining--;
+	pStream->address++;
+	if(pStream->address > SAMPLESTOP)
+		pStream->address = SAMPLESTART;
+	return data;
+}
+
+static void image_read(SImageStream *pStream, uint8_t *pTarget, uint32_t length)
+{
+	while(length--)
+		*pTarget++ = image_read_byte(pStream);
+}
+
+/* CompactReadFunc of compact_decodeSample() */
+static void image_read_compact(void *pContext, uint8_t *pTarget, uint16_t length)
+{
+	image_read((SImageStream *)pContext, pTarget, length);
+}
+
+static uint16_t image_fields_length(uint8_t fields, const SSmallHeader *pSmallHeader)
+{
+	uint16_t length = 0;
+
+	if(fields & SAMPLE_TEMPERATURE)
+		length += 2;
+	if(fields & SAMPLE_DECO_NDL)
+		length += 2;
+	if(fields & SAMPLE_PPO2)
+		length += 9;
+	if(fields & SAMPLE_DECOPLAN)
+		length += 15;
+	if(fields & SAMPLE_CNS)
+		length += 2;
+	if(fields & SAMPLE_TANK)
+		length += pSmallHeader->tankLength;
+	return length;
+}
+
+static void image_event_text(SImageSample *pSample, const char *pFormat, ...)
+{
+	size_t used = strlen(pSample->events);
+	va_list args;
+
+	if(used && (used < sizeof(pSample->events) - 1))
+		pSample->events[used++] = ' ';
+	va_start(args, pFormat);
+	vsnprintf(&pSample->events[used], sizeof(pSample->events) - used, pFormat, args);
+	va_end(args);
+}
+
+/* event bytes of logbook_writeSample(), returns 0 if they do not fill eventLength exactly */
+static _Bool image_parse_events(const uint8_t *pEvent, uint16_t eventLength, SImageSample *pSample)
+{
+	static const char *eventName[16] = { NULL, "ascent", "deco_missed", NULL, "ppo2_low", "ppo2_high", "marker", "low_battery" };
+	uint8_t event1 = pEvent[0];
+	uint8_t event2 = 0;
+	uint16_t index = 1;
+	float position[2];
+
+	if(event1 & 0x80)
+		event2 = pEvent[index++];
+
+	if(eventName[event1 & 0x0F])
+		image_event_text(pSample, "%s", eventName[event1 & 0x0F]);
+	else if(event1 & 0x0F)
+		image_event_text(pSample, "event_%u", event1 & 0x0F);
+
+	if(event1 & 0x10)
+	{
+		if(index + 2 > eventLength)
+			return 0;
+		image_event_text(pSample, "gas_set:%u/%u", pEvent[index], pEvent[index + 1]);
+		index += 2;
+	}
+	if(event1 & 0x20)
+	{
+		if(index + 1 > eventLength)
+			return 0;
+		image_event_text(pSample, "gas_change:%u", pEvent[index]);
+		index += 1;
+	}
+	if(event1 & 0x40)
+	{
+		if(index + 1 > eventLength)
+			return 0;
+		image_event_text(pSample, "setpoint:%u", pEvent[index]);
+		index += 1;
+	}
+	if(event2 & 0x01)
+	{
+		if(index + 2 > eventLength)
+			return 0;
+		image_event_text(pSample, "bailout:%u/%u", pEvent[index], pEvent[index + 1]);
+		index += 2;
+	}
+	if(event2 & 0x02)
+	{
+		if(index + 2 > eventLength)
+			return 0;
+		image_event_text(pSample, "heading:%u", pEvent[index] | (pEvent[index + 1] << 8));
+		index += 2;
+	}
+	if(event2 & 0x04)
+	{
+		if(index + 8 > eventLength)
+			return 0;
+		memcpy(position, &pEvent[index], 8);
+		image_event_text(pSample, "gnss:%.5f/%.5f", position[1], position[0]);
+		index += 8;
+	}
+	return index == eventLength;
+}
+
+/* splits a standard sample (depth, length byte, events, fields) into pSample */
+static _Bool image_parse_sample(const uint8_t *pData, uint16_t length, uint8_t fields, const SSmallHeader *pSmallHeader, SImageSample *pSample)
+{
+	uint16_t fieldsLength = image_fields_length(fields, pSmallHeader);
+	uint16_t index;
+
+	pSample->depth_cm = pData[0] | (pData[1] << 8);
+	pSample->fields = fields;
+	pSample->events[0] = 0;
+
+	if((length < 3) || ((pData[2] & 0x7F) != length - 3) || (length - 3 < fieldsLength))
+		return 0;
+
+	index = length - fieldsLength;
+	if(pData[2] & 0x80)
+	{
+		if((index == 3) || !image_parse_events(&pData[3], index - 3, pSample))
+			return 0;
+	}
+	else if(index != 3)
+		return 0;
+
+	if(fields & SAMPLE_TEMPERATURE)
+	{
+		pSample->temperature_dC = (int16_t)(pData[index] | (pData[index + 1] << 8));
+		index += 2;
+	}
+	if(fields & SAMPLE_DECO_NDL)
+	{
+		memcpy(pSample->decoNdl, &pData[index], 2);
+		index += 2;
+	}
+	if(fields & SAMPLE_PPO2)
+	{
+		for(int i = 0; i < 3; i++)
+		{
+			pSample->ppo2_cbar[i] = pData[index];
+			pSample->voltage_dmV[i] = pData[index + 1] | (pData[index + 2] << 8);
+			index += 3;
+		}
+	}
+	if(fields & SAMPLE_DECOPLAN)
+		index += 15;
+	if(fields & SAMPLE_CNS)
+	{
+		pSample->cns = pData[index] | (pData[index + 1] << 8);
+		index += 2;
+	}
+	if(fields & SAMPLE_TANK)
+		pSample->tank_bar = (int16_t)(pData[index] | (pData[index + 1] << 8));
+	return 1;
+}
+
+/* decodes the profile of one dive, checks it on the way and passes every sample to pHandler */
+static void image_decode_dive(const SImageDump *pDump, SImageDive *pDive, SampleHandler pHandler)
+{
+	SImageStream stream;
+	SSmallHeader smallHeader;
+	SDivisor divisor;
+	SCompactState last;
+	SImageSample sample;
+	uint8_t data[COMPACT_SAMPLE_SIZE];
+	uint16_t length;
+	uint8_t fields;
+	_Bool compact = (pDive->header.profileEncoding == PROFILE_ENCODING_COMPACT);
+
+	pDive->samples = 0;
+	pDive->standardLength = sizeof(SSmallHeader) + 2;
+
+	stream.pDump = pDump;
+	stream.address = pDive->begin;
+	stream.remaining = pDive->length;
+	stream.overrun = 0;
+
+	image_read(&stream, (uint8_t*)&smallHeader, sizeof(SSmallHeader));
+	if(image_u24(smallHeader.profileLength) != image_u24(pDive->header.profileLength))
+		image_issue(pDump, pDive, "profile length %u in the profile, %u in the header", image_u24(smallHeader.profileLength),
+					image_u24(pDive->header.profileLength));
+	if(smallHeader.samplingRate_seconds == 0)
+	{
+		image_issue(pDump, pDive, "sampling rate 0 in the profile");
+		return;
+	}
+
+	compact_setDivisor(&divisor, &smallHeader);
+	memset(&last, 0, sizeof(last));
+	memset(&sample, 0, sizeof(sample));
+
+	while(stream.remaining > 2)
+	{
+		data[0] = image_read_byte(&stream);
+		if(compact)
+		{
+			fields = compact_nextSampleFields(&divisor, &smallHeader);
+			length = compact_decodeSample(data[0], fields, &smallHeader, &last, image_read_compact, &stream, data);
+		}
+		else
+		{
+			data[1] = image_read_byte(&stream);
+			data[2] = image_read_byte(&stream);
+			length = 3 + (data[2] & 0x7F);
+			image_read(&stream, &data[3], length - 3);
+			fields = compact_nextSampleFields(&divisor, &smallHeader);
+		}
+
+		if((length == 0) || stream.overrun || !image_parse_sample(data, length, fields, &smallHeader, &sample))
+		{
+			image_issue(pDump, pDive, "sample %u at 0x%06X can not be decoded", pDive->samples, stream.address);
+			return;
+		}
+		sample.seconds = (pDive->samples + 1) * smallHeader.samplingRate_seconds;
+		pDive->samples++;
+		pDive->standardLength += length;
+		if(pHandler)
+			pHandler(pDump, pDive, &sample);
+	}
+
+	if((stream.remaining != 2) || (image_read_byte(&stream) != IMAGE_END_MARKER) || (image_read_byte(&stream) != IMAGE_END_MARKER))
+		image_issue(pDump, pDive, "end marker 0xFD 0xFD missing at 0x%06X", pDive->end);
+
+	if(compact && (pDive->standardLength != image_u24(pDive->header.standardProfileLength)))
+		image_issue(pDump, pDive, "standard profile length %u decoded, %u in the header", pDive->standardLength,
+					image_u24(pDive->header.standardProfileLength));
+}
+
+/* reads the slot headers and checks them the way ext_dive_log_consistent() and ext_flash_repair_dive_log() do */
+static _Bool image_read_dive(const SImageDump *pDump, uint16_t slot, SImageDive *pDive)
+{
+	const uint8_t *pPre = image_slot(pDump, slot, 0);
+	const uint8_t *pPost = image_slot(pDump, slot, IMAGE_HEADER2_OFFSET);
+
+	if(!pPre || (pPre[0] != 0xFA) || (pPre[1] != 0xFA))
+		return 0;
+
+	memset(pDive, 0, sizeof(SImageDive));
+	pDive->slot = slot;
+	if(!pPost || (pPost[0] != 0xFA) || (pPost[1] != 0xFA))
+	{
+		pDive->open = 1;
+		memcpy(&pDive->header, pPre, sizeof(SLogbookHeader));
+		pDive->begin = image_u24(pDive->header.pBeginProfileData);
+		image_issue(pDump, pDive, "dive not closed, post-dive header missing (repaired at next startup)");
+		return 1;
+	}
+	memcpy(&pDive->header, pPost, sizeof(SLogbookHeader));
+	pDive->begin = image_u24(pDive->header.pBeginProfileData);
+	pDive->end = image_u24(pDive->header.pEndProfileData);
+	pDive->length = image_u24(pDive->header.profileLength);
+
+	if(pDive->header.diveHeaderEnd != 0xFBFB)
+		image_issue(pDump, pDive, "header end 0x%04X instead of 0xFBFB", pDive->header.diveHeaderEnd);
+	if(image_u24(&pPre[2]) != pDive->begin)
+		image_issue(pDump, pDive, "profile start 0x%06X before the dive, 0x%06X after it", image_u24(&pPre[2]), pDive->begin);
+
+	if((pDive->begin < SAMPLESTART) || (pDive->begin > SAMPLESTOP) || (pDive->end < SAMPLESTART) || (pDive->end > SAMPLESTOP))
+	{
+		image_issue(pDump, pDive, "profile 0x%06X - 0x%06X outside of the sample ring", pDive->begin, pDive->end);
+		pDive->length = 0;
+		return 1;
+	}
+	if((pDive->begin >= pDive->end) && !image_overrun_valid(pDump))
+		image_issue(pDump, pDive, "profile wraps at the ring end but the end of the ring is erased");
+	if(image_profile_length(pDive->begin, pDive->end) != pDive->length)
+	{
+		image_issue(pDump, pDive, "profile length %u does not match 0x%06X - 0x%06X", pDive->length, pDive->begin, pDive->end);
+		pDive->length = image_profile_length(pDive->begin, pDive->end);
+	}
+	return 1;
+}
+
+/* the older of two dives with overlapping profiles has been overwritten by the ring */
+static void image_check_overlap(const SImageDump *pDump, SImageDive *pDives, uint16_t count)
+{
+	for(uint16_t i = 0; i < count; i++)
+	{
+		for(uint16_t j = 0; j < count; j++)
+		{
+			SImageDive *pOld = &pDives[i];
+			const SImageDive *pNew = &pDives[j];
+			uint32_t offset;
+
+			if((i == j) || pOld->open || pNew->open || !pOld->length || !pNew->length
+				|| (pOld->header.diveNumber >= pNew->header.diveNumber))
+				continue;
+
+			offset = (pNew->begin + IMAGE_SAMPLE_RING - pOld->begin) % IMAGE_SAMPLE_RING;
+			if((offset < pOld->length) || ((pOld->begin + IMAGE_SAMPLE_RING - pNew->begin) % IMAGE_SAMPLE_RING < pNew->length))
+			{
+				image_issue(pDump, pOld, "profile overwritten by dive %u", pNew->header.diveNumber);
+				break;
+			}
+		}
+	}
+}
+
+static void image_print_sample(const SImageDump *pDump, const SImageDive *pDive, const SImageSample *pSample)
+{
+	if(imageOutput == OUTPUT_CSV)
+	{
+		printf("%s,%u,%u,%.2f,", pDump->pName, pDive->header.diveNumber, pSample->seconds, pSample->depth_cm / 100.0);
+		if(pSample->fields & SAMPLE_TEMPERATURE)
+			printf("%.1f", pSample->temperature_dC / 10.0);
+		printf(",");
+		if(pSample->fields & SAMPLE_DECO_NDL)
+			printf("%u,%u", pSample->decoNdl[0], pSample->decoNdl[1]);
+		else
+			printf(",");
+		for(int i = 0; i < 3; i++)
+		{
+			printf(",");
+			if(pSample->fields & SAMPLE_PPO2)
+				printf("%.2f", pSample->ppo2_cbar[i] / 100.0);
+		}
+		for(int i = 0; i < 3; i++)
+		{
+			printf(",");
+			if(pSample->fields & SAMPLE_PPO2)
+				printf("%.1f", pSample->voltage_dmV[i] / 10.0);
+		}
+		printf(",");
+		if(pSample->fields & SAMPLE_CNS)
+			printf("%u", pSample->cns);
+		printf(",");
+		if(pSample->fields & SAMPLE_TANK)
+			printf("%d", pSample->tank_bar);
+		printf(",%s\n", pSample->events);
+	}
+	else if(imageOutput == OUTPUT_JSON)
+	{
+		printf("%s{\"time_s\":%u,\"depth_m\":%.2f", pDive->samples > 1 ? ",\n       " : "", pSample->seconds, pSample->depth_cm / 100.0);
+		if(pSample->fields & SAMPLE_TEMPERATURE)
+			printf(",\"temperature_c\":%.1f", pSample->temperature_dC / 10.0);
+		if(pSample->fields & SAMPLE_DECO_NDL)
+		{
+			if(pSample->decoNdl[0])
+				printf(",\"stop_m\":%u,\"stop_min\":%u", pSample->decoNdl[0], pSample->decoNdl[1]);
+			else
+				printf(",\"ndl_min\":%u", pSample->decoNdl[1]);
+		}
+		if(pSample->fields & SAMPLE_PPO2)
+			printf(",\"ppo2_bar\":[%.2f,%.2f,%.2f],\"sensor_mv\":[%.1f,%.1f,%.1f]", pSample->ppo2_cbar[0] / 100.0, pSample->ppo2_cbar[1] / 100.0,
+				   pSample->ppo2_cbar[2] / 100.0, pSample->voltage_dmV[0] / 10.0, pSample->voltage_dmV[1] / 10.0, pSample->voltage_dmV[2] / 10.0);
+		if(pSample->fields & SAMPLE_CNS)
+			printf(",\"cns\":%u", pSample->cns);
+		if(pSample->fields & SAMPLE_TANK)
+			printf(",\"tank_bar\":%d", pSample->tank_bar);
+		if(pSample->events[0])
+			printf(",\"events\":\"%s\"", pSample->events);
+		printf("}");
+	}
+}
+
+static void image_print_dive_fields(const SImageDive *pDive)
+{
+	const SLogbookHeader *pHeader = &pDive->header;
+
+	if(imageOutput == OUTPUT_CSV)
+	{
+		printf("%u,%u,20%02u-%02u-%02u %02u:%02u,%.2f,%u,%u,%s,0x%06X,0x%06X,%u,%u,%s\n", pDive->slot, pHeader->diveNumber,
+			   pHeader->dateYear, pHeader->dateMonth, pHeader->dateDay, pHeader->timeHour, pHeader->timeMinute,
+			   pHeader->maxDepth / 100.0, pHeader->total_diveTime_seconds, pHeader->samplingRate,
+			   (pHeader->profileEncoding == PROFILE_ENCODING_COMPACT) ? "compact" : "standard",
+			   pDive->begin, pDive->end, pDive->length, pDive->samples, pDive->open ? "open" : (pDive->issues ? "issues" : "ok"));
+	}
+	else
+	{
+		printf("\"slot\":%u,\"number\":%u,\"date\":\"20%02u-%02u-%02u %02u:%02u\",\"max_depth_m\":%.2f,\"dive_time_s\":%u,"
+			   "\"sampling_s\":%u,\"encoding\":\"%s\",\"profile_start\":%u,\"profile_end\":%u,\"profile_bytes\":%u,\"samples\":%u,\"issues\":%u",
+			   pDive->slot, pHeader->diveNumber, pHeader->dateYear, pHeader->dateMonth, pHeader->dateDay, pHeader->timeHour, pHeader->timeMinute,
+			   pHeader->maxDepth / 100.0, pHeader->total_diveTime_seconds, pHeader->samplingRate,
+			   (pHeader->profileEncoding == PROFILE_ENCODING_COMPACT) ? "compact" : "standard",
+			   pDive->begin, pDive->end, pDive->length, pDive->samples, pDive->issues);
+	}
+}
+
+/* analyses one dump, returns the number of bytes of all decoded profiles */
+static uint64_t image_analyse(const SImageDump *pDump, _Bool print)
+{
+	static SImageDive dives[IMAGE_SLOTS];
+	uint16_t count = 0;
+	uint16_t newest = 0;
+	uint64_t bytes = 0;
+	_Bool firstDive = 1;
+
+	for(uint16_t slot = 0; slot < IMAGE_SLOTS; slot++)
+	{
+		if(image_read_dive(pDump, slot, &dives[count]))
+		{
+			if(dives[count].header.diveNumber > dives[newest].header.diveNumber)
+				newest = count;
+			count++;
+		}
+	}
+	image_check_overlap(pDump, dives, count);
+
+	if(pDump->lastDiveLogId >= 0)
+	{
+		SImageDive last;
+
+		if(!image_slot(pDump, pDump->lastDiveLogId, 0))
+			image_issue(pDump, NULL, "lastDiveLogId %d is not part of the header dump", pDump->lastDiveLogId);
+		else if(pDump->lastDiveLogId && (!image_read_dive(pDump, pDump->lastDiveLogId, &last) || last.open))
+			image_issue(pDump, NULL, "lastDiveLogId %d does not point to a closed dive, the log is repaired at startup", pDump->lastDiveLogId);
+		else if(count && (pDump->lastDiveLogId != dives[newest].slot))
+			image_issue(pDump, NULL, "lastDiveLogId %d, highest dive number %u is in slot %u", pDump->lastDiveLogId,
+						dives[newest].header.diveNumber, dives[newest].slot);
+	}
+	if((pDump->nextSampleStart >= 0) && count && !dives[newest].open && dives[newest].length
+		&& ((pDump->nextSampleStart + IMAGE_SAMPLE_RING - dives[newest].begin) % IMAGE_SAMPLE_RING < dives[newest].length))
+	{
+		image_issue(pDump, NULL, "next sample start 0x%06X lies in the profile of dive %u", (uint32_t)pDump->nextSampleStart,
+					dives[newest].header.diveNumber);
+	}
+
+	if(print && (imageOutput == OUTPUT_JSON))
+		printf("%s{\"dump\":\"%s\",\"dives\":[", imageFirstJson ? "[\n" : ",\n", pDump->pName);
+	imageFirstJson = 0;
+
+	for(uint16_t i = 0; i < count; i++)
+	{
+		SImageDive *pDive = &dives[i];
+
+		if(print && (imageOutput == OUTPUT_JSON))
+		{
+			printf("%s\n  {", firstDive ? "" : ",");
+			firstDive = 0;
+			if(imageProfiles)
+				printf("\"profile\":[");
+		}
+		if(!pDive->open && pDive->length)
+		{
+			image_decode_dive(pDump, pDive, (print && imageProfiles) ? image_print_sample : NULL);
+			bytes += pDive->length;
+		}
+		if(print && (imageOutput == OUTPUT_JSON))
+		{
+			if(imageProfiles)
+				printf("],");
+			image_print_dive_fields(pDive);
+			printf("}");
+		}
+		else if(print && (imageOutput == OUTPUT_CSV) && !imageProfiles)
+		{
+			printf("%s,", pDump->pName);
+			image_print_dive_fields(pDive);
+		}
+	}
+	if(print && (imageOutput == OUTPUT_JSON))
+		printf("]}");
+	return bytes;
+}
+
+static uint8_t *image_load(const char *pFile, uint32_t *pSize)
+{
+	FILE *pInput = fopen(pFile, "rb");
+	uint8_t *pData = NULL;
+	long size;
+
+	if(!pInput)
+	{
+		perror(pFile);
+		return NULL;
+	}
+	if(!fseek(pInput, 0, SEEK_END) && ((size = ftell(pInput)) > 0) && !fseek(pInput, 0, SEEK_SET))
+	{
+		pData = malloc(size);
+		if(pData && (fread(pData, 1, size, pInput) != (size_t)size))
+		{
+			free(pData);
+			pData = NULL;
+		}
+		*pSize = (uint32_t)size;
+	}
+	if(!pData)
+		fprintf(stderr, "%s: can not be read\n", pFile);
+	fclose(pInput);
+	return pData;
+}
+
+/* a header dump of command 0x85 (optionally followed by lastDiveLogId) and a sample dump of 0x88 (followed by the next sample start) */
+static _Bool image_open_dumps(SImageDump *pDump, const char *pHeaderFile, const char *pSampleFile)
+{
+	uint32_t size;
+
+	memset(pDump, 0, sizeof(SImageDump));
+	pDump->pName = pHeaderFile;
+	pDump->lastDiveLogId = -1;
+	pDump->nextSampleStart = -1;
+
+	pDump->pHeader = image_load(pHeaderFile, &size);
+	if(!pDump->pHeader)
+		return 0;
+	pDump->headerSize = size;
+	if((size == IMAGE_HEADER_DUMP + 1) || (size == IMAGE_HEADER_RING + 1))
+	{
+		pDump->lastDiveLogId = pDump->pHeader[size - 1];
+		pDump->headerSize--;
+	}
+	if(pDump->headerSize > IMAGE_HEADER_RING)
+		pDump->headerSize = IMAGE_HEADER_RING;
+
+	pDump->pSample = image_load(pSampleFile, &size);
+	if(!pDump->pSample)
+		return 0;
+	pDump->sampleSize = size;
+	if(size == IMAGE_SAMPLE_RING + 4)
+	{
+		pDump->nextSampleStart = image_u24(&pDump->pSample[IMAGE_SAMPLE_RING]) | (pDump->pSample[IMAGE_SAMPLE_RING + 3] << 24);
+		pDump->sampleSize = IMAGE_SAMPLE_RING;
+	}
+	if(pDump->sampleSize > IMAGE_SAMPLE_RING)
+		pDump->sampleSize = IMAGE_SAMPLE_RING;
+	return 1;
+}
+
+static _Bool image_open_flash(SImageDump *pDump, const char *pFile)
+{
+	uint32_t size;
+	uint8_t *pImage;
+
+	memset(pDump, 0, sizeof(SImageDump));
+	pDump->pName = pFile;
+	pDump->lastDiveLogId = -1;
+	pDump->nextSampleStart = -1;
+
+	pImage = image_load(pFile, &size);
+	if(!pImage)
+		return 0;
+	if(size <= SAMPLESTART)
+	{
+		fprintf(stderr, "%s: %u bytes do not reach the sample ring\n", pFile, size);
+		free(pImage);
+		return 0;
+	}
+	/* both point into the one image, released through pHeader */
+	pDump->pHeader = &pImage[HEADERSTART];
+	pDump->headerSize = IMAGE_HEADER_RING;
+	pDump->pSample = &pImage[SAMPLESTART];
+	pDump->sampleSize = (size - SAMPLESTART > IMAGE_SAMPLE_RING) ? IMAGE_SAMPLE_RING : size - SAMPLESTART;
+	return 1;
+}
+
+static void image_close(SImageDump *pDump)
+{
+	if(imageFullFlash)
+		free(pDump->pHeader - HEADERSTART);
+	else
+	{
+		free(pDump->pHeader);
+		free(pDump->pSample);
+	}
+}
+
+static void image_usage(const char *pProgram)
+{
+	fprintf(stderr, "usage: %s [-c|-j] [-p] [-q] [-b loops] headerdump sampledump [headerdump sampledump ...]\n", pProgram);
+	fprintf(stderr, "       %s -f [-c|-j] [-p] [-q] [-b loops] flashimage [flashimage ...]\n", pProgram);
+	fprintf(stderr, "  -c  dives as CSV, -j  dives as JSON\n");
+	fprintf(stderr, "  -p  include the samples (CSV: one line per sample instead of one per dive)\n");
+	fprintf(stderr, "  -q  count inconsistencies only\n");
+	fprintf(stderr, "  -b  decode every dump this many times and report the throughput\n");
+	fprintf(stderr, "  -f  arguments are raw images of the whole external flash\n");
+}
+
+int main(int argc, char *argv[])
+{
+	SImageDump dump;
+	uint64_t bytes = 0;
+	uint64_t benchBytes = 0;
+	uint64_t benchTime = 0;
+	uint64_t start;
+	uint32_t dumps = 0;
+	int step;
+	int option;
+
+	while((option = getopt(argc, argv, "cjpqb:fh")) != -1)
+	{
+		switch(option)
+		{
+			case 'c':	imageOutput = OUTPUT_CSV;
+				break;
+			case 'j':	imageOutput = OUTPUT_JSON;
+				break;
+			case 'p':	imageProfiles = 1;
+				break;
+			case 'q':	imageQuiet = 1;
+				break;
+			case 'b':	imageBenchLoops = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'f':	imageFullFlash = 1;
+				break;
+			default:	image_usage(argv[0]);
+				return 2;
+		}
+	}
+	step = imageFullFlash ? 1 : 2;
+	if((optind >= argc) || ((argc - optind) % step))
+	{
+		image_usage(argv[0]);
+		return 2;
+	}
+
+	if(imageOutput == OUTPUT_CSV)
+	{
+		if(imageProfiles)
+			printf("dump,dive,time_s,depth_m,temperature_c,stop_m,stop_or_ndl_min,ppo2_1,ppo2_2,ppo2_3,mv_1,mv_2,mv_3,cns,tank_bar,events\n");
+		else
+			printf("dump,slot,dive,date,max_depth_m,dive_time_s,sampling_s,encoding,profile_start,profile_end,profile_bytes,samples,status\n");
+	}
+
+	for(int arg = optind; arg < argc; arg += step)
+	{
+		if(!(imageFullFlash ? image_open_flash(&dump, argv[arg]) : image_open_dumps(&dump, argv[arg], argv[arg + 1])))
+			return 2;
+
+		bytes += image_analyse(&dump, 1);
+		dumps++;
+
+		if(imageBenchLoops)
+		{
+			_Bool quiet = imageQuiet;
+			uint32_t issues = imageIssues;
+
+			imageQuiet = 1;
+			start = image_now_ns();
+			for(uint32_t loop = 0; loop < imageBenchLoops; loop++)
+				benchBytes += image_analyse(&dump, 0);
+			benchTime += image_now_ns() - start;
+			imageQuiet = quiet;
+			imageIssues = issues;
+		}
+		image_close(&dump);
+	}
+	if(imageOutput == OUTPUT_JSON)
+		printf("%s]\n", imageFirstJson ? "[" : "\n");
+
+	fprintf(stderr, "%u dumps, %llu profile bytes, %u inconsistencies\n", dumps, (unsigned long long)bytes, imageIssues);
+	if(imageBenchLoops && benchTime)
+	{
+		fprintf(stderr, "decoding: %.1f MB/s, %.3f ms per dump\n", (benchBytes / 1e6) / (benchTime / 1e9),
+				(benchTime / 1e6) / ((double)dumps * imageBenchLoops));
+	}
+	return imageIssues ? 1 : 0;
+}
@@ -0,0 +1,286 @@
+///////////////////////////////////////////////////////////////////////////////
+/// -*- coding: UTF-8 -*-
+///
+/// \file   HostSim/Src/planner_check.c
+/// \brief  Compares simulation_decoplaner_sweep() with single planner runs
+/// \author heinrichs weikamp gmbh
+/// \date   17-Oct-2026
+///
+/// \details
+///	Plans a grid of dives (depths, bottom times, surface intervals, GF and
+///	VPM settings, gas masks) with simulation_decoplaner_sweep() and every
+///	cell again on its own with simulation_decoplaner(), followed by
+///	simulation_gas_consumption() and simulation_helper_change_points() as
+///	done by the planner menu. Stop table, TTS, NDL, CNS, gas consumption and
+///	summary have to be identical. The dive settings of stateSim have to be
+///	the same before and after the sweep. Returns non zero on a difference.
+///
+/// $Id$
+///////////////////////////////////////////////////////////////////////////////
+///     This program is free software: you can redistribute it and/or modify
+///     it under the terms of the GNU General Public License as published by
+///     the Free Software Foundation, either version 3 of the License, or
+///     (at your option) any later version.
+///
+///     This program is distributed in the hope that it will be useful,
+///     but WITHOUT ANY WARRANTY; without even the implied warranty of
+///     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///     GNU General Public License for more details.
+///
+///     You should have received a copy of the GNU General Public License
+///     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "data_central.h"
+#include "decom.h"
+#include "settings.h"
+#include "simulation.h"
+#include "vpm.h"
+#include "gfx_engine.h"
+#include "t3.h"
+#include "tHome.h"
+#include "firmwareEraseProgram.h"
+
+#define CHECK_GAS_TRAVEL_L_MIN	(20)
+#define CHECK_GAS_DECO_L_MIN	(15)
+
+static const uint16_t checkDepth[] = { 21, 36, 51 };
+static const uint16_t checkDiveTime[] = { 12, 25, 40 };
+static const uint16_t checkIntervall[] = { 0, 90 };
+static const uint16_t checkGasMask[] = { 0, (1 << 1) };		/* all gases, bottom gas only */
+
+typedef struct
+{
+	uint8_t decoModel;
+	uint8_t gfLow;
+	uint8_t gfHigh;
+	uint8_t vpmConservatism;
+} SCheckModel;
+
+static const SCheckModel checkModel[] =
+{
+	{ GF_MODE,	30,	85,	0 },
+	{ GF_MODE,	55,	70,	0 },
+	{ VPM_MODE,	30,	85,	0 },
+	{ VPM_MODE,	30,	85,	2 },
+};
+
+#define CHECK_CELLS	(sizeof(checkDepth) / sizeof(checkDepth[0]) * sizeof(checkDiveTime) / sizeof(checkDiveTime[0]) \
+					* sizeof(checkIntervall) / sizeof(checkIntervall[0]) * sizeof(checkGasMask) / sizeof(checkGasMask[0]) \
+					* sizeof(checkModel) / sizeof(checkModel[0]))
+
+static SSimPlanCell checkCell[CHECK_CELLS];
+
+
+/* display side of data_central.c, settings.c and check_warning.c, not part of the planner */
+
+uint8_t t3_customview_disabled(uint8_t view)
+{
+	return 0;
+}
+
+void tHome_findNextStop(const uint16_t *list, uint8_t *depthOut, uint16_t *lengthOut)
+{
+	*depthOut = 0;
+	*lengthOut = 0;
+}
+
+void GFX_use_colorscheme(uint8_t colorscheme)
+{
+}
+
+
+/* erased flash page of the hardware data (serial numbers) read by settings.c */
+static int check_map_hardware_data(void)
+{
+	uint32_t page = HARDWAREDATA_ADDRESS & ~0xFFFu;
+	void *pPage = mmap((void *)(uintptr_t)page, 0x1000, PROT_READ | PROT_WRITE,
+						MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+
+	if(pPage != (void *)(uintptr_t)page)
+	{
+		perror("mmap hardware data");
+		return -1;
+	}
+	memset(pPage, 0xFF, 0x1000);
+	return 0;
+}
+
+static void check_set_gas(SGasLine *pGas, uint8_t oxygen, uint8_t depth, _Bool first)
+{
+	memset(pGas, 0, sizeof(SGasLine));
+	pGas->oxygen_percentage = oxygen;
+	pGas->depth_meter = depth;
+	pGas->note.ub.active = 1;
+	pGas->note.ub.first = first;
+	pGas->note.ub.deco = !first;
+}
+
+/* air with EAN32 and oxygen as deco gases, surface state after a long surface interval */
+static void check_init(void)
+{
+	SSettings *pSettings = settingsGetPointer();
+	SDiveState *pState = stateRealGetPointerWrite();
+
+	set_settings_to_Standard();
+	pSettings->dive_mode = DIVEMODE_OC;
+	memset(&pSettings->gas[1], 0, NUM_GASES * sizeof(SGasLine));
+	check_set_gas(&pSettings->gas[1], 21, 0, true);
+	check_set_gas(&pSettings->gas[2], 32, 33, false);
+	check_set_gas(&pSettings->gas[3], 100, 6, false);
+	createDiveSettings();
+
+	memset(&pState->lifeData, 0, sizeof(SLifeData));
+	pState->lifeData.pressure_surface_bar = 1.0f;
+	pState->lifeData.pressure_ambient_bar = 1.0f;
+	decom_reset_with_1000mbar(&pState->lifeData);
+	setActualGasFirst(&pState->lifeData);
+	pState->diveSettings.vpm_tableMode = 0;
+}
+
+static uint16_t check_build_cells(void)
+{
+	uint16_t count = 0;
+
+	/* mixed order, the sweep has to group the cells itself */
+	for(size_t m = 0; m < sizeof(checkModel) / sizeof(checkModel[0]); m++)
+		for(size_t t = 0; t < sizeof(checkDiveTime) / sizeof(checkDiveTime[0]); t++)
+			for(size_t d = 0; d < sizeof(checkDepth) / sizeof(checkDepth[0]); d++)
+				for(size_t i = 0; i < sizeof(checkIntervall) / sizeof(checkIntervall[0]); i++)
+					for(size_t g = 0; g < sizeof(checkGasMask) / sizeof(checkGasMask[0]); g++)
+					{
+						SSimPlanCell *pCell = &checkCell[count++];
+
+						memset(pCell, 0, sizeof(SSimPlanCell));
+						pCell->depthMeter = checkDepth[d];
+						pCell->diveTimeMinutes = checkDiveTime[t];
+						pCell->intervallTimeMinutes = checkIntervall[i];
+						pCell->gasMask = checkGasMask[g];
+						pCell->decoModel = checkModel[m].decoModel;
+						pCell->gfLow = checkModel[m].gfLow;
+						pCell->gfHigh = checkModel[m].gfHigh;
+						pCell->vpmConservatism = checkModel[m].vpmConservatism;
+					}
+	return count;
+}
+
+/* one cell through the planner menu sequence, with the cell settings in stateReal */
+static int check_cell(const SSimPlanCell *pCell)
+{
+	static SDiveSettings diveSettingsSaved;
+	SDiveState *pReal = stateRealGetPointerWrite();
+	SDecoinfo *pDecoInfo;
+	SSimDataSummary summary;
+	uint16_t gasConsumption[6];
+	uint8_t gasChangeList[40];
+	int fail = 0;
+
+	memcpy(&diveSettingsSaved, &pReal->diveSettings, sizeof(SDiveSettings));
+	pReal->diveSettings.deco_type.ub.standard = pCell->decoModel;
+	pReal->diveSettings.gf_low = pCell->gfLow;
+	pReal->diveSettings.gf_high = pCell->gfHigh;
+	if(pCell->decoModel == VPM_MODE)
+		pReal->diveSettings.vpm_conservatism = pCell->vpmConservatism;
+	if(pCell->gasMask)
+	{
+		for(int i = 1; i < 1 + (2 * NUM_GASES); i++)
+		{
+			if(!(pCell->gasMask & (1 << i)))
+				pReal->diveSettings.gas[i].note.ub.active = 0;
+		}
+	}
+
+	/* on the device the VPM calculation of the surface state runs before the planner is opened,
+	 * vpm.c calculates the NDL only if its previous call ended in NDL */
+	vpm_calc(&pReal->lifeData, &pReal->diveSettings, &pReal->vpm, &pReal->decolistVPM, DECOSTOPS);
+
+	memset(&summary, 0, sizeof(summary));
+	memset(gasConsumption, 0, sizeof(gasConsumption));
+	pDecoInfo = simulation_decoplaner(pCell->depthMeter, pCell->intervallTimeMinutes, pCell->diveTimeMinutes, gasChangeList);
+	simulation_gas_consumption(gasConsumption, pCell->depthMeter, pCell->diveTimeMinutes, pDecoInfo, CHECK_GAS_TRAVEL_L_MIN, CHECK_GAS_DECO_L_MIN, gasChangeList);
+	simulation_helper_change_points(&summary, pCell->depthMeter, pCell->diveTimeMinutes, pDecoInfo, gasChangeList);
+
+	if(!pCell->valid)
+	{
+		printf("  not calculated by the sweep\n");
+		fail = 1;
+	}
+	else
+	{
+		if(memcmp(pDecoInfo->output_stop_length_seconds, pCell->decoInfo.output_stop_length_seconds, sizeof(pDecoInfo->output_stop_length_seconds))
+			|| (pDecoInfo->output_time_to_surface_seconds != pCell->decoInfo.output_time_to_surface_seconds)
+			|| (pDecoInfo->output_ndl_seconds != pCell->decoInfo.output_ndl_seconds))
+		{
+			printf("  deco: single TTS %us NDL %us, sweep TTS %us NDL %us\n",
+					pDecoInfo->output_time_to_surface_seconds, pDecoInfo->output_ndl_seconds,
+					pCell->decoInfo.output_time_to_surface_seconds, pCell->decoInfo.output_ndl_seconds);
+			fail = 1;
+		}
+		if(stateSimGetPointer()->lifeData.cns != pCell->cns)
+		{
+			printf("  cns: single %f, sweep %f\n", stateSimGetPointer()->lifeData.cns, pCell->cns);
+			fail = 1;
+		}
+		if(memcmp(gasConsumption, pCell->gasConsumption, sizeof(gasConsumption)))
+		{
+			printf("  gas consumption differs\n");
+			fail = 1;
+		}
+		if(memcmp(&summary, &pCell->summary, sizeof(summary)))
+		{
+			printf("  summary differs\n");
+			fail = 1;
+		}
+	}
+
+	memcpy(&pReal->diveSettings, &diveSettingsSaved, sizeof(SDiveSettings));
+	return fail;
+}
+
+int main(void)
+{
+	static SDiveSettings simSettingsBefore;
+	uint16_t count;
+	uint16_t done;
+	int failures = 0;
+
+	if(check_map_hardware_data() != 0)
+		return 2;
+
+	check_init();
+	count = check_build_cells();
+
+	copyDiveSettingsToSim();
+	memcpy(&simSettingsBefore, &stateSimGetPointer()->diveSettings, sizeof(SDiveSettings));
+	done = simulation_decoplaner_sweep(checkCell, count, CHECK_GAS_TRAVEL_L_MIN, CHECK_GAS_DECO_L_MIN);
+	if(memcmp(&simSettingsBefore, &stateSimGetPointer()->diveSettings, sizeof(SDiveSettings)))
+	{
+		printf("dive settings of stateSim changed by the sweep\n");
+		failures++;
+	}
+	if(done != count)
+	{
+		printf("sweep calculated %u of %u cells\n", done, count);
+		failures++;
+	}
+
+	for(uint16_t i = 0; i < count; i++)
+	{
+		const SSimPlanCell *pCell = &checkCell[i];
+
+		if(check_cell(pCell))
+		{
+			printf("cell %u: %um %umin intervall %umin gas mask 0x%X %s %u/%u cons %u differs\n", i,
+					pCell->depthMeter, pCell->diveTimeMinutes, pCell->intervallTimeMinutes, pCell->gasMask,
+					(pCell->decoModel == GF_MODE) ? "GF" : "VPM", pCell->gfLow, pCell->gfHigh, pCell->vpmConservatism);
+			failures++;
+		}
+	}
+
+	printf("planner sweep: %u cells, %d differences\n", count, failures);
+	return failures ? 1 : 0;
+}
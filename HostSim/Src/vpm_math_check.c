@@ -0,0 +1,183 @@
+///////////////////////////////////////////////////////////////////////////////
+/// -*- coding: UTF-8 -*-
+///
+/// \file   HostSim/Src/vpm_math_check.c
+/// \brief  Error bound check for the VPM fast math in calc_crush.c
+/// \author heinrichs weikamp gmbh
+/// \date   17-Oct-2026
+///
+/// \details
+///	Compares vpm_expf(), vpm_logf() and vpm_cbrtf() against the double
+///	precision C library. Every float of the ranges used by vpm.c and
+///	calc_crush.c is tested, the remaining range with a stride through the
+///	bit patterns. Returns non zero if a documented bound is exceeded.
+///
+/// $Id$
+///////////////////////////////////////////////////////////////////////////////
+///     This program is free software: you can redistribute it and/or modify
+///     it under the terms of the GNU General Public License as published by
+///     the Free Software Foundation, either version 3 of the License, or
+///     (at your option) any later version.
+///
+///     This program is distributed in the hope that it will be useful,
+///     but WITHOUT ANY WARRANTY; without even the implied warranty of
+///     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+///     GNU General Public License for more details.
+///
+///     You should have received a copy of the GNU General Public License
+///     along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//////////////////////////////////////////////////////////////////////////////
+
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "calc_crush.h"
+
+#define BOUND_EXP_REL		(1.2e-7)
+#define BOUND_LOG_ABS		(6e-8)		/* x in [0.5, 2], log(x) close to zero */
+#define BOUND_LOG_REL		(1.2e-7)
+#define BOUND_CBRT_REL		(1.2e-7)
+
+#define STRIDE_FULL_RANGE	(31u)
+
+typedef struct
+{
+	const char *name;
+	double bound;
+	double maxError;
+	float worstInput;
+	uint32_t count;
+} SMathResult;
+
+static float check_bits_to_float(uint32_t bits)
+{
+	float value;
+
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static uint32_t check_float_to_bits(float value)
+{
+	uint32_t bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static void check_record(SMathResult *pResult, float input, double error)
+{
+	pResult->count++;
+	if(error > pResult->maxError)
+	{
+		pResult->maxError = error;
+		pResult->worstInput = input;
+	}
+}
+
+static void check_exp(SMathResult *pResult, float x)
+{
+	double reference = exp((double)x);
+
+	check_record(pResult, x, fabs(vpm_expf(x) - reference) / reference);
+}
+
+static void check_log(SMathResult *pResultAbs, SMathResult *pResultRel, float x)
+{
+	double reference = log((double)x);
+	double error = fabs(vpm_logf(x) - reference);
+
+	if((x >= 0.5f) && (x <= 2.0f))
+		check_record(pResultAbs, x, error);
+	else
+		check_record(pResultRel, x, error / fabs(reference));
+}
+
+static void check_cbrt(SMathResult *pResult, float x)
+{
+	double reference = cbrt((double)x);
+
+	check_record(pResult, x, fabs(vpm_cbrtf(x) - reference) / reference);
+}
+
+/* all floats in [low, high] of equal sign */
+static void check_range(float low, float high, uint32_t stride, void (*pCheck)(float x, void *pContext), void *pContext)
+{
+	uint32_t first = check_float_to_bits(low);
+	uint32_t last = check_float_to_bits(high);
+	uint32_t step;
+
+	if(first > last)
+	{
+		step = first;
+		first = last;
+		last = step;
+	}
+	for(uint32_t bits = first; bits <= last; bits += stride)
+	{
+		pCheck(check_bits_to_float(bits), pContext);
+		if(last - bits < stride)
+			break;
+	}
+}
+
+static void check_exp_cb(float x, void *pContext)
+{
+	check_exp((SMathResult *)pContext, x);
+}
+
+static void check_log_cb(float x, void *pContext)
+{
+	SMathResult *pResult = (SMathResult *)pContext;
+
+	check_log(&pResult[0], &pResult[1], x);
+}
+
+static void check_cbrt_cb(float x, void *pContext)
+{
+	check_cbrt((SMathResult *)pContext, x);
+}
+
+static int check_report(const SMathResult *pResult)
+{
+	int fail = pResult->maxError > pResult->bound;
+
+	printf("%-10s %10u values  max error %.3e at %-14.8g bound %.1e  %s\n",
+			pResult->name, pResult->count, pResult->maxError, pResult->worstInput, pResult->bound, fail ? "FAIL" : "ok");
+	return fail;
+}
+
+int main(void)
+{
+	SMathResult expResult = { "vpm_expf", BOUND_EXP_REL, 0, 0, 0 };
+	SMathResult logResult[2] = { { "vpm_logf", BOUND_LOG_ABS, 0, 0, 0 }, { "vpm_logf", BOUND_LOG_REL, 0, 0, 0 } };
+	SMathResult cbrtResult = { "vpm_cbrtf", BOUND_CBRT_REL, 0, 0, 0 };
+	int fail = 0;
+
+	/* VPM ranges, every float: decay exponents (-k * t), phase volume time logarithm, Boyle's law pressure ratio */
+	check_range(-40.0f, -1e-6f, 1, check_exp_cb, &expResult);
+	check_range(1e-4f, 1.0f, 1, check_log_cb, logResult);
+	check_range(0.1f, 10.0f, 1, check_cbrt_cb, &cbrtResult);
+
+	/* remaining documented range with a stride */
+	check_range(-87.0f, -40.0f, STRIDE_FULL_RANGE, check_exp_cb, &expResult);
+	check_range(-1e-6f, -FLT_MIN, STRIDE_FULL_RANGE, check_exp_cb, &expResult);
+	check_range(FLT_MIN, 88.0f, STRIDE_FULL_RANGE, check_exp_cb, &expResult);
+	check_range(FLT_MIN, FLT_MAX, STRIDE_FULL_RANGE, check_log_cb, logResult);
+	check_range(FLT_MIN, FLT_MAX, STRIDE_FULL_RANGE, check_cbrt_cb, &cbrtResult);
+
+	if(vpm_expf(-87.5f) != 0.0f)
+	{
+		printf("vpm_expf(-87.5) is not zero\n");
+		fail = 1;
+	}
+
+	fail |= check_report(&expResult);
+	fail |= check_report(&logResult[0]);
+	fail |= check_report(&logResult[1]);
+	fail |= check_report(&cbrtResult);
+	return fail;
+}